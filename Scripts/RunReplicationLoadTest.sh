@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+#
+# Starts a local (listen or dedicated) server plus N headless -nullrhi clients on one Linux machine,
+# runs the scripted RuntimeTransformer.LoadTest sessions on all of them with packet simulation enabled
+# and merges the per-process JSON reports into a single file.
+#
+# Usage:
+#   UE_ROOT=/path/to/UnrealEngine ./RunReplicationLoadTest.sh <Project.uproject> <Map> [options]
+#
+# Options:
+#   --clients N       number of headless clients (default 4)
+#   --seconds S       duration of the scripted session (default 60)
+#   --loss PCT        packet loss percentage (PktLoss, default 0)
+#   --lag MS          packet lag in milliseconds (PktLag, default 0)
+#   --lag-var MS      packet lag variance in milliseconds (PktLagVariance, default 0)
+#   --dedicated       use a dedicated server instead of a listen server
+#   --port PORT       server port (default 7777)
+#   --out DIR         output directory for the reports (default ./LoadTestResults)
+#
+# Packet simulation requires a non-Shipping build.
+
+set -euo pipefail
+
+if [[ $# -lt 2 ]]; then
+	sed -n '3,20p' "$0"
+	exit 1
+fi
+
+PROJECT="$1"
+MAP="$2"
+shift 2
+
+CLIENTS=4
+SECONDS_TO_RUN=60
+LOSS=0
+LAG=0
+LAG_VARIANCE=0
+DEDICATED=0
+PORT=7777
+OUT_DIR="$(pwd)/LoadTestResults"
+
+while [[ $# -gt 0 ]]; do
+	case "$1" in
+		--clients)   CLIENTS="$2"; shift 2 ;;
+		--seconds)   SECONDS_TO_RUN="$2"; shift 2 ;;
+		--loss)      LOSS="$2"; shift 2 ;;
+		--lag)       LAG="$2"; shift 2 ;;
+		--lag-var)   LAG_VARIANCE="$2"; shift 2 ;;
+		--dedicated) DEDICATED=1; shift ;;
+		--port)      PORT="$2"; shift 2 ;;
+		--out)       OUT_DIR="$2"; shift 2 ;;
+		*) echo "Unknown option $1"; exit 1 ;;
+	esac
+done
+
+: "${UE_ROOT:?UE_ROOT must point to the Unreal Engine root}"
+EDITOR="$UE_ROOT/Engine/Binaries/Linux/UnrealEditor"
+
+mkdir -p "$OUT_DIR"
+rm -f "$OUT_DIR"/LoadTest_*.json
+
+PKT_ARGS="-PktLoss=$LOSS -PktLag=$LAG -PktLagVariance=$LAG_VARIANCE"
+COMMON_ARGS="-unattended -nosound -nosplash -RTStatsDir=$OUT_DIR $PKT_ARGS"
+# the server runs a bit longer so that it reports the whole session of the clients
+SERVER_CMDS="RuntimeTransformer.LoadTest.Start $((SECONDS_TO_RUN + 10)) Quit"
+CLIENT_CMDS="RuntimeTransformer.LoadTest.Start $SECONDS_TO_RUN Quit"
+
+PIDS=()
+
+if [[ $DEDICATED -eq 1 ]]; then
+	"$EDITOR" "$PROJECT" "$MAP" -server -log -Port="$PORT" $COMMON_ARGS \
+		-ExecCmds="$SERVER_CMDS" > "$OUT_DIR/Server.log" 2>&1 &
+else
+	"$EDITOR" "$PROJECT" "$MAP?listen" -game -nullrhi -Port="$PORT" $COMMON_ARGS \
+		-ExecCmds="$SERVER_CMDS" > "$OUT_DIR/Server.log" 2>&1 &
+fi
+PIDS+=($!)
+
+# give the server some time to start listening
+sleep 10
+
+for ((i = 0; i < CLIENTS; i++)); do
+	"$EDITOR" "$PROJECT" "127.0.0.1:$PORT" -game -nullrhi -windowed $COMMON_ARGS \
+		-ExecCmds="$CLIENT_CMDS" > "$OUT_DIR/Client_$i.log" 2>&1 &
+	PIDS+=($!)
+done
+
+for pid in "${PIDS[@]}"; do
+	wait "$pid" || true
+done
+
+# merge all the reports into one JSON array
+REPORT="$OUT_DIR/LoadTestReport.json"
+{
+	echo "["
+	first=1
+	for f in "$OUT_DIR"/LoadTest_*.json; do
+		[[ -e "$f" ]] || continue
+		[[ $first -eq 1 ]] || echo ","
+		cat "$f"
+		first=0
+	done
+	echo "]"
+} > "$REPORT"
+
+echo "Report written to $REPORT"
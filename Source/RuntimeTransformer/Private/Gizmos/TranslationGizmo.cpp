@@ -4,6 +4,7 @@
 #include "Gizmos/TranslationGizmo.h"
 #include "Components/BoxComponent.h"
 #include "Components/SphereComponent.h"
+#include "TransformerVertexSnapping.h"
 
 ATranslationGizmo::ATranslationGizmo()
 {
@@ -145,3 +146,50 @@ FTransform ATranslationGizmo::GetSnappedTransform(FTransform& outCurrentAccumula
 	outCurrentAccumulatedTransform.SetLocation(addedLocation - snappedLocation);
 	return result;
 }
+
+bool ATranslationGizmo::GetVertexSnappedTransform(const FVector& RayStartPoint
+	, const FVector& RayDirection
+	, float ScreenRadius
+	, float PixelTanAngle
+	, ETransformationDomain Domain
+	, const TSet<const AActor*>& IgnoredActors
+	, FTransform& outDeltaTransform) const
+{
+	UTransformerVertexSnapping* vertexSnapping = UTransformerVertexSnapping::Get(this);
+	if (!vertexSnapping) return false;
+
+	TSet<const AActor*> ignoredActors = IgnoredActors;
+	ignoredActors.Add(this);
+
+	FVector vertex;
+	if (!vertexSnapping->FindVertex(RayStartPoint, RayDirection, ScreenRadius * PixelTanAngle, ignoredActors, vertex))
+		return false;
+
+	FVector deltaLocation = vertex - GetActorLocation();
+	switch (Domain)
+	{
+	case ETransformationDomain::TD_X_Axis:
+		deltaLocation = deltaLocation.ProjectOnTo(GetActorForwardVector());
+		break;
+	case ETransformationDomain::TD_Y_Axis:
+		deltaLocation = deltaLocation.ProjectOnTo(GetActorRightVector());
+		break;
+	case ETransformationDomain::TD_Z_Axis:
+		deltaLocation = deltaLocation.ProjectOnTo(GetActorUpVector());
+		break;
+	case ETransformationDomain::TD_XY_Plane:
+		deltaLocation = FVector::VectorPlaneProject(deltaLocation, GetActorUpVector());
+		break;
+	case ETransformationDomain::TD_YZ_Plane:
+		deltaLocation = FVector::VectorPlaneProject(deltaLocation, GetActorForwardVector());
+		break;
+	case ETransformationDomain::TD_XZ_Plane:
+		deltaLocation = FVector::VectorPlaneProject(deltaLocation, GetActorRightVector());
+		break;
+	}
+
+	outDeltaTransform = FTransform::Identity;
+	outDeltaTransform.SetScale3D(FVector::ZeroVector); //same as GetDeltaTransform: no scaling
+	outDeltaTransform.SetLocation(deltaLocation);
+	return true;
+}
@@ -1,6 +1,7 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "RuntimeTransformer.h"
+#include "TransformerLoadTest.h"
 
 #define LOCTEXT_NAMESPACE "FRuntimeTransformerModule"
 
@@ -15,6 +16,9 @@ void FRuntimeTransformerModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+#if RUNTIMETRANSFORMER_NET_STATS
+	ShutdownTransformerLoadTest();
+#endif
 }
 
 #undef LOCTEXT_NAMESPACE
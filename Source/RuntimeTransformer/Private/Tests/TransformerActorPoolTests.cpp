@@ -0,0 +1,84 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#include "TransformerTestWorld.h"
+#include "TransformerActorPool.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Sets a console variable for the scope, putting back its value afterwards
+class FScopedTransformerCVar
+{
+public:
+
+	FScopedTransformerCVar(const TCHAR* Name, const TCHAR* Value)
+		: CVar(IConsoleManager::Get().FindConsoleVariable(Name))
+	{
+		if (!CVar) return;
+		PreviousValue = CVar->GetString();
+		CVar->Set(Value, ECVF_SetByCode);
+	}
+
+	~FScopedTransformerCVar()
+	{
+		if (CVar)
+			CVar->Set(*PreviousValue, ECVF_SetByCode);
+	}
+
+private:
+
+	IConsoleVariable* CVar;
+	FString PreviousValue;
+};
+
+/*
+ * Parked Actors are destroyed oldest first once there are more than MaxParked, and once they've been parked
+ * for Lifetime seconds. An Actor unparked and parked again counts from its last Park.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerActorPoolExpiryTest, "RuntimeTransformer.ActorPool.Expiry"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerActorPoolExpiryTest::RunTest(const FString& Parameters)
+{
+	FTransformerTestWorld testWorld;
+	UTransformerActorPool* actorPool = UTransformerActorPool::Get(testWorld.GetWorld());
+	if (!TestNotNull(TEXT("Actor Pool"), actorPool)) return false;
+
+	AActor* a = testWorld.SpawnActor();
+	AActor* b = testWorld.SpawnActor();
+	AActor* c = testWorld.SpawnActor();
+
+	{
+		FScopedTransformerCVar lifetime(TEXT("RuntimeTransformer.ActorPool.Lifetime"), TEXT("1000"));
+		FScopedTransformerCVar maxParked(TEXT("RuntimeTransformer.ActorPool.MaxParked"), TEXT("1"));
+
+		//A is parked before B, but is parked again after it
+		actorPool->Park(a);
+		TestTrue(TEXT("A is parked"), actorPool->IsParked(a));
+		TestTrue(TEXT("A is hidden"), a->IsHidden());
+		TestTrue(TEXT("A is unparked"), actorPool->Unpark(a));
+		TestFalse(TEXT("A is visible again"), a->IsHidden());
+		actorPool->Park(b);
+		actorPool->Park(a);
+
+		actorPool->Tick(0.f);
+		TestFalse(TEXT("B (the oldest) is destroyed"), IsValid(b));
+		TestTrue(TEXT("A is still parked"), IsValid(a) && actorPool->IsParked(a));
+		TestEqual(TEXT("Parked count"), actorPool->GetParkedCount(), 1);
+	}
+
+	{
+		FScopedTransformerCVar lifetime(TEXT("RuntimeTransformer.ActorPool.Lifetime"), TEXT("0"));
+		FScopedTransformerCVar budget(TEXT("RuntimeTransformer.ActorPool.DestroyBudgetMs"), TEXT("1000"));
+
+		actorPool->Park(c);
+		actorPool->Tick(0.f);
+		TestFalse(TEXT("A has expired"), IsValid(a));
+		TestFalse(TEXT("C has expired"), IsValid(c));
+		TestEqual(TEXT("Parked count"), actorPool->GetParkedCount(), 0);
+	}
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
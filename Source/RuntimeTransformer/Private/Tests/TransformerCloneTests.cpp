@@ -0,0 +1,57 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#include "TransformerTestWorld.h"
+#include "TransformerPawn.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*
+ * Component Based cloning of part of a hierarchy (Root - A - B - C, Root - D), cloning B, C and D:
+ * the clone of B goes under A (not cloned), the clone of C under the clone of B and the clone of D under the Root.
+ * Every clone is registered, where its original is, and in the order of the Selection.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerCloneHierarchyTest, "RuntimeTransformer.Clone.ComponentHierarchy"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerCloneHierarchyTest::RunTest(const FString& Parameters)
+{
+	FTransformerTestWorld testWorld;
+	UWorld* world = testWorld.GetWorld();
+
+	AActor* actor = testWorld.SpawnActor(FTransform(FVector(100.f, 0.f, 0.f)));
+	USceneComponent* root = actor->GetRootComponent();
+	const FTransform offset(FRotator(0.f, 30.f, 0.f), FVector(0.f, 50.f, 10.f), FVector(1.5f));
+	USceneComponent* a = FTransformerTestWorld::AddComponent(actor, root, offset);
+	USceneComponent* b = FTransformerTestWorld::AddComponent(actor, a, offset);
+	USceneComponent* c = FTransformerTestWorld::AddComponent(actor, b, offset);
+	USceneComponent* d = FTransformerTestWorld::AddComponent(actor, root, offset);
+
+	ATransformerPawn* pawn = world->SpawnActor<ATransformerPawn>();
+	if (!TestNotNull(TEXT("Pawn"), pawn)) return false;
+	pawn->SetComponentBased(true);
+
+	const TArray<USceneComponent*> templates = { b, c, d };
+	pawn->SelectMultipleComponents(templates, false);
+	pawn->CloneSelected(true, false);
+
+	const TArray<USceneComponent*> clones = pawn->GetSelectedComponents();
+	if (!TestEqual(TEXT("Clone count"), clones.Num(), templates.Num())) return false;
+
+	for (int32 i = 0; i < clones.Num(); ++i)
+	{
+		if (!TestNotNull(TEXT("Clone"), clones[i])) return false;
+		TestFalse(TEXT("Clone is not its template"), clones[i] == templates[i]);
+		TestTrue(TEXT("Clone is registered"), clones[i]->IsRegistered());
+		TestTrue(TEXT("Clone is where its template is")
+			, clones[i]->GetComponentTransform().Equals(templates[i]->GetComponentTransform(), 0.01f));
+	}
+
+	TestTrue(TEXT("Clone of B is under A"), clones[0]->GetAttachParent() == a);
+	TestTrue(TEXT("Clone of C is under the clone of B"), clones[1]->GetAttachParent() == clones[0]);
+	TestTrue(TEXT("Clone of D is under the Root"), clones[2]->GetAttachParent() == root);
+	TestTrue(TEXT("C is still under B"), c->GetAttachParent() == b);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,135 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#include "TransformerTestWorld.h"
+#include "TransformerLayout.h"
+#include "TransformerActorPool.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*
+ * Exports a Layout with moved Actors, a Clone and a deleted Actor, undoes all of it and imports the Layout back:
+ * the Actors are moved back, the Clone is spawned again and the deleted Actor is destroyed.
+ * A file that isn't a Layout is rejected.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerLayoutRoundTripTest, "RuntimeTransformer.Layout.SnapshotRoundTrip"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerLayoutRoundTripTest::RunTest(const FString& Parameters)
+{
+	FTransformerTestWorld testWorld;
+	UWorld* world = testWorld.GetWorld();
+	UTransformerLayout* layout = UTransformerLayout::Get(world);
+	if (!TestNotNull(TEXT("Layout"), layout)) return false;
+
+	const FString filePath = FPaths::ProjectSavedDir() / TEXT("RuntimeTransformer") / TEXT("LayoutRoundTripTest.rtlayout");
+
+	TArray<AActor*> moved;
+	TArray<FTransform> movedTransforms;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		AActor* actor = testWorld.SpawnActor();
+		const FTransform transform(FRotator(0.f, 45.f * i, 0.f), FVector(100.f * i, 200.f, 0.f), FVector(1.f + i));
+		actor->SetActorTransform(transform);
+		layout->RecordTransform(actor->GetRootComponent());
+		moved.Add(actor);
+		movedTransforms.Add(transform);
+	}
+
+	const FTransform cloneTransform(FVector(0.f, 0.f, 5000.f));
+	FActorSpawnParameters spawnParams;
+	spawnParams.Template = moved[0];
+	AActor* clone = world->SpawnActor(moved[0]->GetClass(), &cloneTransform, spawnParams);
+	if (!TestNotNull(TEXT("Clone"), clone)) return false;
+	clone->SetActorTransform(cloneTransform);
+	layout->RecordClone(clone, moved[0]);
+
+	AActor* deleted = testWorld.SpawnActor();
+	layout->RecordDestroyed(deleted);
+
+	if (!TestTrue(TEXT("Layout exported"), layout->ExportLayout(filePath))) return false;
+
+	//back to before the edits (the deleted Actor was never actually destroyed)
+	layout->ResetLayout();
+	clone->Destroy();
+	for (AActor* actor : moved)
+		actor->SetActorTransform(FTransform::Identity);
+
+	TestTrue(TEXT("Layout imported"), layout->ImportLayout(filePath));
+
+	for (int32 i = 0; i < moved.Num(); ++i)
+	{
+		TestTrue(FString::Printf(TEXT("Actor %d is back in place"), i)
+			, moved[i]->GetActorTransform().Equals(movedTransforms[i], 0.01f));
+	}
+	TestFalse(TEXT("Deleted Actor is destroyed"), IsValid(deleted));
+
+	int32 clones = 0;
+	for (TActorIterator<AActor> it(world); it; ++it)
+	{
+		if (*it != clone && it->GetActorLocation().Equals(cloneTransform.GetLocation(), 0.01f))
+			++clones;
+	}
+	TestEqual(TEXT("Clones spawned back"), clones, 1);
+
+	//shorter than a Layout header
+	const FString invalidPath = FPaths::ProjectSavedDir() / TEXT("RuntimeTransformer") / TEXT("LayoutRoundTripTest.invalid");
+	FFileHelper::SaveStringToFile(TEXT("not a layout"), *invalidPath);
+	AddExpectedError(TEXT("Could not read Layout"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestFalse(TEXT("Invalid Layout is rejected"), layout->ImportLayout(invalidPath));
+
+	IFileManager::Get().Delete(*filePath);
+	IFileManager::Get().Delete(*invalidPath);
+	return true;
+}
+
+/*
+ * A soft deleted Actor that the Actor Pool destroys once it expires is still a delete in the snapshots
+ * (before, snapshots only knew of it while it was parked).
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerLayoutExpiredSoftDeleteTest, "RuntimeTransformer.Layout.ExpiredSoftDelete"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerLayoutExpiredSoftDeleteTest::RunTest(const FString& Parameters)
+{
+	FTransformerTestWorld testWorld;
+	UTransformerLayout* layout = UTransformerLayout::Get(testWorld.GetWorld());
+	UTransformerActorPool* actorPool = UTransformerActorPool::Get(testWorld.GetWorld());
+	if (!TestNotNull(TEXT("Layout"), layout) || !TestNotNull(TEXT("Actor Pool"), actorPool)) return false;
+
+	AActor* actor = testWorld.SpawnActor();
+	const FString name = actor->GetName();
+
+	IConsoleVariable* lifetime = IConsoleManager::Get().FindConsoleVariable(TEXT("RuntimeTransformer.ActorPool.Lifetime"));
+	if (!TestNotNull(TEXT("Lifetime CVar"), lifetime)) return false;
+	const float previousLifetime = lifetime->GetFloat();
+	lifetime->Set(0.f, ECVF_SetByCode);
+	actorPool->Park(actor);
+	actorPool->Tick(0.f);
+	lifetime->Set(previousLifetime, ECVF_SetByCode);
+
+	TestFalse(TEXT("Actor has expired"), IsValid(actor));
+	TestEqual(TEXT("Delete is tracked"), layout->GetEditedObjectCount(), 1);
+
+	const FString filePath = FPaths::ProjectSavedDir() / TEXT("RuntimeTransformer") / TEXT("LayoutExpiredSoftDeleteTest.rtlayout");
+	if (!TestTrue(TEXT("Layout exported"), layout->ExportLayout(filePath))) return false;
+
+	//the only record is the delete, named by the path of the Actor
+	TArray<uint8> data;
+	FFileHelper::LoadFileToArray(data, *filePath);
+	FTCHARToUTF8 utf8Name(*name);
+	bool bFound = false;
+	for (int32 i = 0; !bFound && i + utf8Name.Length() <= data.Num(); ++i)
+		bFound = FMemory::Memcmp(data.GetData() + i, utf8Name.Get(), utf8Name.Length()) == 0;
+	TestTrue(TEXT("Delete is in the snapshot"), bFound);
+
+	IFileManager::Get().Delete(*filePath);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,55 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#include "TransformerTestWorld.h"
+#include "TransformerPawn.h"
+#include "TransformerSelectableRegistry.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*
+ * Components destroyed on their own (their Actor is still around) lose their ids and leave the named Sets:
+ * one deleted through a Component Based Transformer Pawn right away,
+ * one destroyed elsewhere once the ids of destroyed Components are pruned.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerRegistryDestroyedComponentTest, "RuntimeTransformer.SelectableRegistry.DestroyedComponent"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerRegistryDestroyedComponentTest::RunTest(const FString& Parameters)
+{
+	FTransformerTestWorld testWorld;
+	UWorld* world = testWorld.GetWorld();
+	UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(world);
+	if (!TestNotNull(TEXT("Registry"), registry)) return false;
+
+	AActor* actor = testWorld.SpawnActor();
+	USceneComponent* root = actor->GetRootComponent();
+	USceneComponent* deleted = FTransformerTestWorld::AddComponent(actor, root, FTransform::Identity);
+	USceneComponent* destroyed = FTransformerTestWorld::AddComponent(actor, root, FTransform::Identity);
+	registry->SaveComponentsAsSelectionSet(TEXT("Deleted"), { deleted });
+	registry->SaveComponentsAsSelectionSet(TEXT("Destroyed"), { destroyed });
+
+	//deleted through the Pawn
+	ATransformerPawn* pawn = world->SpawnActor<ATransformerPawn>();
+	if (!TestNotNull(TEXT("Pawn"), pawn)) return false;
+	pawn->SetComponentBased(true);
+	pawn->SelectComponent(deleted);
+	pawn->DeselectAll(true);
+
+	TestTrue(TEXT("Deleted Component is gone"), !IsValid(deleted));
+	TestEqual(TEXT("Deleted Component has no id"), registry->GetId(deleted), (int32)INDEX_NONE);
+	TestEqual(TEXT("Deleted Component left its Set"), registry->GetSelectionSetNum(TEXT("Deleted")), 0);
+
+	//destroyed without the Registry knowing: its id stays until the ids are pruned (when they run out)
+	destroyed->DestroyComponent(true);
+	while (registry->GetIdCount() <= 1024)
+		registry->Register(NewObject<USceneComponent>(actor));
+	registry->Register(NewObject<USceneComponent>(actor));
+
+	TestEqual(TEXT("Destroyed Component has no id"), registry->GetId(destroyed), (int32)INDEX_NONE);
+	TestEqual(TEXT("Destroyed Component left its Set"), registry->GetSelectionSetNum(TEXT("Destroyed")), 0);
+	TestEqual(TEXT("Root keeps its id"), registry->GetComponent(registry->GetId(root)), root);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,67 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Components/SceneComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+/**
+ * Standalone Game World (with its Subsystems) that has begun play, for the automation tests.
+ * Destroyed with everything spawned in it when this goes out of scope.
+ */
+class FTransformerTestWorld
+{
+public:
+
+	FTransformerTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& context = GEngine->CreateNewWorldContext(EWorldType::Game);
+		context.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+	}
+
+	~FTransformerTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	UWorld* GetWorld() const { return World; }
+
+	//Spawns an Actor with a Movable Scene Component as Root
+	AActor* SpawnActor(const FTransform& Transform = FTransform::Identity) const
+	{
+		AActor* actor = World->SpawnActor<AActor>();
+		USceneComponent* root = AddComponent(actor, nullptr, FTransform::Identity);
+		actor->SetRootComponent(root);
+		actor->SetActorTransform(Transform);
+		return actor;
+	}
+
+	//Adds a Movable Scene Component to the Actor, attached to Parent (if any)
+	static USceneComponent* AddComponent(AActor* Actor, USceneComponent* Parent, const FTransform& RelativeTransform)
+	{
+		USceneComponent* component = NewObject<USceneComponent>(Actor);
+		component->SetMobility(EComponentMobility::Movable);
+		if (Parent)
+			component->SetupAttachment(Parent);
+		component->SetRelativeTransform(RelativeTransform);
+		Actor->AddInstanceComponent(component);
+		component->RegisterComponent();
+		return component;
+	}
+
+private:
+
+	UWorld* World;
+};
+
+#endif //WITH_DEV_AUTOMATION_TESTS
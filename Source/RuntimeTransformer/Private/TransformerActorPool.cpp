@@ -0,0 +1,233 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerActorPool.h"
+#include "TransformerEditState.h"
+#include "TransformerLayout.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarActorPoolLifetime(
+	TEXT("RuntimeTransformer.ActorPool.Lifetime"),
+	30.f,
+	TEXT("Seconds a soft deleted Actor stays parked (restorable) before it is actually destroyed"));
+
+static TAutoConsoleVariable<int32> CVarActorPoolMaxParked(
+	TEXT("RuntimeTransformer.ActorPool.MaxParked"),
+	10000,
+	TEXT("Max number of parked Actors. The oldest are destroyed first"));
+
+static TAutoConsoleVariable<float> CVarActorPoolDestroyBudgetMs(
+	TEXT("RuntimeTransformer.ActorPool.DestroyBudgetMs"),
+	1.f,
+	TEXT("Milliseconds per frame spent destroying parked Actors. At least one is destroyed every frame there's one to destroy"));
+
+UTransformerActorPool* UTransformerActorPool::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerActorPool>() : nullptr;
+}
+
+bool UTransformerActorPool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerActorPool::Park(AActor* Actor)
+{
+	if (!IsValid(Actor) || Parked.Contains(Actor)) return;
+
+	FParkedActor& parked = Parked.Add(Actor);
+	parked.ParkTime = FPlatformTime::Seconds();
+	parked.Sequence = NextParkSequence++;
+	parked.bWasHidden = Actor->IsHidden();
+	parked.bHadCollision = Actor->GetActorEnableCollision();
+	parked.bWasTicking = Actor->IsActorTickEnabled();
+
+	for (UActorComponent* component : Actor->GetComponents())
+	{
+		if (!component) continue;
+		if (component->IsComponentTickEnabled())
+		{
+			parked.TickingComponents.Add(component);
+			component->SetComponentTickEnabled(false);
+		}
+		UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(component);
+		if (primitive && primitive->IsSimulatingPhysics())
+		{
+			parked.SimulatingComponents.Add(primitive);
+			primitive->SetSimulatePhysics(false);
+		}
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	if (TWeakObjectPtr<AActor>* templateActor = CloneTemplates.Find(Actor))
+	{
+		parked.Template = *templateActor;
+		ParkedClones.Add(*templateActor, Actor);
+	}
+
+	ParkOrder.Add({ Actor, parked.Sequence });
+}
+
+bool UTransformerActorPool::Unpark(AActor* Actor)
+{
+	FParkedActor parked;
+	if (!IsValid(Actor) || !Parked.RemoveAndCopyValue(Actor, parked))
+		return false;
+
+	if (parked.Template.IsValid())
+		ParkedClones.RemoveSingle(parked.Template, Actor);
+
+	Actor->SetActorHiddenInGame(parked.bWasHidden);
+	Actor->SetActorEnableCollision(parked.bHadCollision);
+	Actor->SetActorTickEnabled(parked.bWasTicking);
+
+	for (auto& component : parked.TickingComponents)
+	{
+		if (component.IsValid()) component->SetComponentTickEnabled(true);
+	}
+	for (auto& primitive : parked.SimulatingComponents)
+	{
+		if (primitive.IsValid()) primitive->SetSimulatePhysics(true);
+	}
+	return true;
+}
+
+void UTransformerActorPool::RegisterClone(AActor* Clone, AActor* Template)
+{
+	if (!Clone || !Template) return;
+
+	//forget the Clones (or Templates) that are gone, every time the map doubles
+	if (CloneTemplates.Num() >= CloneTemplatesPruneSize)
+	{
+		for (auto it = CloneTemplates.CreateIterator(); it; ++it)
+		{
+			if (!it->Key.IsValid() || !it->Value.IsValid())
+				it.RemoveCurrent();
+		}
+		CloneTemplatesPruneSize = FMath::Max(1024, CloneTemplates.Num() * 2);
+	}
+
+	CloneTemplates.Add(Clone, Template);
+}
+
+AActor* UTransformerActorPool::ReuseClone(AActor* Template)
+{
+	if (!Template) return nullptr;
+
+	TArray<TWeakObjectPtr<AActor>> clones;
+	ParkedClones.MultiFind(Template, clones);
+	for (auto& clone : clones)
+	{
+		AActor* actor = clone.Get();
+		if (!actor || !Unpark(actor)) continue;
+
+		//a new Clone would be where the Template is
+		actor->SetActorTransform(Template->GetActorTransform());
+		return actor;
+	}
+	return nullptr;
+}
+
+void UTransformerActorPool::GetParkedActors(TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset(Parked.Num());
+	for (auto& it : Parked)
+	{
+		if (AActor* actor = it.Key.Get())
+			OutActors.Add(actor);
+	}
+}
+
+void UTransformerActorPool::DestroyParked(AActor* Actor)
+{
+	//snapshots only know of soft deletes while the Actor is parked: from now on it's a delete like any other
+	if (UTransformerLayout* layout = UTransformerLayout::Get(this))
+		layout->RecordDestroyed(Actor);
+	if (ATransformerEditState* editState = ATransformerEditState::Get(this, false))
+		editState->RecordDestroyed(Actor);
+	Actor->Destroy();
+}
+
+void UTransformerActorPool::DestroyAll()
+{
+	for (auto& it : Parked)
+	{
+		if (AActor* actor = it.Key.Get())
+			DestroyParked(actor);
+	}
+	Parked.Reset();
+	ParkOrder.Reset();
+	ParkOrderHead = 0;
+	ParkedClones.Reset();
+}
+
+void UTransformerActorPool::Deinitialize()
+{
+	//the World is going away with all its Actors
+	Parked.Reset();
+	ParkOrder.Reset();
+	ParkedClones.Reset();
+	CloneTemplates.Reset();
+	Super::Deinitialize();
+}
+
+void UTransformerActorPool::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (ParkOrderHead >= ParkOrder.Num()) return;
+
+	const double startTime = FPlatformTime::Seconds();
+	const double deadline = startTime + FMath::Max(CVarActorPoolDestroyBudgetMs.GetValueOnGameThread(), 0.f) / 1000.0;
+	const double expireTime = startTime - CVarActorPoolLifetime.GetValueOnGameThread();
+	const int32 maxParked = FMath::Max(CVarActorPoolMaxParked.GetValueOnGameThread(), 0);
+
+	bool bDestroyed = false;
+	while (ParkOrderHead < ParkOrder.Num())
+	{
+		//always make some progress, even if the budget is tiny
+		if (bDestroyed && FPlatformTime::Seconds() >= deadline)
+			break;
+
+		TWeakObjectPtr<AActor> actor = ParkOrder[ParkOrderHead].Actor;
+		const FParkedActor* parked = Parked.Find(actor);
+		if (!parked || parked->Sequence != ParkOrder[ParkOrderHead].Sequence)
+		{
+			++ParkOrderHead; //unparked (or gone) since. If parked again, its newer entry is further on
+			continue;
+		}
+
+		//oldest first, so none of the rest has expired either
+		if (parked->ParkTime > expireTime && Parked.Num() <= maxParked)
+			break;
+
+		if (parked->Template.IsValid())
+			ParkedClones.RemoveSingle(parked->Template, actor);
+		Parked.Remove(actor);
+		CloneTemplates.Remove(actor);
+		++ParkOrderHead;
+
+		if (actor.IsValid())
+			DestroyParked(actor.Get());
+		bDestroyed = true;
+	}
+
+	//Don't let the consumed part of the order grow forever
+	if (ParkOrderHead > 1024 && ParkOrderHead * 2 > ParkOrder.Num())
+	{
+		ParkOrder.RemoveAt(0, ParkOrderHead);
+		ParkOrderHead = 0;
+	}
+}
+
+TStatId UTransformerActorPool::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTransformerActorPool, STATGROUP_Tickables);
+}
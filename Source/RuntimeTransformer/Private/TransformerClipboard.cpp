@@ -0,0 +1,269 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerClipboard.h"
+#include "RuntimeTransformer.h"
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/UObjectGlobals.h"
+
+//"RTCB"
+static const uint32 ClipboardMagic = 0x42435452;
+
+enum class EClipboardVersion : int32
+{
+	Initial = 1,
+
+	//add new versions above this line
+	VersionPlusOne,
+	Latest = VersionPlusOne - 1,
+};
+
+/**
+ * Writes / Reads the properties of an Actor (or of one of its components) to / from the clipboard.
+ * Object references are written as paths, except for the ones to objects within the Actor,
+ * which are written as empty and, when read, keep whatever the property had (i.e. the new Actor's own object)
+ */
+class FTransformerClipboardArchive : public FObjectAndNameAsStringProxyArchive
+{
+public:
+
+	FTransformerClipboardArchive(FArchive& InInnerArchive, const AActor* InActor)
+		: FObjectAndNameAsStringProxyArchive(InInnerArchive, false)
+		, Actor(InActor)
+	{
+	}
+
+	virtual FArchive& operator<<(UObject*& Obj) override
+	{
+		if (IsLoading())
+		{
+			FString path;
+			InnerArchive << path;
+			if (!path.IsEmpty())
+				Obj = FindObject<UObject>(nullptr, *path);
+			if (!Obj && !path.IsEmpty())
+				Obj = LoadObject<UObject>(nullptr, *path);
+		}
+		else
+		{
+			FString path = (Obj && Obj != Actor && !Obj->IsIn(Actor)) ? Obj->GetPathName() : FString();
+			InnerArchive << path;
+		}
+		return *this;
+	}
+
+	virtual FArchive& operator<<(FObjectPtr& Obj) override
+	{
+		UObject* object = Obj.Get();
+		*this << object;
+		if (IsLoading())
+			Obj = object;
+		return *this;
+	}
+
+	virtual bool ShouldSkipProperty(const FProperty* InProperty) const override
+	{
+		return InProperty->HasAnyPropertyFlags(CPF_Transient | CPF_DuplicateTransient
+			| CPF_NonPIEDuplicateTransient | CPF_Deprecated);
+	}
+
+private:
+
+	const AActor* Actor;
+};
+
+static void WriteProperties(UObject* Object, const AActor* Actor, TArray<uint8>& OutBytes)
+{
+	FMemoryWriter writer(OutBytes, true);
+	FTransformerClipboardArchive archive(writer, Actor);
+	Object->SerializeScriptProperties(archive);
+}
+
+static void ReadProperties(UObject* Object, const AActor* Actor, const TArray<uint8>& Bytes)
+{
+	FMemoryReader reader(Bytes, true);
+	FTransformerClipboardArchive archive(reader, Actor);
+	Object->SerializeScriptProperties(archive);
+}
+
+struct FClipboardComponent
+{
+	FString Name;
+	TArray<uint8> Properties;
+
+	friend FArchive& operator<<(FArchive& Ar, FClipboardComponent& Component)
+	{
+		return Ar << Component.Name << Component.Properties;
+	}
+};
+
+struct FClipboardActor
+{
+	FString ClassPath;
+	FTransform RelativeTransform;
+	TArray<uint8> Properties;
+	TArray<FClipboardComponent> Components;
+
+	friend FArchive& operator<<(FArchive& Ar, FClipboardActor& Actor)
+	{
+		return Ar << Actor.ClassPath << Actor.RelativeTransform << Actor.Properties << Actor.Components;
+	}
+};
+
+FTransformerClipboard& FTransformerClipboard::Get()
+{
+	static FTransformerClipboard Instance;
+	return Instance;
+}
+
+FTransformerClipboard::FTransformerClipboard()
+	: ActorCount(0)
+{
+}
+
+void FTransformerClipboard::Empty()
+{
+	Data.Empty();
+	ActorCount = 0;
+}
+
+int32 FTransformerClipboard::Copy(const TArray<AActor*>& Actors, const FTransform& Pivot)
+{
+	TArray<FClipboardActor> entries;
+	for (auto& actor : Actors)
+	{
+		if (!IsValid(actor)) continue;
+
+		FClipboardActor& entry = entries.AddDefaulted_GetRef();
+		entry.ClassPath = actor->GetClass()->GetPathName();
+		entry.RelativeTransform = actor->GetActorTransform().GetRelativeTransform(Pivot);
+		WriteProperties(actor, actor, entry.Properties);
+
+		for (UActorComponent* component : actor->GetComponents())
+		{
+			if (!component) continue;
+			FClipboardComponent& componentEntry = entry.Components.AddDefaulted_GetRef();
+			componentEntry.Name = component->GetName();
+			WriteProperties(component, actor, componentEntry.Properties);
+		}
+	}
+
+	Data.Reset();
+	FMemoryWriter writer(Data, true);
+
+	uint32 magic = ClipboardMagic;
+	int32 version = (int32)EClipboardVersion::Latest;
+	writer << magic << version << entries;
+
+	ActorCount = entries.Num();
+	return ActorCount;
+}
+
+//Reads the entries of the given clipboard data. Returns false if it's not valid clipboard data
+static bool ReadClipboard(const TArray<uint8>& Data, TArray<FClipboardActor>& OutEntries)
+{
+	if (Data.Num() == 0) return false;
+
+	FMemoryReader reader(Data, true);
+	uint32 magic = 0;
+	int32 version = 0;
+	reader << magic << version;
+	if (magic != ClipboardMagic || version <= 0 || version > (int32)EClipboardVersion::Latest)
+		return false;
+
+	reader << OutEntries;
+	return !reader.IsError();
+}
+
+TArray<AActor*> FTransformerClipboard::Paste(UWorld* World, const TArray<FTransform>& Targets) const
+{
+	TArray<AActor*> outActors;
+	if (!World || IsEmpty()) return outActors;
+
+	TArray<FClipboardActor> entries;
+	if (!ReadClipboard(Data, entries)) return outActors;
+
+	TArray<UClass*> classes;
+	for (auto& entry : entries)
+		classes.Add(LoadObject<UClass>(nullptr, *entry.ClassPath));
+
+	for (auto& target : Targets)
+	{
+		for (int32 i = 0; i < entries.Num(); ++i)
+		{
+			const FClipboardActor& entry = entries[i];
+			if (!classes[i] || !classes[i]->IsChildOf(AActor::StaticClass())) continue;
+
+			const FTransform transform = entry.RelativeTransform * target;
+			AActor* actor = World->SpawnActorDeferred<AActor>(classes[i], transform
+				, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+			if (!actor) continue;
+
+			ReadProperties(actor, actor, entry.Properties);
+
+			//Components of the Class exist already (not registered yet). The ones of the Construction Script are made in FinishSpawning
+			TArray<const FClipboardComponent*> laterComponents;
+			for (auto& componentEntry : entry.Components)
+			{
+				UActorComponent* component = FindObjectFast<UActorComponent>(actor, *componentEntry.Name);
+				if (component)
+					ReadProperties(component, actor, componentEntry.Properties);
+				else
+					laterComponents.Add(&componentEntry);
+			}
+
+			actor->FinishSpawning(transform);
+
+			for (auto& componentEntry : laterComponents)
+			{
+				UActorComponent* component = FindObjectFast<UActorComponent>(actor, *componentEntry->Name);
+				if (!component) continue; //added at runtime to the copied actor
+
+				const bool bRegistered = component->IsRegistered();
+				if (bRegistered) component->UnregisterComponent();
+				ReadProperties(component, actor, componentEntry->Properties);
+				if (bRegistered) component->RegisterComponent();
+			}
+
+			//the copied Root Component properties have the copied Actor's transform
+			actor->SetActorTransform(transform);
+			outActors.Add(actor);
+		}
+	}
+
+	return outActors;
+}
+
+bool FTransformerClipboard::ExportToFile(const FString& FilePath) const
+{
+	if (!IsEmpty() && FFileHelper::SaveArrayToFile(Data, *FilePath))
+	{
+		UE_LOG(LogRuntimeTransformer, Log, TEXT("Clipboard (%d Actors, %d bytes) written to %s")
+			, ActorCount, Data.Num(), *FilePath);
+		return true;
+	}
+
+	UE_LOG(LogRuntimeTransformer, Warning, TEXT("Failed to write Clipboard to %s"), *FilePath);
+	return false;
+}
+
+bool FTransformerClipboard::ImportFromFile(const FString& FilePath)
+{
+	TArray<uint8> fileData;
+	TArray<FClipboardActor> entries;
+	if (!FFileHelper::LoadFileToArray(fileData, *FilePath) || !ReadClipboard(fileData, entries))
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("%s is not a valid Clipboard file"), *FilePath);
+		return false;
+	}
+
+	Data = MoveTemp(fileData);
+	ActorCount = entries.Num();
+	return true;
+}
@@ -0,0 +1,60 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerCloneAsyncAction.h"
+
+UTransformerCloneAsyncAction* UTransformerCloneAsyncAction::CloneSelectedTimeSliced(ATransformerPawn* TransformerPawn
+	, bool bSelectNewClones, bool bAppendToList, ECloneSelectionUpdate SelectionUpdate)
+{
+	UTransformerCloneAsyncAction* action = NewObject<UTransformerCloneAsyncAction>();
+	action->Pawn = TransformerPawn;
+	action->bSelectNewClones = bSelectNewClones;
+	action->bAppendToList = bAppendToList;
+	action->SelectionUpdate = SelectionUpdate;
+	action->RegisterWithGameInstance(TransformerPawn);
+	return action;
+}
+
+void UTransformerCloneAsyncAction::Activate()
+{
+	ATransformerPawn* pawn = Pawn.Get();
+	if (!pawn)
+	{
+		Finish(TArray<USceneComponent*>(), true);
+		return;
+	}
+
+	pawn->OnCloneProgress.AddDynamic(this, &UTransformerCloneAsyncAction::HandleCloneProgress);
+	pawn->OnCloneFinished.AddDynamic(this, &UTransformerCloneAsyncAction::HandleCloneFinished);
+
+	if (!pawn->CloneSelectedTimeSliced(bSelectNewClones, bAppendToList, SelectionUpdate))
+		Finish(TArray<USceneComponent*>(), true);
+}
+
+void UTransformerCloneAsyncAction::HandleCloneProgress(int32 ClonesDone, int32 ClonesTotal)
+{
+	ATransformerPawn* pawn = Pawn.Get();
+	OnProgress.Broadcast(pawn ? pawn->GetTimeSlicedClones() : TArray<USceneComponent*>()
+		, ClonesTotal > 0 ? (float)ClonesDone / ClonesTotal : 1.f);
+}
+
+void UTransformerCloneAsyncAction::HandleCloneFinished(const TArray<USceneComponent*>& Clones, bool bCancelled)
+{
+	Finish(Clones, bCancelled);
+}
+
+void UTransformerCloneAsyncAction::Finish(const TArray<USceneComponent*>& Clones, bool bCancelled)
+{
+	if (ATransformerPawn* pawn = Pawn.Get())
+	{
+		pawn->OnCloneProgress.RemoveDynamic(this, &UTransformerCloneAsyncAction::HandleCloneProgress);
+		pawn->OnCloneFinished.RemoveDynamic(this, &UTransformerCloneAsyncAction::HandleCloneFinished);
+	}
+
+	if (bCancelled)
+		OnCancelled.Broadcast(Clones, 1.f);
+	else
+		OnCompleted.Broadcast(Clones, 1.f);
+
+	SetReadyToDestroy();
+}
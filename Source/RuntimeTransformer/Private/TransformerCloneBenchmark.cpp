@@ -0,0 +1,89 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+/*
+ * Times Component Based cloning (CloneSelected with bComponentBased) of big component hierarchies:
+ *
+ *	RuntimeTransformer.CloneBenchmark [Count=1000] [Depth=10] [Runs=5]
+ *
+ * Spawns an Actor with Count Static Mesh Components in chains of Depth under its Root,
+ * selects all of them with a temporary Transformer Pawn and clones them Runs times,
+ * logging the time of each run. Everything spawned is destroyed at the end.
+ */
+
+#include "TransformerPawn.h"
+#include "RuntimeTransformer.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static void RunCloneBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World) return;
+
+	const int32 count = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000);
+	const int32 depth = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10);
+	const int32 runs = FMath::Max(1, Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 5);
+
+	UStaticMesh* mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.ObjectFlags |= RF_Transient;
+	AActor* actor = World->SpawnActor<AActor>(spawnParams);
+	ATransformerPawn* pawn = World->SpawnActor<ATransformerPawn>(spawnParams);
+	if (!actor || !pawn)
+	{
+		if (actor) actor->Destroy();
+		if (pawn) pawn->Destroy();
+		return;
+	}
+
+	USceneComponent* root = NewObject<USceneComponent>(actor, TEXT("BenchmarkRoot"));
+	root->SetMobility(EComponentMobility::Movable);
+	actor->SetRootComponent(root);
+	actor->AddInstanceComponent(root);
+	root->RegisterComponent();
+
+	TArray<USceneComponent*> components;
+	components.Reserve(count);
+	for (int32 i = 0; i < count; ++i)
+	{
+		UStaticMeshComponent* component = NewObject<UStaticMeshComponent>(actor);
+		component->SetMobility(EComponentMobility::Movable);
+		component->SetStaticMesh(mesh);
+		component->SetupAttachment((i % depth == 0) ? root : components.Last());
+		component->SetRelativeLocation(FVector(0.f, 0.f, 100.f));
+		actor->AddInstanceComponent(component);
+		component->RegisterComponent();
+		components.Add(component);
+	}
+
+	pawn->SetComponentBased(true);
+
+	double totalMs = 0.0;
+	for (int32 run = 0; run < runs; ++run)
+	{
+		pawn->SelectMultipleComponents(components, false);
+
+		const double startTime = FPlatformTime::Seconds();
+		pawn->CloneSelected(false);
+		const double runMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+		totalMs += runMs;
+
+		UE_LOG(LogRuntimeTransformer, Log, TEXT("CloneBenchmark: run %d, %d components (depth %d) cloned in %.2f ms")
+			, run + 1, count, depth, runMs);
+	}
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("CloneBenchmark: %.2f ms average, %.2f us per component")
+		, totalMs / runs, totalMs * 1000.0 / ((double)runs * count));
+
+	pawn->DeselectAll();
+	pawn->Destroy();
+	actor->Destroy();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CloneBenchmarkCommand(
+	TEXT("RuntimeTransformer.CloneBenchmark"),
+	TEXT("Times Component Based cloning of big hierarchies. Usage: RuntimeTransformer.CloneBenchmark [Count=1000] [Depth=10] [Runs=5]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunCloneBenchmark));
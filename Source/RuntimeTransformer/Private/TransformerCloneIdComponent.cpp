@@ -0,0 +1,90 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerCloneIdComponent.h"
+#include "TransformerPawn.h"
+#include "EngineUtils.h"
+#include "Net/UnrealNetwork.h"
+
+UTransformerCloneIdComponent::UTransformerCloneIdComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+	CloneId = INDEX_NONE;
+}
+
+void UTransformerCloneIdComponent::GetLifetimeReplicatedProps(
+	TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME_CONDITION(UTransformerCloneIdComponent, CloneId, COND_InitialOnly);
+}
+
+UTransformerCloneIdComponent* UTransformerCloneIdComponent::AddTo(AActor* Clone, int32 CloneId)
+{
+	if (!Clone) return nullptr;
+
+	UTransformerCloneIdComponent* component = NewObject<UTransformerCloneIdComponent>(Clone);
+	component->CloneId = CloneId;
+	Clone->AddInstanceComponent(component);
+	component->RegisterComponent();
+	return component;
+}
+
+AActor* UTransformerCloneIdComponent::ConsumeArrivedClone(const UObject* WorldContextObject, int32 CloneId)
+{
+	UTransformerCloneIds* cloneIds = UTransformerCloneIds::Get(WorldContextObject);
+	return cloneIds ? cloneIds->ConsumeArrivedClone(CloneId) : nullptr;
+}
+
+void UTransformerCloneIdComponent::OnRep_CloneId()
+{
+	AActor* owner = GetOwner();
+	UWorld* world = GetWorld();
+	if (!owner || !world) return;
+
+	//Whichever Pawn spawned a local clone for this Id replaces it with this one
+	for (TActorIterator<ATransformerPawn> it(world); it; ++it)
+	{
+		if (it->BindCloneProxy(CloneId, owner))
+			return;
+	}
+
+	//The Clone Command hasn't arrived yet. The Pawn will pick this up when it does
+	if (UTransformerCloneIds* cloneIds = UTransformerCloneIds::Get(world))
+		cloneIds->AddArrivedClone(CloneId, owner);
+}
+
+UTransformerCloneIds* UTransformerCloneIds::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerCloneIds>() : nullptr;
+}
+
+bool UTransformerCloneIds::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerCloneIds::Deinitialize()
+{
+	ArrivedClones.Reset();
+	Super::Deinitialize();
+}
+
+void UTransformerCloneIds::AddArrivedClone(int32 CloneId, AActor* Clone)
+{
+	for (auto it = ArrivedClones.CreateIterator(); it; ++it)
+	{
+		if (!it->Value.IsValid())
+			it.RemoveCurrent();
+	}
+	ArrivedClones.Add(CloneId, Clone);
+}
+
+AActor* UTransformerCloneIds::ConsumeArrivedClone(int32 CloneId)
+{
+	TWeakObjectPtr<AActor> clone;
+	ArrivedClones.RemoveAndCopyValue(CloneId, clone);
+	return clone.Get();
+}
@@ -0,0 +1,99 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+/*
+ * Compares destroying Actors against soft deleting them (UTransformerActorPool) in mass delete / restore cycles:
+ *
+ *	RuntimeTransformer.DeleteBenchmark [Count=5000] [Cycles=5]
+ *
+ * Spawns Count Static Mesh Actors and, for each mode, runs Cycles of:
+ * deleting all of them, a full Garbage Collection, and restoring them
+ * (destroy mode spawns them again, soft delete mode unparks them),
+ * logging the average time of each step. Everything spawned is destroyed at the end.
+ */
+
+#include "TransformerActorPool.h"
+#include "RuntimeTransformer.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectGlobals.h"
+
+static void RunDeleteBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	UTransformerActorPool* actorPool = UTransformerActorPool::Get(World);
+	if (!actorPool) return;
+
+	const int32 count = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000);
+	const int32 cycles = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 5);
+
+	UStaticMesh* mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+
+	auto spawnActors = [World, mesh, count](TArray<AActor*>& OutActors)
+		{
+			FActorSpawnParameters spawnParams;
+			spawnParams.ObjectFlags |= RF_Transient;
+			spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+			OutActors.Reset(count);
+			for (int32 i = 0; i < count; ++i)
+			{
+				const FVector location(200.f * (i % 100), 200.f * (i / 100), 0.f);
+				AStaticMeshActor* actor = World->SpawnActor<AStaticMeshActor>(location, FRotator::ZeroRotator, spawnParams);
+				if (!actor) continue;
+				actor->SetMobility(EComponentMobility::Movable);
+				actor->GetStaticMeshComponent()->SetStaticMesh(mesh);
+				OutActors.Add(actor);
+			}
+		};
+
+	TArray<AActor*> actors;
+	spawnActors(actors);
+
+	for (int32 mode = 0; mode < 2; ++mode)
+	{
+		const bool bSoftDelete = mode == 1;
+		double deleteMs = 0.0, gcMs = 0.0, restoreMs = 0.0;
+
+		for (int32 cycle = 0; cycle < cycles; ++cycle)
+		{
+			double startTime = FPlatformTime::Seconds();
+			for (AActor* actor : actors)
+			{
+				if (bSoftDelete)
+					actorPool->Park(actor);
+				else
+					actor->Destroy();
+			}
+			deleteMs += (FPlatformTime::Seconds() - startTime) * 1000.0;
+
+			startTime = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+			gcMs += (FPlatformTime::Seconds() - startTime) * 1000.0;
+
+			startTime = FPlatformTime::Seconds();
+			if (bSoftDelete)
+			{
+				for (AActor* actor : actors)
+					actorPool->Unpark(actor);
+			}
+			else
+				spawnActors(actors);
+			restoreMs += (FPlatformTime::Seconds() - startTime) * 1000.0;
+		}
+
+		UE_LOG(LogRuntimeTransformer, Log, TEXT("DeleteBenchmark (%s): %d actors, %d cycles. Delete %.2f ms, GC %.2f ms, Restore %.2f ms (average per cycle)")
+			, bSoftDelete ? TEXT("Soft Delete") : TEXT("Destroy"), actors.Num(), cycles
+			, deleteMs / cycles, gcMs / cycles, restoreMs / cycles);
+	}
+
+	for (AActor* actor : actors)
+		actor->Destroy();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DeleteBenchmarkCommand(
+	TEXT("RuntimeTransformer.DeleteBenchmark"),
+	TEXT("Compares destroying against soft deleting Actors in delete / GC / restore cycles. Usage: RuntimeTransformer.DeleteBenchmark [Count=5000] [Cycles=5]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunDeleteBenchmark));
@@ -0,0 +1,130 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerEditScheduler.h"
+#include "TransformerPawn.h"
+#include "TransformerNetStats.h"
+#include "RuntimeTransformer.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarEditSchedulerBudgetMs(
+	TEXT("RuntimeTransformer.EditScheduler.BudgetMs"),
+	2.f,
+	TEXT("Milliseconds per frame the Server spends running queued Transformer edits. At least one step runs every frame"));
+
+UTransformerEditScheduler* UTransformerEditScheduler::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerEditScheduler>() : nullptr;
+}
+
+bool UTransformerEditScheduler::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerEditScheduler::Enqueue(ATransformerPawn* Pawn, const FName& CommandName, FEditStep&& Step)
+{
+	if (!Pawn) return;
+
+	FPawnQueue* queue = Queues.FindByPredicate([Pawn](const FPawnQueue& q) { return q.Pawn == Pawn; });
+	if (!queue)
+	{
+		queue = &Queues.AddDefaulted_GetRef();
+		queue->Pawn = Pawn;
+	}
+
+	FEditCommand& command = queue->Commands.AddDefaulted_GetRef();
+	command.Name = CommandName;
+	command.Step = MoveTemp(Step);
+	command.EnqueueTime = FPlatformTime::Seconds();
+
+	++QueueDepth;
+	PeakQueueDepth = FMath::Max(PeakQueueDepth, QueueDepth);
+}
+
+bool UTransformerEditScheduler::HasPendingCommands(const ATransformerPawn* Pawn) const
+{
+	return Queues.ContainsByPredicate([Pawn](const FPawnQueue& q)
+		{
+			return q.Pawn == Pawn && q.Commands.Num() > 0;
+		});
+}
+
+void UTransformerEditScheduler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Queues.Num() == 0) return;
+
+#if RUNTIMETRANSFORMER_NET_STATS
+	FTransformerNetStats::Get().SampleEditQueueDepth(QueueDepth);
+#endif
+
+	const double startTime = FPlatformTime::Seconds();
+	const double deadline = startTime + FMath::Max(CVarEditSchedulerBudgetMs.GetValueOnGameThread(), 0.f) / 1000.0;
+
+	bool bRanStep = false;
+	while (Queues.Num() > 0)
+	{
+		//always make some progress, even if the budget is tiny
+		if (bRanStep && FPlatformTime::Seconds() >= deadline)
+			break;
+
+		if (!Queues.IsValidIndex(NextQueue))
+			NextQueue = 0;
+
+		//the pawn is gone (e.g. client disconnected). Its commands go with it
+		if (!Queues[NextQueue].Pawn.IsValid() || Queues[NextQueue].Commands.Num() == 0)
+		{
+			QueueDepth -= Queues[NextQueue].Commands.Num();
+			Queues.RemoveAt(NextQueue);
+			continue;
+		}
+
+		TWeakObjectPtr<ATransformerPawn> pawn = Queues[NextQueue].Pawn;
+		FEditCommand& command = Queues[NextQueue].Commands[0];
+		if (!command.bStarted)
+		{
+			command.bStarted = true;
+			const double waitTime = FPlatformTime::Seconds() - command.EnqueueTime;
+			++StartedCommands;
+			TotalWaitTime += waitTime;
+			MaxWaitTime = FMath::Max(MaxWaitTime, waitTime);
+#if RUNTIMETRANSFORMER_NET_STATS
+			FTransformerNetStats::Get().RecordEditWait(waitTime);
+#endif
+		}
+
+		//The step could queue more commands, so don't hold on to references into Queues while it runs
+		FEditStep step = MoveTemp(command.Step);
+		const bool bFinished = step(deadline);
+		bRanStep = true;
+
+		const int32 queueIndex = Queues.IndexOfByPredicate([&pawn](const FPawnQueue& q) { return q.Pawn == pawn; });
+		if (queueIndex == INDEX_NONE) continue;
+
+		FPawnQueue& queue = Queues[queueIndex];
+		if (bFinished)
+		{
+			queue.Commands.RemoveAt(0);
+			--QueueDepth;
+		}
+		else
+			queue.Commands[0].Step = MoveTemp(step);
+
+		if (queue.Commands.Num() == 0)
+		{
+			Queues.RemoveAt(queueIndex);
+			NextQueue = queueIndex;
+		}
+		else
+			NextQueue = queueIndex + 1; //round robin: next pawn's turn
+	}
+}
+
+TStatId UTransformerEditScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTransformerEditScheduler, STATGROUP_Tickables);
+}
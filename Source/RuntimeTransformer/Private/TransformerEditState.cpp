@@ -0,0 +1,288 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerEditState.h"
+#include "TransformerPawn.h"
+#include "TransformerSelectableRegistry.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/SoftObjectPath.h"
+
+void FTransformerTransformOverride::PostReplicatedAdd(const FTransformerTransformOverrideArray& InArraySerializer)
+{
+	ATransformerEditState::ApplyTransformOverride(*this);
+}
+
+void FTransformerTransformOverride::PostReplicatedChange(const FTransformerTransformOverrideArray& InArraySerializer)
+{
+	ATransformerEditState::ApplyTransformOverride(*this);
+}
+
+void FTransformerDestroyedObject::PostReplicatedAdd(const FTransformerDestroyedObjectArray& InArraySerializer)
+{
+	ATransformerEditState::ApplyDestroyed(*this);
+}
+
+void FTransformerPawnSelectionArray::MarkPawnChanged(const TArrayView<int32>& Indices)
+{
+	for (int32 index : Indices)
+	{
+		if (Items.IsValidIndex(index) && Items[index].Pawn)
+			ChangedPawns.Add(Items[index].Pawn);
+	}
+}
+
+void FTransformerPawnSelectionArray::PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize)
+{
+	MarkPawnChanged(RemovedIndices);
+}
+
+void FTransformerPawnSelectionArray::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	MarkPawnChanged(AddedIndices);
+}
+
+void FTransformerPawnSelectionArray::PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize)
+{
+	MarkPawnChanged(ChangedIndices);
+}
+
+void FTransformerPawnSelectionArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (ChangedPawns.Num() == 0) return;
+
+	TSet<TWeakObjectPtr<ATransformerPawn>> changedPawns = MoveTemp(ChangedPawns);
+	ChangedPawns.Reset();
+
+	TMap<ATransformerPawn*, TArray<const FTransformerPawnSelection*>> pawnItems;
+	for (auto& pawn : changedPawns)
+	{
+		//the owning client is the one that knows best what it has selected
+		if (pawn.IsValid() && !pawn->IsLocallyControlled())
+			pawnItems.Add(pawn.Get());
+	}
+	if (pawnItems.Num() == 0) return;
+
+	for (auto& item : Items)
+	{
+		if (auto* items = pawnItems.Find(item.Pawn))
+			items->Add(&item);
+	}
+
+	for (auto& it : pawnItems)
+	{
+		it.Value.Sort([](const FTransformerPawnSelection& a, const FTransformerPawnSelection& b)
+			{
+				return a.Order < b.Order;
+			});
+
+		TArray<USceneComponent*> components;
+		components.Reserve(it.Value.Num());
+		for (auto* item : it.Value)
+			components.Add(item->Component);
+		it.Key->ApplyReplicatedSelection(components);
+	}
+}
+
+ATransformerEditState::ATransformerEditState()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	NetUpdateFrequency = 10.f;
+}
+
+void ATransformerEditState::GetLifetimeReplicatedProps(
+	TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ATransformerEditState, TransformOverrides);
+	DOREPLIFETIME(ATransformerEditState, DestroyedObjects);
+	DOREPLIFETIME(ATransformerEditState, Selections);
+}
+
+ATransformerEditState* ATransformerEditState::Get(const UObject* WorldContextObject, bool bCreate)
+{
+	UWorld* world = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	if (!world) return nullptr;
+
+	for (TActorIterator<ATransformerEditState> it(world); it; ++it)
+	{
+		if (IsValid(*it))
+			return *it;
+	}
+
+	const ENetMode netMode = world->GetNetMode();
+	if (!bCreate || netMode == NM_Standalone || netMode == NM_Client)
+		return nullptr;
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	spawnParams.ObjectFlags |= RF_Transient;
+	return world->SpawnActor<ATransformerEditState>(spawnParams);
+}
+
+bool ATransformerEditState::NeedsTransformOverride(const USceneComponent* Component)
+{
+	if (!Component) return false;
+	AActor* owner = Component->GetOwner();
+	if (!owner) return false;
+
+	//Replicated Movement takes care of the Root of a Replicated Actor
+	if (Component == owner->GetRootComponent())
+		return !(owner->GetIsReplicated() && owner->IsReplicatingMovement());
+
+	//Replicated Components replicate their relative transform
+	return !(owner->GetIsReplicated() && Component->GetIsReplicated());
+}
+
+void ATransformerEditState::RecordTransform(USceneComponent* Component)
+{
+	if (!NeedsTransformOverride(Component)) return;
+
+	const FTransform& transform = Component->GetComponentTransform();
+	if (int32* index = TransformOverrideIndices.Find(Component))
+	{
+		FTransformerTransformOverride& item = TransformOverrides.Items[*index];
+		if (item.Transform.Equals(transform))
+			return;
+		item.Transform = transform;
+		TransformOverrides.MarkItemDirty(item);
+		return;
+	}
+
+	FTransformerTransformOverride& item = TransformOverrides.Items.AddDefaulted_GetRef();
+	item.Component = Component;
+	item.Transform = transform;
+	TransformOverrides.MarkItemDirty(item);
+	TransformOverrideIndices.Add(Component, TransformOverrides.Items.Num() - 1);
+}
+
+void ATransformerEditState::RecordDestroyed(UObject* Object)
+{
+	if (!Object) return;
+
+	//the override of a destroyed object is of no use anymore
+	TArray<USceneComponent*> components;
+	if (AActor* actor = Cast<AActor>(Object))
+		actor->GetComponents(components);
+	else if (USceneComponent* component = Cast<USceneComponent>(Object))
+		components.Add(component);
+
+	for (USceneComponent* component : components)
+	{
+		int32 index;
+		if (!TransformOverrideIndices.RemoveAndCopyValue(component, index))
+			continue;
+		TransformOverrides.Items.RemoveAtSwap(index);
+		if (TransformOverrides.Items.IsValidIndex(index))
+			TransformOverrideIndices.Add(TransformOverrides.Items[index].Component, index);
+		TransformOverrides.MarkArrayDirty();
+	}
+
+	//Destroying a Replicated Actor (or Replicated Component) already replicates
+	bool bReplicatesDestruction = false;
+	if (AActor* actor = Cast<AActor>(Object))
+		bReplicatesDestruction = actor->GetIsReplicated();
+	else if (UActorComponent* component = Cast<UActorComponent>(Object))
+		bReplicatesDestruction = component->GetIsReplicated() && component->GetOwner() && component->GetOwner()->GetIsReplicated();
+
+	if (bReplicatesDestruction) return;
+
+	FTransformerDestroyedObject& item = DestroyedObjects.Items.AddDefaulted_GetRef();
+	item.Path = UWorld::RemovePIEPrefix(Object->GetPathName());
+	DestroyedObjects.MarkItemDirty(item);
+}
+
+void ATransformerEditState::RecordSelection(ATransformerPawn* Pawn, const TArray<USceneComponent*>& Components)
+{
+	if (!Pawn) return;
+
+	//index of each of the Pawn's items
+	TMap<USceneComponent*, int32> itemIndices;
+	for (int32 i = 0; i < Selections.Items.Num(); ++i)
+	{
+		if (Selections.Items[i].Pawn == Pawn)
+			itemIndices.Add(Selections.Items[i].Component, i);
+	}
+
+	TSet<USceneComponent*> selected;
+	selected.Reserve(Components.Num());
+	int32 lastOrder = INDEX_NONE;
+	for (USceneComponent* component : Components)
+	{
+		if (!component || selected.Contains(component)) continue;
+		selected.Add(component);
+
+		//items already in order are left as they are: only what's added (or moved back) is sent
+		if (int32* index = itemIndices.Find(component))
+		{
+			FTransformerPawnSelection& item = Selections.Items[*index];
+			if (item.Order <= lastOrder)
+			{
+				item.Order = Selections.NextOrder++;
+				Selections.MarkItemDirty(item);
+			}
+			lastOrder = item.Order;
+			continue;
+		}
+
+		FTransformerPawnSelection& item = Selections.Items.AddDefaulted_GetRef();
+		item.Pawn = Pawn;
+		item.Component = component;
+		item.Order = Selections.NextOrder++;
+		Selections.MarkItemDirty(item);
+		lastOrder = item.Order;
+	}
+
+	const int32 removed = Selections.Items.RemoveAllSwap([Pawn, &selected](const FTransformerPawnSelection& item)
+		{
+			return item.Pawn == Pawn && !selected.Contains(item.Component);
+		});
+
+	if (removed > 0)
+		Selections.MarkArrayDirty();
+}
+
+void ATransformerEditState::RemoveSelection(ATransformerPawn* Pawn)
+{
+	const int32 removed = Selections.Items.RemoveAll([Pawn](const FTransformerPawnSelection& item)
+		{
+			return item.Pawn == Pawn || !item.Pawn;
+		});
+
+	if (removed > 0)
+		Selections.MarkArrayDirty();
+}
+
+void ATransformerEditState::ApplyTransformOverride(const FTransformerTransformOverride& Override)
+{
+	USceneComponent* component = Override.Component;
+	if (!component) return;
+
+	//it was moved in the Server, so it is (or was forced to be) Movable there
+	if (component->Mobility != EComponentMobility::Movable)
+		component->SetMobility(EComponentMobility::Movable);
+
+	component->SetWorldTransform(Override.Transform);
+}
+
+void ATransformerEditState::ApplyDestroyed(const FTransformerDestroyedObject& Destroyed)
+{
+	FSoftObjectPath path(Destroyed.Path);
+#if WITH_EDITOR
+	path.FixupForPIE();
+#endif
+	UObject* object = path.ResolveObject();
+
+	if (AActor* actor = Cast<AActor>(object))
+		actor->Destroy();
+	else if (UActorComponent* component = Cast<UActorComponent>(object))
+	{
+		if (UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(component))
+			registry->Unregister(Cast<USceneComponent>(component));
+		component->DestroyComponent(true);
+	}
+}
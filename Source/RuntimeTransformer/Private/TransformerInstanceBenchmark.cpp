@@ -0,0 +1,106 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+/*
+ * Compares Static Mesh Actor copies against the instances that Clone As Instances / BakeSelectedToInstances make:
+ *
+ *	RuntimeTransformer.InstanceBenchmark [Count=10000] [MeshPath=/Engine/BasicShapes/Cube.Cube] [ISM]
+ *
+ * Spawns Count copies of the Mesh as Static Mesh Actors, bakes them into instances (HISM, or ISM if given)
+ * and logs the time, memory and primitive count (each primitive is at least one draw call per mesh section) of both.
+ * Everything spawned is destroyed at the end.
+ */
+
+#include "TransformerInstancedMeshes.h"
+#include "RuntimeTransformer.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+//Size of the object plus what it allocates (e.g. instance buffers)
+static SIZE_T GetObjectMemory(UObject* Object)
+{
+	return Object->GetClass()->GetStructureSize() + Object->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+}
+
+static SIZE_T GetActorMemory(AActor* Actor)
+{
+	SIZE_T size = GetObjectMemory(Actor);
+	for (UActorComponent* component : Actor->GetComponents())
+	{
+		if (component) size += GetObjectMemory(component);
+	}
+	return size;
+}
+
+static void RunInstanceBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World) return;
+
+	const int32 count = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+	const FString meshPath = Args.Num() > 1 ? Args[1] : TEXT("/Engine/BasicShapes/Cube.Cube");
+	const bool bHierarchical = !(Args.Num() > 2 && Args[2].Equals(TEXT("ISM"), ESearchCase::IgnoreCase));
+
+	UStaticMesh* mesh = LoadObject<UStaticMesh>(nullptr, *meshPath);
+	if (!mesh)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("InstanceBenchmark: could not load Mesh %s"), *meshPath);
+		return;
+	}
+
+	const int32 side = FMath::CeilToInt(FMath::Sqrt((float)count));
+	const float spacing = mesh->GetBounds().BoxExtent.GetMax() * 3.f;
+
+	//Copies as Actors
+	double startTime = FPlatformTime::Seconds();
+	TArray<AActor*> actors;
+	actors.Reserve(count);
+	for (int32 i = 0; i < count; ++i)
+	{
+		const FVector location((i % side) * spacing, (i / side) * spacing, 0.f);
+		AStaticMeshActor* actor = World->SpawnActor<AStaticMeshActor>(location, FRotator::ZeroRotator);
+		if (!actor) continue;
+		actor->SetMobility(EComponentMobility::Movable);
+		actor->GetStaticMeshComponent()->SetStaticMesh(mesh);
+		actors.Add(actor);
+	}
+	const double actorMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+
+	SIZE_T actorMemory = 0;
+	for (auto& actor : actors)
+		actorMemory += GetActorMemory(actor);
+
+	//Same copies as instances. A separate Instanced Meshes Actor, so that the World's one is not touched
+	FActorSpawnParameters spawnParams;
+	spawnParams.ObjectFlags |= RF_Transient;
+	ATransformerInstancedMeshes* instancedMeshes = World->SpawnActor<ATransformerInstancedMeshes>(spawnParams);
+	if (!instancedMeshes)
+	{
+		for (auto& actor : actors) actor->Destroy();
+		return;
+	}
+
+	startTime = FPlatformTime::Seconds();
+	const int32 instanceCount = instancedMeshes->InstanceActors(actors, bHierarchical);
+	const double instanceMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+	const SIZE_T instanceMemory = GetActorMemory(instancedMeshes);
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("InstanceBenchmark: %d copies of %s")
+		, count, *mesh->GetName());
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("  Actors:    %6d primitives, %8.2f ms to spawn, %8.2f MB")
+		, actors.Num(), actorMs, actorMemory / (1024.0 * 1024.0));
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("  %s: %6d primitives, %8.2f ms to bake,  %8.2f MB (%d instances)")
+		, bHierarchical ? TEXT("HISM") : TEXT(" ISM"), instancedMeshes->GetInstancerCount()
+		, instanceMs, instanceMemory / (1024.0 * 1024.0), instanceCount);
+
+	for (auto& actor : actors)
+		actor->Destroy();
+	instancedMeshes->Destroy();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs InstanceBenchmarkCommand(
+	TEXT("RuntimeTransformer.InstanceBenchmark"),
+	TEXT("Compares Static Mesh Actor copies against instances. Usage: RuntimeTransformer.InstanceBenchmark [Count=10000] [MeshPath=/Engine/BasicShapes/Cube.Cube] [ISM]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunInstanceBenchmark));
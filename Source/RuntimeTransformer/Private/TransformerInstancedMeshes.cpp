@@ -0,0 +1,130 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerInstancedMeshes.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+ATransformerInstancedMeshes::ATransformerInstancedMeshes()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+ATransformerInstancedMeshes* ATransformerInstancedMeshes::Get(const UObject* WorldContextObject, bool bCreate)
+{
+	UWorld* world = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	if (!world) return nullptr;
+
+	for (TActorIterator<ATransformerInstancedMeshes> it(world); it; ++it)
+	{
+		if (IsValid(*it))
+			return *it;
+	}
+
+	if (!bCreate) return nullptr;
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	spawnParams.ObjectFlags |= RF_Transient;
+	return world->SpawnActor<ATransformerInstancedMeshes>(spawnParams);
+}
+
+bool ATransformerInstancedMeshes::CanInstance(const AActor* Actor, UStaticMeshComponent*& OutMeshComponent)
+{
+	OutMeshComponent = nullptr;
+
+	//Only plain Static Mesh Actors: other classes could have logic or components an instance can't have
+	const AStaticMeshActor* meshActor = Cast<AStaticMeshActor>(Actor);
+	if (!meshActor) return false;
+
+	UStaticMeshComponent* meshComponent = meshActor->GetStaticMeshComponent();
+	if (!meshComponent || !meshComponent->GetStaticMesh()
+		|| meshComponent->IsA<UInstancedStaticMeshComponent>())
+		return false;
+
+	OutMeshComponent = meshComponent;
+	return true;
+}
+
+UInstancedStaticMeshComponent* ATransformerInstancedMeshes::AddInstances(const UStaticMeshComponent* Template
+	, const TArray<FTransform>& WorldTransforms, bool bHierarchical)
+{
+	UInstancedStaticMeshComponent* instancer = FindOrAddInstancer(Template, bHierarchical);
+	if (instancer && WorldTransforms.Num() > 0)
+		instancer->AddInstances(WorldTransforms, false, true);
+	return instancer;
+}
+
+int32 ATransformerInstancedMeshes::InstanceActors(const TArray<AActor*>& Actors, bool bHierarchical
+	, TArray<AActor*>* OutNotInstanced)
+{
+	TMap<UInstancedStaticMeshComponent*, TArray<FTransform>> instanceTransforms;
+	for (auto& actor : Actors)
+	{
+		UStaticMeshComponent* meshComponent;
+		UInstancedStaticMeshComponent* instancer = CanInstance(actor, meshComponent)
+			? FindOrAddInstancer(meshComponent, bHierarchical) : nullptr;
+
+		if (instancer)
+			instanceTransforms.FindOrAdd(instancer).Add(meshComponent->GetComponentTransform());
+		else if (OutNotInstanced)
+			OutNotInstanced->Add(actor);
+	}
+
+	int32 count = 0;
+	for (auto& it : instanceTransforms)
+	{
+		it.Key->AddInstances(it.Value, false, true);
+		count += it.Value.Num();
+	}
+	return count;
+}
+
+int32 ATransformerInstancedMeshes::GetInstanceCount() const
+{
+	int32 count = 0;
+	for (auto& instancer : Instancers)
+	{
+		if (instancer) count += instancer->GetInstanceCount();
+	}
+	return count;
+}
+
+UInstancedStaticMeshComponent* ATransformerInstancedMeshes::FindOrAddInstancer(const UStaticMeshComponent* Template
+	, bool bHierarchical)
+{
+	if (!Template || !Template->GetStaticMesh()) return nullptr;
+
+	const TArray<UMaterialInterface*> materials = Template->GetMaterials();
+	for (auto& instancer : Instancers)
+	{
+		if (instancer
+			&& instancer->GetStaticMesh() == Template->GetStaticMesh()
+			&& instancer->IsA<UHierarchicalInstancedStaticMeshComponent>() == bHierarchical
+			&& instancer->GetMaterials() == materials)
+			return instancer;
+	}
+
+	UInstancedStaticMeshComponent* instancer = bHierarchical
+		? NewObject<UHierarchicalInstancedStaticMeshComponent>(this)
+		: NewObject<UInstancedStaticMeshComponent>(this);
+
+	//Made at runtime, so there's no static lighting for it. Movable also allows for instance updates
+	instancer->SetMobility(EComponentMobility::Movable);
+	instancer->SetStaticMesh(Template->GetStaticMesh());
+	for (int32 i = 0; i < materials.Num(); ++i)
+		instancer->SetMaterial(i, materials[i]);
+
+	instancer->SetCollisionProfileName(Template->GetCollisionProfileName());
+	instancer->SetCastShadow(Template->CastShadow);
+	instancer->SetupAttachment(RootComponent);
+	AddInstanceComponent(instancer);
+	instancer->RegisterComponent();
+
+	Instancers.Add(instancer);
+	return instancer;
+}
@@ -0,0 +1,378 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerJournal.h"
+#include "TransformerLayout.h"
+#include "RuntimeTransformer.h"
+#include "Components/SceneComponent.h"
+#include "Containers/Queue.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+static TAutoConsoleVariable<float> CVarJournalFlushInterval(
+	TEXT("RuntimeTransformer.Journal.FlushInterval"),
+	0.5f,
+	TEXT("Seconds between journaling the latest transforms of the moved components, when nothing commits them before"));
+
+//"RTJN"
+static const uint32 JournalMagic = 0x4E4A5452;
+
+enum class EJournalVersion : uint32
+{
+	Initial = 1,
+	SoftDelete,
+
+	//add new versions above this line
+	VersionPlusOne,
+	Latest = VersionPlusOne - 1,
+};
+
+/**
+ * Writes the journal in its own thread: appends the records it's handed, and replaces the file when the journal is reset.
+ * Everything handed to it is written before it's destroyed.
+ */
+class FTransformerJournalWriter : public FRunnable
+{
+public:
+
+	FTransformerJournalWriter(const FString& InFilePath)
+		: FilePath(InFilePath)
+		, bStopping(false)
+		, bFailed(false)
+	{
+		WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+		Thread = FRunnableThread::Create(this, TEXT("TransformerJournalWriter"), 0, TPri_BelowNormal);
+	}
+
+	virtual ~FTransformerJournalWriter()
+	{
+		bStopping = true;
+		WorkEvent->Trigger();
+		if (Thread)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+		}
+		else
+			Process(); //no threads on this platform
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	}
+
+	void Append(TArray<uint8>&& Data)
+	{
+		FCommand command;
+		command.Data = MoveTemp(Data);
+		Commands.Enqueue(MoveTemp(command));
+		WorkEvent->Trigger();
+	}
+
+	//Replaces the file with a new one with the given Header. FileToDelete is deleted once it's replaced
+	void Restart(TArray<uint8>&& Header, const FString& FileToDelete)
+	{
+		FCommand command;
+		command.Data = MoveTemp(Header);
+		command.bRestart = true;
+		command.FileToDelete = FileToDelete;
+		Commands.Enqueue(MoveTemp(command));
+		WorkEvent->Trigger();
+	}
+
+	bool HasFailed() const { return bFailed; }
+
+	virtual uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			WorkEvent->Wait(100);
+			Process();
+		}
+		Process();
+		File.Reset();
+		return 0;
+	}
+
+private:
+
+	struct FCommand
+	{
+		TArray<uint8> Data;
+		bool bRestart = false;
+		FString FileToDelete;
+	};
+
+	void Process()
+	{
+		bool bWritten = false;
+		FCommand command;
+		while (Commands.Dequeue(command))
+		{
+			if (command.bRestart)
+			{
+				//written aside and moved over, so that there's always a whole journal in place
+				File.Reset();
+				const FString tempPath = FilePath + TEXT(".tmp");
+				if (FFileHelper::SaveArrayToFile(command.Data, *tempPath)
+					&& IFileManager::Get().Move(*FilePath, *tempPath, true, true))
+				{
+					if (!command.FileToDelete.IsEmpty())
+						IFileManager::Get().Delete(*command.FileToDelete);
+					File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath, true));
+				}
+
+				//not appended to the old journal either: its records are on another base
+				if (!File)
+				{
+					UE_LOG(LogRuntimeTransformer, Error, TEXT("Could not write Journal %s"), *FilePath);
+					bFailed = true;
+				}
+			}
+			else if (File)
+			{
+				File->Write(command.Data.GetData(), command.Data.Num());
+				bWritten = true;
+			}
+		}
+
+		if (bWritten)
+			File->Flush();
+	}
+
+	FString FilePath;
+	TUniquePtr<IFileHandle> File;
+
+	TQueue<FCommand, EQueueMode::Spsc> Commands;
+	FEvent* WorkEvent;
+	FRunnableThread* Thread;
+	std::atomic<bool> bStopping;
+	std::atomic<bool> bFailed;
+};
+
+FTransformerJournal::FTransformerJournal(const UTransformerLayout& InLayout, const FString& InFilePath
+	, bool bInRecordSelection, const FString& PreviousBase)
+	: Layout(InLayout)
+	, FilePath(InFilePath)
+	, BasePath(PreviousBase)
+	, bRecordSelection(bInRecordSelection)
+	, NextId(0)
+	, LastCommitTime(FPlatformTime::Seconds())
+{
+	Writer = MakeUnique<FTransformerJournalWriter>(FilePath);
+}
+
+FTransformerJournal::~FTransformerJournal()
+{
+	Commit();
+	if (Pending.Num() > 0)
+		Writer->Append(MoveTemp(Pending));
+	Writer.Reset();
+}
+
+void FTransformerJournal::Reset(const FString& InBasePath, TMap<FObjectKey, int32>&& BaseIds, int32 BaseCount)
+{
+	//whatever was journaled on the old base still goes to the old journal
+	if (Pending.Num() > 0)
+		Writer->Append(MoveTemp(Pending));
+	Pending.Reset();
+	Dirty.Reset();
+
+	Ids = MoveTemp(BaseIds);
+	NextId = BaseCount;
+
+	TArray<uint8> header;
+	const uint32 magic = JournalMagic;
+	const uint32 version = (uint32)EJournalVersion::Latest;
+	FTCHARToUTF8 baseName(*FPaths::GetCleanFilename(InBasePath));
+	const uint16 baseNameLength = (uint16)baseName.Length();
+	header.Append((const uint8*)&magic, sizeof(magic));
+	header.Append((const uint8*)&version, sizeof(version));
+	header.Append((const uint8*)&baseNameLength, sizeof(baseNameLength));
+	header.Append((const uint8*)baseName.Get(), baseNameLength);
+
+	Writer->Restart(MoveTemp(header), BasePath);
+	BasePath = InBasePath;
+}
+
+bool FTransformerJournal::ReadHeader(const TArray<uint8>& Data, const FString& JournalPath
+	, FString& OutBasePath, int64& OutRecordsOffset)
+{
+	const int64 fixedSize = sizeof(uint32) * 2 + sizeof(uint16);
+	if (Data.Num() < fixedSize) return false;
+
+	uint32 magic, version;
+	uint16 baseNameLength;
+	FMemory::Memcpy(&magic, Data.GetData(), sizeof(magic));
+	FMemory::Memcpy(&version, Data.GetData() + 4, sizeof(version));
+	FMemory::Memcpy(&baseNameLength, Data.GetData() + 8, sizeof(baseNameLength));
+	if (magic != JournalMagic || version == 0 || version > (uint32)EJournalVersion::Latest
+		|| Data.Num() < fixedSize + baseNameLength)
+		return false;
+
+	FUTF8ToTCHAR baseName((const char*)Data.GetData() + fixedSize, baseNameLength);
+	OutBasePath = FPaths::GetPath(JournalPath) / FString(baseName.Length(), baseName.Get());
+	OutRecordsOffset = fixedSize + baseNameLength;
+	return true;
+}
+
+int32 FTransformerJournal::GetId(UObject* Object)
+{
+	if (!Object) return INDEX_NONE;
+	if (const int32* id = Ids.Find(Object))
+		return *id;
+
+	//Clones have no name to go by: they're only known through their Clone record (or the base)
+	if (Layout.IsClone(Object)) return INDEX_NONE;
+
+	int32 outer = INDEX_NONE;
+	FString name;
+	UActorComponent* component = Cast<UActorComponent>(Object);
+	AActor* owner = component ? component->GetOwner() : nullptr;
+	if (owner && Layout.IsClone(owner))
+	{
+		outer = GetId(owner);
+		if (outer == INDEX_NONE) return INDEX_NONE;
+		name = Object->GetName();
+	}
+	else
+		name = UWorld::RemovePIEPrefix(Object->GetPathName());
+
+	const int32 id = NextId++;
+	Ids.Add(Object, id);
+
+	FTCHARToUTF8 utf8Name(*name);
+	const uint16 nameLength = (uint16)FMath::Min(utf8Name.Length(), (int32)MAX_uint16);
+	const ETransformerJournalOp op = ETransformerJournalOp::Define;
+	Write(&op, sizeof(op));
+	Write(&id, sizeof(id));
+	Write(&outer, sizeof(outer));
+	Write(&nameLength, sizeof(nameLength));
+	Write(utf8Name.Get(), nameLength);
+	return id;
+}
+
+void FTransformerJournal::WriteTransform(const FTransform& Transform)
+{
+	const FVector location = Transform.GetLocation();
+	const FQuat rotation = Transform.GetRotation();
+	const FVector scale = Transform.GetScale3D();
+	const double values[10] = { location.X, location.Y, location.Z
+		, rotation.X, rotation.Y, rotation.Z, rotation.W
+		, scale.X, scale.Y, scale.Z };
+	Write(values, sizeof(values));
+}
+
+void FTransformerJournal::MarkDirty(USceneComponent* Component)
+{
+	if (Component)
+		Dirty.Add(Component);
+}
+
+void FTransformerJournal::AppendClone(UObject* Clone, UObject* Template)
+{
+	Commit();
+
+	USceneComponent* component = Cast<USceneComponent>(Clone);
+	AActor* actor = Cast<AActor>(Clone);
+	USceneComponent* transformComponent = component ? component : (actor ? actor->GetRootComponent() : nullptr);
+	const int32 templateId = GetId(Template);
+	const int32 attachParentId = component ? GetId(component->GetAttachParent()) : INDEX_NONE;
+	if (!transformComponent || templateId == INDEX_NONE) return;
+
+	const int32 id = NextId++;
+	Ids.Add(Clone, id);
+
+	const ETransformerJournalOp op = ETransformerJournalOp::Clone;
+	Write(&op, sizeof(op));
+	Write(&id, sizeof(id));
+	Write(&templateId, sizeof(templateId));
+	Write(&attachParentId, sizeof(attachParentId));
+	WriteTransform(transformComponent->GetComponentTransform());
+}
+
+void FTransformerJournal::AppendDelete(UObject* Object)
+{
+	Commit();
+
+	const int32 id = GetId(Object);
+	if (id == INDEX_NONE) return;
+
+	const ETransformerJournalOp op = ETransformerJournalOp::Delete;
+	Write(&op, sizeof(op));
+	Write(&id, sizeof(id));
+}
+
+void FTransformerJournal::AppendSoftDelete(AActor* Actor, bool bRestored)
+{
+	Commit();
+
+	const int32 id = GetId(Actor);
+	if (id == INDEX_NONE) return;
+
+	const ETransformerJournalOp op = bRestored ? ETransformerJournalOp::Restore : ETransformerJournalOp::SoftDelete;
+	Write(&op, sizeof(op));
+	Write(&id, sizeof(id));
+}
+
+void FTransformerJournal::AppendSelection(const TArray<USceneComponent*>& Components)
+{
+	if (!bRecordSelection) return;
+	Commit();
+
+	TArray<int32> ids;
+	ids.Reserve(Components.Num());
+	for (USceneComponent* component : Components)
+	{
+		const int32 id = GetId(component);
+		if (id != INDEX_NONE)
+			ids.Add(id);
+	}
+
+	const ETransformerJournalOp op = ETransformerJournalOp::Selection;
+	const int32 count = ids.Num();
+	Write(&op, sizeof(op));
+	Write(&count, sizeof(count));
+	Write(ids.GetData(), ids.Num() * sizeof(int32));
+}
+
+bool FTransformerJournal::HasFailed() const
+{
+	return Writer->HasFailed();
+}
+
+void FTransformerJournal::Commit()
+{
+	LastCommitTime = FPlatformTime::Seconds();
+	if (Dirty.Num() == 0) return;
+
+	for (auto& componentPtr : Dirty)
+	{
+		USceneComponent* component = componentPtr.Get();
+		const int32 id = GetId(component);
+		if (id == INDEX_NONE) continue;
+
+		const ETransformerJournalOp op = ETransformerJournalOp::Transform;
+		Write(&op, sizeof(op));
+		Write(&id, sizeof(id));
+		WriteTransform(component->GetComponentTransform());
+	}
+	Dirty.Reset();
+}
+
+void FTransformerJournal::Tick()
+{
+	if (Dirty.Num() > 0 && FPlatformTime::Seconds() - LastCommitTime >= CVarJournalFlushInterval.GetValueOnGameThread())
+		Commit();
+
+	if (Pending.Num() > 0)
+	{
+		Writer->Append(MoveTemp(Pending));
+		Pending.Reset();
+	}
+}
@@ -0,0 +1,836 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerLayout.h"
+#include "TransformerActorPool.h"
+#include "TransformerJournal.h"
+#include "TransformerPawn.h"
+#include "TransformerSelectableRegistry.h"
+#include "TransformerVertexSnapping.h"
+#include "RuntimeTransformer.h"
+#include "Async/MappedFileHandle.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "UObject/SoftObjectPath.h"
+#include "UObject/UObjectGlobals.h"
+
+//"RTLY"
+static const uint32 LayoutMagic = 0x594C5452;
+
+enum class ELayoutVersion : uint32
+{
+	Initial = 1,
+
+	//add new versions above this line
+	VersionPlusOne,
+	Latest = VersionPlusOne - 1,
+};
+
+enum class ELayoutRecordFlags : uint32
+{
+	None = 0,
+	Actor = 1 << 0,		//the object is an Actor (its transform is the one of its Root)
+	Clone = 1 << 1,		//spawned as a clone of the Template record
+	Transform = 1 << 2,	//has been moved to Transform
+	Deleted = 1 << 3,	//destroyed (Clones are destroyed once the ones cloned from them are spawned)
+};
+ENUM_CLASS_FLAGS(ELayoutRecordFlags);
+
+struct FLayoutHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 RecordCount;
+	uint32 RecordSize;
+	uint64 NamesOffset;
+	uint64 NamesSize;
+};
+
+struct FLayoutRecord
+{
+	int32 Outer;		//record of the cloned Actor the object is in (Name relative to it). INDEX_NONE: Name is a full path
+	int32 Template;		//Clones: record of the object it was cloned from
+	int32 AttachParent;	//Component Clones: record of the component it's attached to
+	uint32 Flags;
+	uint32 NameOffset;	//UTF-8, in the names section
+	uint32 NameLength;
+	double Location[3];
+	double Rotation[4];
+	double Scale[3];
+};
+
+static_assert(sizeof(FLayoutHeader) % alignof(FLayoutRecord) == 0, "Records must be aligned in the snapshot");
+
+static void WriteTransform(FLayoutRecord& Record, const FTransform& Transform)
+{
+	const FVector location = Transform.GetLocation();
+	const FQuat rotation = Transform.GetRotation();
+	const FVector scale = Transform.GetScale3D();
+	Record.Location[0] = location.X; Record.Location[1] = location.Y; Record.Location[2] = location.Z;
+	Record.Rotation[0] = rotation.X; Record.Rotation[1] = rotation.Y; Record.Rotation[2] = rotation.Z; Record.Rotation[3] = rotation.W;
+	Record.Scale[0] = scale.X; Record.Scale[1] = scale.Y; Record.Scale[2] = scale.Z;
+}
+
+static FTransform ReadTransform(const FLayoutRecord& Record)
+{
+	return FTransform(
+		FQuat(Record.Rotation[0], Record.Rotation[1], Record.Rotation[2], Record.Rotation[3]),
+		FVector(Record.Location[0], Record.Location[1], Record.Location[2]),
+		FVector(Record.Scale[0], Record.Scale[1], Record.Scale[2]));
+}
+
+/**
+ * Builds the records of a snapshot. Records are made on demand (GetRecord),
+ * after the records they reference, so every record only references records before it
+ */
+struct FLayoutWriter
+{
+	const UTransformerLayout& Layout;
+	const UTransformerActorPool* ActorPool;
+
+	TArray<FLayoutRecord> Records;
+	TArray<uint8> Names;
+	TMap<const UObject*, int32> RecordIndices;
+
+	FLayoutWriter(const UTransformerLayout& InLayout)
+		: Layout(InLayout)
+		, ActorPool(UTransformerActorPool::Get(&InLayout))
+	{
+	}
+
+	bool IsClone(const UObject* Object) const
+	{
+		return Layout.CloneTemplates.Contains(Object);
+	}
+
+	//Whether the Actor (or the Actor of the Component) is soft deleted
+	bool IsParked(const UObject* Object) const
+	{
+		const AActor* actor = Cast<AActor>(Object);
+		if (const UActorComponent* component = Cast<UActorComponent>(Object))
+			actor = component->GetOwner();
+		return ActorPool && actor && ActorPool->IsParked(actor);
+	}
+
+	int32 AddRecord(int32 Outer, const FString& Name, ELayoutRecordFlags Flags)
+	{
+		FLayoutRecord& record = Records.AddZeroed_GetRef();
+		record.Outer = Outer;
+		record.Template = INDEX_NONE;
+		record.AttachParent = INDEX_NONE;
+		record.Flags = (uint32)Flags;
+
+		FTCHARToUTF8 name(*Name);
+		record.NameOffset = Names.Num();
+		record.NameLength = name.Length();
+		Names.Append((const uint8*)name.Get(), name.Length());
+		return Records.Num() - 1;
+	}
+
+	int32 GetRecord(UObject* Object)
+	{
+		if (!Object) return INDEX_NONE;
+		if (const int32* index = RecordIndices.Find(Object))
+			return *index;
+
+		int32 index = INDEX_NONE;
+		ELayoutRecordFlags flags = Object->IsA<AActor>() ? ELayoutRecordFlags::Actor : ELayoutRecordFlags::None;
+
+		if (const TWeakObjectPtr<UObject>* templateObject = Layout.CloneTemplates.Find(Object))
+		{
+			//a soft deleted Clone is only here if something was cloned from it
+			if (IsParked(Object))
+				flags |= ELayoutRecordFlags::Deleted;
+
+			USceneComponent* component = Cast<USceneComponent>(Object);
+			const int32 templateRecord = GetRecord(templateObject->Get());
+			const int32 attachParentRecord = component ? GetRecord(component->GetAttachParent()) : INDEX_NONE;
+			if (templateRecord == INDEX_NONE)
+				return INDEX_NONE;
+
+			index = AddRecord(INDEX_NONE, FString(), flags | ELayoutRecordFlags::Clone | ELayoutRecordFlags::Transform);
+			Records[index].Template = templateRecord;
+			Records[index].AttachParent = attachParentRecord;
+
+			const USceneComponent* transformComponent = component ? component : Cast<AActor>(Object)->GetRootComponent();
+			if (transformComponent)
+				WriteTransform(Records[index], transformComponent->GetComponentTransform());
+		}
+		else
+		{
+			AActor* owner = Cast<UActorComponent>(Object) ? Cast<UActorComponent>(Object)->GetOwner() : nullptr;
+			if (owner && IsClone(owner))
+			{
+				const int32 ownerRecord = GetRecord(owner);
+				if (ownerRecord == INDEX_NONE)
+					return INDEX_NONE;
+				index = AddRecord(ownerRecord, Object->GetName(), flags);
+			}
+			else
+				index = AddRecord(INDEX_NONE, UWorld::RemovePIEPrefix(Object->GetPathName()), flags);
+		}
+
+		RecordIndices.Add(Object, index);
+		return index;
+	}
+
+	void Write()
+	{
+		for (auto& clone : Layout.Clones)
+		{
+			if (clone.IsValid() && !IsParked(clone.Get()))
+				GetRecord(clone.Get());
+		}
+
+		for (auto& componentPtr : Layout.EditedComponents)
+		{
+			USceneComponent* component = componentPtr.Get();
+			if (!component || IsParked(component)) continue;
+
+			//an Actor is moved through its Root
+			AActor* owner = component->GetOwner();
+			UObject* object = (owner && component == owner->GetRootComponent()) ? (UObject*)owner : (UObject*)component;
+			const int32 index = GetRecord(object);
+			if (index == INDEX_NONE) continue;
+
+			FLayoutRecord& record = Records[index];
+			record.Flags |= (uint32)ELayoutRecordFlags::Transform;
+			WriteTransform(record, component->GetComponentTransform());
+		}
+
+		for (auto& deleted : Layout.DeletedObjects)
+		{
+			int32 outer = INDEX_NONE;
+			if (deleted.CloneOwner.IsValid())
+				outer = GetRecord(deleted.CloneOwner.Get());
+			else if (!deleted.CloneOwner.IsExplicitlyNull())
+				continue; //the Clone it was in is gone too
+
+			AddRecord(outer, deleted.Name, ELayoutRecordFlags::Deleted);
+		}
+
+		//soft deleted objects that were loaded with the level (soft deleted clones are simply left out)
+		if (ActorPool)
+		{
+			TArray<AActor*> parkedActors;
+			ActorPool->GetParkedActors(parkedActors);
+			for (AActor* actor : parkedActors)
+			{
+				if (IsClone(actor)) continue;
+				const int32 index = GetRecord(actor);
+				Records[index].Flags |= (uint32)ELayoutRecordFlags::Deleted;
+			}
+		}
+	}
+};
+
+UTransformerLayout* UTransformerLayout::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerLayout>() : nullptr;
+}
+
+UTransformerLayout::UTransformerLayout()
+{
+}
+
+//defined here, where FTransformerJournal is complete
+UTransformerLayout::~UTransformerLayout()
+{
+}
+
+bool UTransformerLayout::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerLayout::Deinitialize()
+{
+	StopJournal();
+	Super::Deinitialize();
+}
+
+void UTransformerLayout::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (!Journal) return;
+
+	if (Journal->HasFailed())
+	{
+		UE_LOG(LogRuntimeTransformer, Error, TEXT("Journal %s could not be written. Journaling stopped"), *Journal->GetFilePath());
+		StopJournal();
+		return;
+	}
+	Journal->Tick();
+}
+
+TStatId UTransformerLayout::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTransformerLayout, STATGROUP_Tickables);
+}
+
+bool UTransformerLayout::StartJournal(const FString& FilePath, bool bRecordSelection)
+{
+	StopJournal();
+
+	//the base of a journal left behind (e.g. one that was replayed) goes once the new journal replaces it
+	FString previousBase;
+	TArray<uint8> previousJournal;
+	int64 recordsOffset;
+	if (FFileHelper::LoadFileToArray(previousJournal, *FilePath, FILEREAD_Silent))
+		FTransformerJournal::ReadHeader(previousJournal, FilePath, previousBase, recordsOffset);
+
+	Journal = MakeUnique<FTransformerJournal>(*this, FilePath, bRecordSelection, previousBase);
+	if (!CompactJournal())
+	{
+		Journal.Reset();
+		return false;
+	}
+	return true;
+}
+
+void UTransformerLayout::StopJournal()
+{
+	//waits until everything is written
+	Journal.Reset();
+}
+
+bool UTransformerLayout::CompactJournal()
+{
+	if (!Journal) return false;
+
+	const FString basePath = FString::Printf(TEXT("%s.%lld.layout"), *Journal->GetFilePath(), FDateTime::UtcNow().GetTicks());
+	TMap<FObjectKey, int32> recordIndices;
+	int32 recordCount = 0;
+	if (!ExportLayoutFile(basePath, &recordIndices, &recordCount))
+		return false;
+
+	//the snapshot has it all: the journal starts over on it
+	Journal->Reset(basePath, MoveTemp(recordIndices), recordCount);
+	return true;
+}
+
+bool UTransformerLayout::ReplayJournal(const FString& FilePath, ATransformerPawn* SelectionPawn)
+{
+	if (Journal && Journal->GetFilePath() == FilePath)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Can't replay %s while it's being journaled"), *FilePath);
+		return false;
+	}
+
+	const double startTime = FPlatformTime::Seconds();
+
+	TArray<uint8> data;
+	FString basePath;
+	int64 offset = 0;
+	if (!FFileHelper::LoadFileToArray(data, *FilePath)
+		|| !FTransformerJournal::ReadHeader(data, FilePath, basePath, offset))
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Could not read Journal %s"), *FilePath);
+		return false;
+	}
+
+	//object of each Id
+	TArray<UObject*> objects;
+	if (!ImportLayoutFile(basePath, &objects))
+		return false;
+
+	auto getObject = [&objects](int32 Id) -> UObject*
+		{
+			return objects.IsValidIndex(Id) ? objects[Id] : nullptr;
+		};
+	auto setObject = [&objects](int32 Id, UObject* Object)
+		{
+			if (Id < 0) return;
+			if (Id >= objects.Num())
+				objects.SetNumZeroed(Id + 1);
+			objects[Id] = Object;
+		};
+
+	//reads the next value. False if the journal ends there (e.g. the last record was cut short by a crash)
+	auto read = [&data, &offset](void* Value, int64 Size)
+		{
+			if (offset + Size > data.Num()) return false;
+			FMemory::Memcpy(Value, data.GetData() + offset, Size);
+			offset += Size;
+			return true;
+		};
+	auto readTransform = [&read](FTransform& OutTransform)
+		{
+			double v[10];
+			if (!read(v, sizeof(v))) return false;
+			OutTransform = FTransform(FQuat(v[3], v[4], v[5], v[6]), FVector(v[0], v[1], v[2]), FVector(v[7], v[8], v[9]));
+			return true;
+		};
+
+	int32 replayed = 0;
+	bool bHasSelection = false;
+	TArray<USceneComponent*> selection;
+	bool bComplete = true;
+	while (offset < data.Num())
+	{
+		ETransformerJournalOp op;
+		int32 id;
+		if (!read(&op, sizeof(op)) || !read(&id, sizeof(id)))
+		{
+			bComplete = false;
+			break;
+		}
+
+		bool bRead = true;
+		switch (op)
+		{
+		case ETransformerJournalOp::Define:
+		{
+			int32 outer;
+			uint16 nameLength;
+			bRead = read(&outer, sizeof(outer)) && read(&nameLength, sizeof(nameLength)) && offset + nameLength <= data.Num();
+			if (!bRead) break;
+			FUTF8ToTCHAR name((const char*)data.GetData() + offset, nameLength);
+			offset += nameLength;
+			if (outer == INDEX_NONE || getObject(outer))
+				setObject(id, ResolveObject(getObject(outer), FString(name.Length(), name.Get())));
+			break;
+		}
+		case ETransformerJournalOp::Clone:
+		{
+			int32 templateId, attachParentId;
+			FTransform transform;
+			bRead = read(&templateId, sizeof(templateId)) && read(&attachParentId, sizeof(attachParentId)) && readTransform(transform);
+			if (bRead)
+				setObject(id, SpawnClone(getObject(templateId), Cast<USceneComponent>(getObject(attachParentId)), transform));
+			break;
+		}
+		case ETransformerJournalOp::Transform:
+		{
+			FTransform transform;
+			bRead = readTransform(transform);
+			UObject* object = getObject(id);
+			AActor* actor = Cast<AActor>(object);
+			USceneComponent* component = actor ? actor->GetRootComponent() : Cast<USceneComponent>(object);
+			if (bRead && component)
+			{
+				if (component->Mobility != EComponentMobility::Movable)
+					component->SetMobility(EComponentMobility::Movable);
+				component->SetWorldTransform(transform);
+				RecordTransform(component);
+			}
+			break;
+		}
+		case ETransformerJournalOp::Delete:
+		{
+			UObject* object = getObject(id);
+			if (IsValid(object))
+			{
+				RecordDestroyed(object);
+				if (AActor* actor = Cast<AActor>(object))
+					actor->Destroy();
+				else if (UActorComponent* component = Cast<UActorComponent>(object))
+					DestroyComponent(component);
+			}
+			break;
+		}
+		case ETransformerJournalOp::SoftDelete:
+		{
+			//parked again, so that a Restore further on can bring it back (the pool destroys it otherwise)
+			AActor* actor = Cast<AActor>(getObject(id));
+			if (!IsValid(actor)) break;
+			if (UTransformerActorPool* actorPool = UTransformerActorPool::Get(this))
+			{
+				actorPool->Park(actor);
+				RecordSoftDeleted(actor);
+			}
+			else
+			{
+				RecordDestroyed(actor);
+				actor->Destroy();
+			}
+			break;
+		}
+		case ETransformerJournalOp::Restore:
+		{
+			AActor* actor = Cast<AActor>(getObject(id));
+			UTransformerActorPool* actorPool = UTransformerActorPool::Get(this);
+			if (actorPool && IsValid(actor) && actorPool->Unpark(actor))
+				RecordSoftDeleted(actor, true);
+			break;
+		}
+		case ETransformerJournalOp::Selection:
+		{
+			//the Id read is the count of the selection
+			bHasSelection = true;
+			selection.Reset();
+			for (int32 i = 0; bRead && i < id; ++i)
+			{
+				int32 selectedId;
+				bRead = read(&selectedId, sizeof(selectedId));
+				if (USceneComponent* component = bRead ? Cast<USceneComponent>(getObject(selectedId)) : nullptr)
+					selection.Add(component);
+			}
+			break;
+		}
+		default:
+			bRead = false;
+			break;
+		}
+
+		if (!bRead)
+		{
+			bComplete = false;
+			break;
+		}
+		++replayed;
+	}
+
+	if (SelectionPawn && bHasSelection)
+		SelectionPawn->SelectMultipleComponents(selection, false);
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("Journal %s replayed: %d records in %.2f ms%s")
+		, *FilePath, replayed, (FPlatformTime::Seconds() - startTime) * 1000.0
+		, bComplete ? TEXT("") : TEXT(" (the rest of the journal is incomplete and was skipped)"));
+	return true;
+}
+
+void UTransformerLayout::RecordTransform(USceneComponent* Component)
+{
+	if (!Component) return;
+	EditedComponents.Add(Component);
+	if (Journal)
+		Journal->MarkDirty(Component);
+}
+
+void UTransformerLayout::RecordClone(UObject* Clone, UObject* Template)
+{
+	if (!Clone || !Template || CloneTemplates.Contains(Clone)) return;
+
+	//forget the Clones that are gone, every time the list doubles
+	if (Clones.Num() >= ClonesPruneSize)
+	{
+		Clones.RemoveAll([](const TWeakObjectPtr<UObject>& clone) { return !clone.IsValid(); });
+		for (auto it = CloneTemplates.CreateIterator(); it; ++it)
+		{
+			if (!it->Key.IsValid())
+				it.RemoveCurrent();
+		}
+		ClonesPruneSize = FMath::Max(1024, Clones.Num() * 2);
+	}
+
+	CloneTemplates.Add(Clone, Template);
+	Clones.Add(Clone);
+	if (Journal)
+		Journal->AppendClone(Clone, Template);
+}
+
+void UTransformerLayout::DestroyComponent(UActorComponent* Component)
+{
+	//its Actor is still around, so the Registry isn't told otherwise
+	if (UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this))
+		registry->Unregister(Cast<USceneComponent>(Component));
+	Component->DestroyComponent(true);
+}
+
+void UTransformerLayout::RecordDestroyed(UObject* Object)
+{
+	if (!Object) return;
+	if (Journal)
+		Journal->AppendDelete(Object);
+
+	//a destroyed Clone is simply not there anymore
+	if (CloneTemplates.Contains(Object)) return;
+
+	FDeletedObject deleted;
+	AActor* owner = Cast<UActorComponent>(Object) ? Cast<UActorComponent>(Object)->GetOwner() : nullptr;
+	if (owner && CloneTemplates.Contains(owner))
+	{
+		deleted.CloneOwner = owner;
+		deleted.Name = Object->GetName();
+	}
+	else
+		deleted.Name = UWorld::RemovePIEPrefix(Object->GetPathName());
+
+	DeletedObjects.Add(MoveTemp(deleted));
+}
+
+void UTransformerLayout::RecordSoftDeleted(AActor* Actor, bool bRestored)
+{
+	if (Actor && Journal)
+		Journal->AppendSoftDelete(Actor, bRestored);
+}
+
+void UTransformerLayout::RecordSelection(const TArray<USceneComponent*>& Components)
+{
+	if (Journal && Journal->IsRecordingSelection())
+		Journal->AppendSelection(Components);
+}
+
+void UTransformerLayout::CommitJournal()
+{
+	if (Journal)
+		Journal->Commit();
+}
+
+void UTransformerLayout::ResetLayout()
+{
+	EditedComponents.Reset();
+	CloneTemplates.Reset();
+	Clones.Reset();
+	DeletedObjects.Reset();
+}
+
+bool UTransformerLayout::ExportLayout(const FString& FilePath) const
+{
+	return ExportLayoutFile(FilePath, nullptr, nullptr);
+}
+
+bool UTransformerLayout::ExportLayoutFile(const FString& FilePath, TMap<FObjectKey, int32>* OutRecordIndices
+	, int32* OutRecordCount) const
+{
+	FLayoutWriter writer(*this);
+	writer.Write();
+
+	FLayoutHeader header;
+	header.Magic = LayoutMagic;
+	header.Version = (uint32)ELayoutVersion::Latest;
+	header.RecordCount = writer.Records.Num();
+	header.RecordSize = sizeof(FLayoutRecord);
+	header.NamesOffset = sizeof(FLayoutHeader) + (uint64)writer.Records.Num() * sizeof(FLayoutRecord);
+	header.NamesSize = writer.Names.Num();
+
+	TArray<uint8> data;
+	data.Reserve(header.NamesOffset + header.NamesSize);
+	data.Append((const uint8*)&header, sizeof(FLayoutHeader));
+	data.Append((const uint8*)writer.Records.GetData(), writer.Records.Num() * sizeof(FLayoutRecord));
+	data.Append(writer.Names);
+
+	if (!FFileHelper::SaveArrayToFile(data, *FilePath))
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Could not write Layout to %s"), *FilePath);
+		return false;
+	}
+
+	if (OutRecordCount)
+		*OutRecordCount = writer.Records.Num();
+	if (OutRecordIndices)
+	{
+		OutRecordIndices->Reset();
+		OutRecordIndices->Reserve(writer.RecordIndices.Num());
+		for (auto& it : writer.RecordIndices)
+			OutRecordIndices->Add(it.Key, it.Value);
+	}
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("Layout exported to %s: %d records, %d bytes")
+		, *FilePath, writer.Records.Num(), data.Num());
+	return true;
+}
+
+UObject* UTransformerLayout::ResolveObject(UObject* Outer, const FString& Name)
+{
+	if (Outer)
+		return StaticFindObjectFast(UObject::StaticClass(), Outer, FName(*Name));
+
+	FSoftObjectPath path(Name);
+#if WITH_EDITOR
+	path.FixupForPIE();
+#endif
+	return path.ResolveObject();
+}
+
+UObject* UTransformerLayout::SpawnClone(UObject* Template, USceneComponent* AttachParent, const FTransform& Transform)
+{
+	UWorld* world = GetWorld();
+	if (!world) return nullptr;
+
+	UObject* object = nullptr;
+	if (AActor* templateActor = Cast<AActor>(Template))
+	{
+		FActorSpawnParameters spawnParams;
+		spawnParams.Template = templateActor;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		templateActor->bNetStartup = false;
+		AActor* clone = world->SpawnActor(templateActor->GetClass(), &Transform, spawnParams);
+		if (clone)
+		{
+			clone->SetActorTransform(Transform);
+			if (UTransformerActorPool* actorPool = UTransformerActorPool::Get(this))
+				actorPool->RegisterClone(clone, templateActor);
+		}
+		object = clone;
+	}
+	else if (USceneComponent* templateComponent = Cast<USceneComponent>(Template))
+	{
+		AActor* owner = templateComponent->GetOwner();
+		USceneComponent* clone = owner ? Cast<USceneComponent>(StaticDuplicateObject(templateComponent, owner)) : nullptr;
+		if (clone)
+		{
+			clone->OnComponentCreated();
+			owner->AddInstanceComponent(clone);
+			clone->SetupAttachment(AttachParent ? AttachParent : templateComponent->GetAttachParent());
+			clone->SetWorldTransform(Transform);
+			clone->RegisterComponent();
+			if (UTransformerVertexSnapping* vertexSnapping = UTransformerVertexSnapping::Get(this))
+				vertexSnapping->AddComponent(clone);
+		}
+		object = clone;
+	}
+
+	if (object)
+		RecordClone(object, Template);
+	return object;
+}
+
+bool UTransformerLayout::ImportLayout(const FString& FilePath)
+{
+	return ImportLayoutFile(FilePath, nullptr);
+}
+
+bool UTransformerLayout::ImportLayoutFile(const FString& FilePath, TArray<UObject*>* OutObjects)
+{
+	if (!GetWorld()) return false;
+
+	const double startTime = FPlatformTime::Seconds();
+
+	//Mapped if the platform can, read into memory otherwise
+	TUniquePtr<IMappedFileHandle> mappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+	TUniquePtr<IMappedFileRegion> mappedRegion(mappedFile ? mappedFile->MapRegion(0, mappedFile->GetFileSize()) : nullptr);
+	TArray<uint8> fileData;
+
+	const uint8* data = nullptr;
+	int64 size = 0;
+	if (mappedRegion)
+	{
+		data = mappedRegion->GetMappedPtr();
+		size = mappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(fileData, *FilePath))
+	{
+		data = fileData.GetData();
+		size = fileData.Num();
+	}
+
+	if (!data || size < (int64)sizeof(FLayoutHeader))
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Could not read Layout from %s"), *FilePath);
+		return false;
+	}
+
+	const FLayoutHeader& header = *(const FLayoutHeader*)data;
+	if (header.Magic != LayoutMagic
+		|| header.Version == 0 || header.Version > (uint32)ELayoutVersion::Latest
+		|| header.RecordSize != sizeof(FLayoutRecord)
+		|| header.NamesOffset != sizeof(FLayoutHeader) + (uint64)header.RecordCount * sizeof(FLayoutRecord)
+		|| header.NamesOffset + header.NamesSize > (uint64)size)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("%s is not a valid Layout (or is of a newer version)"), *FilePath);
+		return false;
+	}
+
+	const FLayoutRecord* records = (const FLayoutRecord*)(data + sizeof(FLayoutHeader));
+	const char* names = (const char*)(data + header.NamesOffset);
+	const int32 recordCount = header.RecordCount;
+
+	//object of each record (nullptr if it couldn't be found or spawned)
+	TArray<UObject*> localObjects;
+	TArray<UObject*>& objects = OutObjects ? *OutObjects : localObjects;
+	objects.SetNumZeroed(recordCount);
+
+	//components to move, grouped by Actor
+	TMap<AActor*, TArray<TPair<USceneComponent*, int32>>> moves;
+	TArray<UObject*> deletes;
+
+	auto isValidReference = [recordCount](int32 Index, int32 Referencer)
+		{
+			return Index >= 0 && Index < Referencer && Index < recordCount;
+		};
+
+	for (int32 i = 0; i < recordCount; ++i)
+	{
+		const FLayoutRecord& record = records[i];
+		const ELayoutRecordFlags flags = (ELayoutRecordFlags)record.Flags;
+		UObject* object = nullptr;
+
+		if (EnumHasAnyFlags(flags, ELayoutRecordFlags::Clone))
+		{
+			object = SpawnClone(isValidReference(record.Template, i) ? objects[record.Template] : nullptr
+				, isValidReference(record.AttachParent, i) ? Cast<USceneComponent>(objects[record.AttachParent]) : nullptr
+				, ReadTransform(record));
+		}
+		else
+		{
+			FString name;
+			if ((uint64)record.NameOffset + record.NameLength <= header.NamesSize)
+			{
+				FUTF8ToTCHAR converted(names + record.NameOffset, record.NameLength);
+				name = FString(converted.Length(), converted.Get());
+			}
+
+			if (record.Outer == INDEX_NONE)
+				object = ResolveObject(nullptr, name);
+			else if (isValidReference(record.Outer, i))
+				object = ResolveObject(objects[record.Outer], name);
+
+			if (EnumHasAnyFlags(flags, ELayoutRecordFlags::Transform))
+			{
+				AActor* actor = Cast<AActor>(object);
+				USceneComponent* component = actor ? actor->GetRootComponent() : Cast<USceneComponent>(object);
+				if (component && component->GetOwner())
+				{
+					moves.FindOrAdd(component->GetOwner()).Emplace(component, i);
+					RecordTransform(component);
+				}
+			}
+		}
+
+		objects[i] = object;
+		if (object && EnumHasAnyFlags(flags, ELayoutRecordFlags::Deleted))
+			deletes.Add(object);
+	}
+
+	//one scoped movement update per Actor: its components (and their children) are only updated once
+	for (auto& move : moves)
+	{
+		TArray<TPair<USceneComponent*, int32>>& components = move.Value;
+
+		//parents before children
+		auto depth = [](const USceneComponent* Component)
+			{
+				int32 d = 0;
+				for (const USceneComponent* c = Component->GetAttachParent(); c; c = c->GetAttachParent())
+					++d;
+				return d;
+			};
+		if (components.Num() > 1)
+		{
+			components.StableSort([&depth](const TPair<USceneComponent*, int32>& a, const TPair<USceneComponent*, int32>& b)
+				{
+					return depth(a.Key) < depth(b.Key);
+				});
+		}
+
+		USceneComponent* root = move.Key->GetRootComponent();
+		FScopedMovementUpdate scopedUpdate(root, EScopedUpdate::DeferredUpdates);
+		for (auto& component : components)
+		{
+			//Moved when the snapshot was taken, so it is (or was forced to be) Movable
+			if (component.Key->Mobility != EComponentMobility::Movable)
+				component.Key->SetMobility(EComponentMobility::Movable);
+			component.Key->SetWorldTransform(ReadTransform(records[component.Value]));
+		}
+	}
+
+	for (UObject* object : deletes)
+	{
+		if (!IsValid(object)) continue;
+		RecordDestroyed(object);
+		if (AActor* actor = Cast<AActor>(object))
+			actor->Destroy();
+		else if (UActorComponent* component = Cast<UActorComponent>(object))
+			DestroyComponent(component);
+	}
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("Layout imported from %s: %d records in %.2f ms")
+		, *FilePath, recordCount, (FPlatformTime::Seconds() - startTime) * 1000.0);
+	return true;
+}
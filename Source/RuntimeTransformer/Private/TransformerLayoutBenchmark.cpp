@@ -0,0 +1,85 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+/*
+ * Times exporting / importing a Layout (UTransformerLayout) of many moved Actors:
+ *
+ *	RuntimeTransformer.LayoutBenchmark [Count=100000]
+ *
+ * Spawns Count Actors (Root only), records them as moved and exports the Layout.
+ * Then moves all of them away and imports the Layout back, logging the time of each step
+ * and how many Actors are back in place. Everything spawned (and the file) is deleted at the end.
+ */
+
+#include "TransformerLayout.h"
+#include "RuntimeTransformer.h"
+
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+static void RunLayoutBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	UTransformerLayout* layout = UTransformerLayout::Get(World);
+	if (!layout) return;
+
+	const int32 count = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000);
+	const FString filePath = FPaths::ProjectSavedDir() / TEXT("RuntimeTransformer") / TEXT("LayoutBenchmark.rtlayout");
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.ObjectFlags |= RF_Transient;
+
+	TArray<AActor*> actors;
+	TArray<FTransform> transforms;
+	actors.Reserve(count);
+	transforms.Reserve(count);
+	for (int32 i = 0; i < count; ++i)
+	{
+		AActor* actor = World->SpawnActor<AActor>(spawnParams);
+		if (!actor) continue;
+
+		USceneComponent* root = NewObject<USceneComponent>(actor, TEXT("BenchmarkRoot"));
+		root->SetMobility(EComponentMobility::Movable);
+		actor->SetRootComponent(root);
+		actor->AddInstanceComponent(root);
+		root->RegisterComponent();
+
+		const FTransform transform(FRotator(0.f, i % 360, 0.f), FVector(100.f * (i % 1000), 100.f * (i / 1000), 0.f));
+		root->SetWorldTransform(transform);
+		layout->RecordTransform(root);
+		actors.Add(actor);
+		transforms.Add(transform);
+	}
+
+	double startTime = FPlatformTime::Seconds();
+	const bool bExported = layout->ExportLayout(filePath);
+	const double exportMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+
+	for (AActor* actor : actors)
+		actor->SetActorTransform(FTransform::Identity);
+
+	startTime = FPlatformTime::Seconds();
+	const bool bImported = bExported && layout->ImportLayout(filePath);
+	const double importMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+
+	int32 inPlace = 0;
+	for (int32 i = 0; i < actors.Num(); ++i)
+	{
+		if (actors[i]->GetActorTransform().Equals(transforms[i], 0.01f))
+			++inPlace;
+	}
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("LayoutBenchmark: %d actors. Export %.2f ms, Import %.2f ms%s, %d back in place")
+		, actors.Num(), exportMs, importMs, bImported ? TEXT("") : TEXT(" (failed)"), inPlace);
+
+	for (AActor* actor : actors)
+		actor->Destroy();
+	layout->ResetLayout();
+	IFileManager::Get().Delete(*filePath);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LayoutBenchmarkCommand(
+	TEXT("RuntimeTransformer.LayoutBenchmark"),
+	TEXT("Times exporting / importing the Layout of many moved Actors. Usage: RuntimeTransformer.LayoutBenchmark [Count=100000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunLayoutBenchmark));
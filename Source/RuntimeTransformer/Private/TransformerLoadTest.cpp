@@ -0,0 +1,304 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+/*
+ * Scripted Select / Drag / Clone sessions used to load test the Replicated Runtime Transformer path.
+ * Meant to be run on headless (-nullrhi) clients and on the server, e.g. through Scripts/RunReplicationLoadTest.sh:
+ *
+ *	-ExecCmds="RuntimeTransformer.LoadTest.Start 60 Quit"
+ *
+ * Each process drives its locally controlled ATransformerPawns, samples the reliable buffers of the pawn channels
+ * and, when done, writes the FTransformerNetStats as JSON to [-RTStatsDir=]/LoadTest_<Role>_<Pid>.json
+ */
+
+#include "TransformerLoadTest.h"
+#include "TransformerPawn.h"
+#include "Gizmos/BaseGizmo.h"
+
+#include "Engine/ActorChannel.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Tickable.h"
+
+#if RUNTIMETRANSFORMER_NET_STATS
+
+class FTransformerLoadTest : public FTickableGameObject
+{
+public:
+
+	FTransformerLoadTest(float InDuration, bool bInQuitWhenDone)
+		: Duration(InDuration)
+		, ElapsedTime(0.f)
+		, bStarted(false)
+		, bFinished(false)
+		, bQuitWhenDone(bInQuitWhenDone)
+		, RandomStream(FPlatformProcess::GetCurrentProcessId())
+	{
+	}
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !bFinished; }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FTransformerLoadTest, STATGROUP_Tickables); }
+
+	void Finish();
+
+private:
+
+	enum class EPhase : uint8
+	{
+		Select,
+		Drag,
+		Clone,
+		Delete,
+		Wait,
+	};
+
+	struct FSession
+	{
+		EPhase			Phase = EPhase::Select;
+		EPhase			NextPhase = EPhase::Select;
+		float			PhaseTime = 0.f;
+		int32			Cycle = 0;
+		FTransform		AccumulatedDelta;
+		double			CloneRequestTime = 0.0;
+		TArray<TWeakObjectPtr<USceneComponent>> ComponentsBeforeClone;
+	};
+
+	static UWorld* FindGameWorld();
+
+	//Zero Delta Transform (including Scale), same as what the Pawn accumulates
+	static FTransform ZeroDeltaTransform() { FTransform t; t.SetScale3D(FVector::ZeroVector); return t; }
+
+	void TickSession(ATransformerPawn* Pawn, FSession& Session, float DeltaTime);
+	void SampleReliableBuffers(UWorld* World) const;
+	AActor* PickCandidate(UWorld* World);
+
+	float	Duration;
+	float	ElapsedTime;
+	bool	bStarted;
+	bool	bFinished;
+	bool	bQuitWhenDone;
+
+	FRandomStream RandomStream;
+
+	TMap<TWeakObjectPtr<ATransformerPawn>, FSession> Sessions;
+};
+
+static TUniquePtr<FTransformerLoadTest> ActiveLoadTest;
+
+UWorld* FTransformerLoadTest::FindGameWorld()
+{
+	if (!GEngine) return nullptr;
+	for (const FWorldContext& context : GEngine->GetWorldContexts())
+	{
+		if (context.WorldType == EWorldType::Game || context.WorldType == EWorldType::PIE)
+			return context.World();
+	}
+	return nullptr;
+}
+
+void FTransformerLoadTest::Tick(float DeltaTime)
+{
+	UWorld* world = FindGameWorld();
+	if (!world || !world->GetNetDriver()) return; //wait until we're in a networked session
+
+	if (!bStarted)
+	{
+		FTransformerNetStats::Get().Reset();
+		bStarted = true;
+	}
+
+	ElapsedTime += DeltaTime;
+
+	for (TActorIterator<ATransformerPawn> it(world); it; ++it)
+	{
+		if (it->IsLocallyControlled())
+			TickSession(*it, Sessions.FindOrAdd(*it), DeltaTime);
+	}
+
+	SampleReliableBuffers(world);
+
+	if (ElapsedTime >= Duration)
+		Finish();
+}
+
+void FTransformerLoadTest::TickSession(ATransformerPawn* Pawn, FSession& Session, float DeltaTime)
+{
+	Session.PhaseTime += DeltaTime;
+
+	switch (Session.Phase)
+	{
+	case EPhase::Select:
+	{
+		if (AActor* candidate = PickCandidate(Pawn->GetWorld()))
+		{
+			const FVector location = candidate->GetActorLocation();
+			Pawn->ReplicatedTraceByChannel(location + FVector(0.f, 0.f, 1000.f)
+				, location - FVector(0.f, 0.f, 1000.f), ECC_Visibility, false);
+		}
+		Session.Phase = EPhase::Wait;
+		Session.NextPhase = EPhase::Drag;
+		Session.PhaseTime = 0.f;
+		break;
+	}
+	case EPhase::Drag:
+	{
+		if (Pawn->GetSelectedComponents().Num() == 0)
+		{
+			Session.Phase = EPhase::Select;
+			break;
+		}
+
+		if (Session.PhaseTime <= DeltaTime)
+		{
+			Session.AccumulatedDelta = ZeroDeltaTransform();
+			Pawn->ServerSetDomain(ETransformationDomain::TD_XY_Plane);
+		}
+
+		FTransform delta = ZeroDeltaTransform();
+		delta.SetLocation(FVector(RandomStream.FRandRange(-5.f, 5.f), RandomStream.FRandRange(-5.f, 5.f), 0.f));
+		Pawn->ApplyDeltaTransform(delta);
+		Session.AccumulatedDelta.AddToTranslation(delta.GetLocation());
+
+		//one second drags
+		if (Session.PhaseTime >= 1.f)
+		{
+			Pawn->ServerClearDomain();
+			Pawn->ServerApplyTransform(Session.AccumulatedDelta);
+
+			++Session.Cycle;
+			Session.Phase = EPhase::Wait;
+			Session.NextPhase = (Session.Cycle % 3 == 0) ? EPhase::Clone : EPhase::Select;
+			Session.PhaseTime = 0.f;
+		}
+		break;
+	}
+	case EPhase::Clone:
+	{
+		Session.ComponentsBeforeClone.Reset();
+		for (USceneComponent* component : Pawn->GetSelectedComponents())
+			Session.ComponentsBeforeClone.Add(component);
+
+		Session.CloneRequestTime = FPlatformTime::Seconds();
+		Pawn->ServerCloneSelected(true, false);
+		Session.Phase = EPhase::Delete;
+		Session.PhaseTime = 0.f;
+		break;
+	}
+	case EPhase::Delete:
+	{
+		//wait for the clones to be selected (i.e. no component from before the clone remains selected)
+		TArray<USceneComponent*> selected = Pawn->GetSelectedComponents();
+		bool bConverged = selected.Num() > 0;
+		for (auto& component : Session.ComponentsBeforeClone)
+			bConverged &= !selected.Contains(component.Get());
+
+		if (bConverged || Session.PhaseTime > 5.f)
+		{
+			if (bConverged)
+				FTransformerNetStats::Get().RecordConvergence(FPlatformTime::Seconds() - Session.CloneRequestTime);
+
+			//Destroy the clones so that the level doesn't keep growing
+			Pawn->ServerDeselectAll(bConverged);
+			Session.Phase = EPhase::Wait;
+			Session.NextPhase = EPhase::Select;
+			Session.PhaseTime = 0.f;
+		}
+		break;
+	}
+	case EPhase::Wait:
+	{
+		if (Session.PhaseTime >= 0.25f)
+		{
+			Session.Phase = Session.NextPhase;
+			Session.PhaseTime = 0.f;
+		}
+		break;
+	}
+	}
+}
+
+void FTransformerLoadTest::SampleReliableBuffers(UWorld* World) const
+{
+	UNetDriver* netDriver = World->GetNetDriver();
+	if (!netDriver) return;
+
+	TArray<UNetConnection*> connections;
+	if (netDriver->ServerConnection)
+		connections.Add(netDriver->ServerConnection);
+	connections.Append(netDriver->ClientConnections);
+
+	for (TActorIterator<ATransformerPawn> it(World); it; ++it)
+	{
+		for (UNetConnection* connection : connections)
+		{
+			if (!connection) continue;
+			if (UActorChannel* channel = connection->FindActorChannelRef(TWeakObjectPtr<AActor>(*it)))
+				FTransformerNetStats::Get().SampleReliableBuffer(channel->NumOutRec);
+		}
+	}
+}
+
+AActor* FTransformerLoadTest::PickCandidate(UWorld* World)
+{
+	TArray<AActor*> candidates;
+	for (TActorIterator<AActor> it(World); it; ++it)
+	{
+		AActor* actor = *it;
+		if (!actor->GetIsReplicated() || actor->IsA<APawn>() || actor->IsA<ABaseGizmo>()) continue;
+		USceneComponent* root = actor->GetRootComponent();
+		if (root && root->Mobility == EComponentMobility::Movable)
+			candidates.Add(actor);
+	}
+	return candidates.Num() > 0 ? candidates[RandomStream.RandHelper(candidates.Num())] : nullptr;
+}
+
+void FTransformerLoadTest::Finish()
+{
+	bFinished = true;
+
+	FString statsDir = FPaths::ProjectSavedDir() / TEXT("RuntimeTransformer");
+	FParse::Value(FCommandLine::Get(), TEXT("RTStatsDir="), statsDir);
+
+	const FString role = IsRunningDedicatedServer() ? TEXT("DedicatedServer")
+		: (FindGameWorld() && FindGameWorld()->GetNetMode() == NM_ListenServer) ? TEXT("ListenServer") : TEXT("Client");
+
+	FTransformerNetStats::Get().DumpToFile(statsDir / FString::Printf(TEXT("LoadTest_%s_%u.json")
+		, *role, FPlatformProcess::GetCurrentProcessId()), role);
+
+	if (bQuitWhenDone)
+		FPlatformMisc::RequestExit(false);
+}
+
+static FAutoConsoleCommand LoadTestStartCommand(
+	TEXT("RuntimeTransformer.LoadTest.Start"),
+	TEXT("Starts scripted Select/Drag/Clone sessions on the local Transformer Pawns. Usage: RuntimeTransformer.LoadTest.Start [DurationSeconds=60] [Quit]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const float duration = (Args.Num() > 0) ? FCString::Atof(*Args[0]) : 60.f;
+		const bool bQuit = (Args.Num() > 1) && Args[1].Equals(TEXT("Quit"), ESearchCase::IgnoreCase);
+		ActiveLoadTest = MakeUnique<FTransformerLoadTest>(duration, bQuit);
+	}));
+
+static FAutoConsoleCommand LoadTestStopCommand(
+	TEXT("RuntimeTransformer.LoadTest.Stop"),
+	TEXT("Stops the running load test and writes its report"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (ActiveLoadTest.IsValid() && ActiveLoadTest->IsTickable())
+			ActiveLoadTest->Finish();
+	}));
+
+void ShutdownTransformerLoadTest()
+{
+	ActiveLoadTest.Reset();
+}
+
+#endif //RUNTIMETRANSFORMER_NET_STATS
@@ -0,0 +1,13 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TransformerNetStats.h"
+
+#if RUNTIMETRANSFORMER_NET_STATS
+
+//Destroys the load test in progress (if any) without writing its report, so it doesn't outlive the module
+void ShutdownTransformerLoadTest();
+
+#endif //RUNTIMETRANSFORMER_NET_STATS
@@ -0,0 +1,142 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerNetDormancy.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+UTransformerNetDormancy* UTransformerNetDormancy::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerNetDormancy>() : nullptr;
+}
+
+bool UTransformerNetDormancy::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerNetDormancy::Wake(AActor* Actor, const UObject* Editor)
+{
+	if (!Actor || !Editor) return;
+
+	if (FAwakeActor* awake = AwakeActors.Find(Actor))
+	{
+		//being edited (again): no timeout until this editor releases it
+		awake->Editors.Add(Editor, 0.0);
+		return;
+	}
+
+	FAwakeActor& awake = AwakeActors.Add(Actor);
+	awake.OriginalDormancy = Actor->NetDormancy;
+	awake.Editors.Add(Editor, 0.0);
+
+	//Flush so the current state goes out even if the actor was never replicated since it went Dormant.
+	// Dormancy and ForceNetUpdate don't depend on property comparisons, so this works with Push Model as well
+	Actor->FlushNetDormancy();
+	Actor->SetNetDormancy(DORM_Awake);
+	Actor->ForceNetUpdate();
+}
+
+void UTransformerNetDormancy::Release(AActor* Actor, const UObject* Editor, float Timeout)
+{
+	FAwakeActor* awake = Actor ? AwakeActors.Find(Actor) : nullptr;
+	double* releaseTime = awake ? awake->Editors.Find(Editor) : nullptr;
+	if (!releaseTime || *releaseTime != 0.0) return;
+
+	*releaseTime = FPlatformTime::Seconds() + Timeout;
+	if (NextExpireTime == 0.0 || *releaseTime < NextExpireTime)
+		NextExpireTime = *releaseTime;
+}
+
+void UTransformerNetDormancy::ReleaseAll(const UObject* Editor, float Timeout)
+{
+	const double releaseTime = FPlatformTime::Seconds() + Timeout;
+	bool bReleased = false;
+	for (auto& it : AwakeActors)
+	{
+		double* editorTime = it.Value.Editors.Find(Editor);
+		if (editorTime && *editorTime == 0.0)
+		{
+			*editorTime = releaseTime;
+			bReleased = true;
+		}
+	}
+
+	if (bReleased && (NextExpireTime == 0.0 || releaseTime < NextExpireTime))
+		NextExpireTime = releaseTime;
+}
+
+void UTransformerNetDormancy::RemoveEditor(const UObject* Editor)
+{
+	for (auto it = AwakeActors.CreateIterator(); it; ++it)
+	{
+		if (it->Value.Editors.Remove(Editor) == 0 || it->Value.Editors.Num() > 0) continue;
+
+		if (AActor* actor = it->Key.Get())
+			Restore(actor, it->Value);
+		it.RemoveCurrent();
+	}
+}
+
+void UTransformerNetDormancy::Restore(AActor* Actor, const FAwakeActor& Awake)
+{
+	//one last update with the final transform before going Dormant
+	Actor->ForceNetUpdate();
+	const ENetDormancy dormancy = Awake.OriginalDormancy == DORM_Initial ? DORM_DormantAll : Awake.OriginalDormancy.GetValue();
+	if (Actor->NetDormancy != dormancy)
+		Actor->SetNetDormancy(dormancy);
+}
+
+void UTransformerNetDormancy::ExpireEditors(double Now)
+{
+	NextExpireTime = 0.0;
+	for (auto it = AwakeActors.CreateIterator(); it; ++it)
+	{
+		AActor* actor = it->Key.Get();
+		if (!actor)
+		{
+			it.RemoveCurrent();
+			continue;
+		}
+
+		TMap<TWeakObjectPtr<const UObject>, double>& editors = it->Value.Editors;
+		for (auto editor = editors.CreateIterator(); editor; ++editor)
+		{
+			//editors that are gone (without RemoveEditor) don't keep it awake either
+			if (!editor->Key.IsValid() || (editor->Value > 0.0 && editor->Value <= Now))
+				editor.RemoveCurrent();
+			else if (editor->Value > 0.0 && (NextExpireTime == 0.0 || editor->Value < NextExpireTime))
+				NextExpireTime = editor->Value;
+		}
+
+		if (editors.Num() == 0)
+		{
+			Restore(actor, it->Value);
+			it.RemoveCurrent();
+		}
+	}
+}
+
+void UTransformerNetDormancy::Deinitialize()
+{
+	//the World is going away with all its Actors
+	AwakeActors.Reset();
+	Super::Deinitialize();
+}
+
+void UTransformerNetDormancy::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (NextExpireTime == 0.0) return;
+
+	const double now = FPlatformTime::Seconds();
+	if (now >= NextExpireTime)
+		ExpireEditors(now);
+}
+
+TStatId UTransformerNetDormancy::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTransformerNetDormancy, STATGROUP_Tickables);
+}
@@ -0,0 +1,183 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerNetStats.h"
+#include "RuntimeTransformer.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+FTransformerNetStats& FTransformerNetStats::Get()
+{
+	static FTransformerNetStats Instance;
+	return Instance;
+}
+
+FTransformerNetStats::FTransformerNetStats()
+{
+	Reset();
+}
+
+void FTransformerNetStats::RecordRpc(const FName& RpcName, int32 PayloadBytes)
+{
+	FRpcStats& stats = Rpcs.FindOrAdd(RpcName);
+	++stats.Calls;
+	stats.EstimatedBytes += PayloadBytes;
+}
+
+void FTransformerNetStats::RecordConvergence(double Seconds)
+{
+	++ConvergenceSamples;
+	ConvergenceTotal += Seconds;
+	ConvergenceMax = FMath::Max(ConvergenceMax, Seconds);
+}
+
+void FTransformerNetStats::RecordResync()
+{
+	++ResyncCount;
+}
+
+void FTransformerNetStats::RecordSelectionRollback()
+{
+	++SelectionRollbackCount;
+}
+
+void FTransformerNetStats::RecordDesyncGroups(int32 GroupCount)
+{
+	++DesyncCount;
+	DesyncGroupCount += GroupCount;
+}
+
+void FTransformerNetStats::RecordEditWait(double Seconds)
+{
+	++EditWaitSamples;
+	EditWaitTotal += Seconds;
+	EditWaitMax = FMath::Max(EditWaitMax, Seconds);
+}
+
+void FTransformerNetStats::SampleEditQueueDepth(int32 Depth)
+{
+	++EditQueueSamples;
+	EditQueueTotal += Depth;
+	EditQueuePeak = FMath::Max(EditQueuePeak, Depth);
+}
+
+void FTransformerNetStats::SampleReliableBuffer(int32 NumOutRec)
+{
+	++ReliableBufferSamples;
+	ReliableBufferTotal += NumOutRec;
+	ReliableBufferPeak = FMath::Max(ReliableBufferPeak, NumOutRec);
+}
+
+void FTransformerNetStats::Reset()
+{
+	Rpcs.Empty();
+	ResyncCount = 0;
+	SelectionRollbackCount = 0;
+	DesyncCount = 0;
+	DesyncGroupCount = 0;
+	ConvergenceSamples = 0;
+	ConvergenceTotal = 0.0;
+	ConvergenceMax = 0.0;
+	EditWaitSamples = 0;
+	EditWaitTotal = 0.0;
+	EditWaitMax = 0.0;
+	EditQueueSamples = 0;
+	EditQueueTotal = 0;
+	EditQueuePeak = 0;
+	ReliableBufferSamples = 0;
+	ReliableBufferTotal = 0;
+	ReliableBufferPeak = 0;
+	SessionStartTime = FPlatformTime::Seconds();
+}
+
+FString FTransformerNetStats::ToJson(const FString& Role) const
+{
+	const double sessionSeconds = FMath::Max(FPlatformTime::Seconds() - SessionStartTime, KINDA_SMALL_NUMBER);
+
+	FString out;
+	TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> writer
+		= TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&out);
+
+	writer->WriteObjectStart();
+	writer->WriteValue(TEXT("role"), Role);
+	writer->WriteValue(TEXT("sessionSeconds"), sessionSeconds);
+
+	writer->WriteObjectStart(TEXT("rpcs"));
+	for (auto& rpc : Rpcs)
+	{
+		writer->WriteObjectStart(rpc.Key.ToString());
+		writer->WriteValue(TEXT("calls"), rpc.Value.Calls);
+		writer->WriteValue(TEXT("estimatedBytes"), rpc.Value.EstimatedBytes);
+		writer->WriteValue(TEXT("estimatedBytesPerSecond"), rpc.Value.EstimatedBytes / sessionSeconds);
+		writer->WriteObjectEnd();
+	}
+	writer->WriteObjectEnd();
+
+	writer->WriteObjectStart(TEXT("reliableBuffer"));
+	writer->WriteValue(TEXT("samples"), ReliableBufferSamples);
+	writer->WriteValue(TEXT("average"), ReliableBufferSamples > 0
+		? double(ReliableBufferTotal) / ReliableBufferSamples : 0.0);
+	writer->WriteValue(TEXT("peak"), ReliableBufferPeak);
+	writer->WriteObjectEnd();
+
+	writer->WriteObjectStart(TEXT("editQueue"));
+	writer->WriteValue(TEXT("depthSamples"), EditQueueSamples);
+	writer->WriteValue(TEXT("averageDepth"), EditQueueSamples > 0
+		? double(EditQueueTotal) / EditQueueSamples : 0.0);
+	writer->WriteValue(TEXT("peakDepth"), EditQueuePeak);
+	writer->WriteValue(TEXT("commandsStarted"), EditWaitSamples);
+	writer->WriteValue(TEXT("averageWaitSeconds"), EditWaitSamples > 0
+		? EditWaitTotal / EditWaitSamples : 0.0);
+	writer->WriteValue(TEXT("maxWaitSeconds"), EditWaitMax);
+	writer->WriteObjectEnd();
+
+	writer->WriteObjectStart(TEXT("convergence"));
+	writer->WriteValue(TEXT("samples"), ConvergenceSamples);
+	writer->WriteValue(TEXT("averageSeconds"), ConvergenceSamples > 0
+		? ConvergenceTotal / ConvergenceSamples : 0.0);
+	writer->WriteValue(TEXT("maxSeconds"), ConvergenceMax);
+	writer->WriteObjectEnd();
+
+	writer->WriteValue(TEXT("resyncCount"), ResyncCount);
+	writer->WriteValue(TEXT("selectionRollbackCount"), SelectionRollbackCount);
+	writer->WriteValue(TEXT("desyncCount"), DesyncCount);
+	writer->WriteValue(TEXT("desyncGroupsResent"), DesyncGroupCount);
+	writer->WriteObjectEnd();
+	writer->Close();
+
+	return out;
+}
+
+bool FTransformerNetStats::DumpToFile(const FString& FilePath, const FString& Role) const
+{
+	if (FFileHelper::SaveStringToFile(ToJson(Role), *FilePath))
+	{
+		UE_LOG(LogRuntimeTransformer, Log, TEXT("Net Stats written to %s"), *FilePath);
+		return true;
+	}
+
+	UE_LOG(LogRuntimeTransformer, Warning, TEXT("Failed to write Net Stats to %s"), *FilePath);
+	return false;
+}
+
+static FAutoConsoleCommand NetStatsResetCommand(
+	TEXT("RuntimeTransformer.NetStats.Reset"),
+	TEXT("Resets the Runtime Transformer replication counters"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FTransformerNetStats::Get().Reset();
+	}));
+
+static FAutoConsoleCommand NetStatsDumpCommand(
+	TEXT("RuntimeTransformer.NetStats.Dump"),
+	TEXT("Writes the Runtime Transformer replication counters as JSON. Usage: RuntimeTransformer.NetStats.Dump [FilePath]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FString filePath = (Args.Num() > 0) ? Args[0]
+			: FPaths::ProjectSavedDir() / TEXT("RuntimeTransformer")
+				/ FString::Printf(TEXT("NetStats_%u.json"), FPlatformProcess::GetCurrentProcessId());
+		FTransformerNetStats::Get().DumpToFile(filePath, IsRunningDedicatedServer() ? TEXT("DedicatedServer") : TEXT("Game"));
+	}));
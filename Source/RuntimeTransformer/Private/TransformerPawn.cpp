@@ -3,10 +3,14 @@
 
 #include "TransformerPawn.h"
 #include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
 #include "Engine/World.h"
+#include "TimerManager.h"
 #include "GameFramework/PlayerController.h"
 
 #include "Net/UnrealNetwork.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PackageMapClient.h"
 #include "Kismet/GameplayStatics.h"
 
 /* Gizmos */
@@ -18,6 +22,21 @@
 /* Interface */
 #include "FocusableObject.h"
 
+#include "TransformerNetStats.h"
+#include "TransformerCloneIdComponent.h"
+#include "TransformerEditState.h"
+#include "TransformerEditScheduler.h"
+#include "TransformerInstancedMeshes.h"
+#include "TransformerClipboard.h"
+#include "TransformerActorPool.h"
+#include "TransformerLayout.h"
+#include "TransformerNetDormancy.h"
+#include "TransformerSelectableRegistry.h"
+#include "TransformerVertexSnapping.h"
+#include "LandscapeProxy.h"
+#include "EngineUtils.h"
+#include "Async/ParallelFor.h"
+
 // Sets default values
 ATransformerPawn::ATransformerPawn()
 {
@@ -32,12 +51,29 @@ ATransformerPawn::ATransformerPawn()
 	RotationGizmoClass		= ARotationGizmo::StaticClass();
 	ScaleGizmoClass			= AScaleGizmo::StaticClass();
 
-	CloneReplicationCheckFrequency = 0.05f;
-	MinimumCloneReplicationTime = 0.01f;
-
 	bResyncSelection = false;
+	bEditStateSelectionDirty = false;
+	ServerRequestTime = 0.0;
+	LatestSelectionRequestId = 0;
+	bServerAuthoritativeDrag = false;
+	DragStreamInterval = 1.f / 30.f;
+	DragCorrectionInterval = 0.1f;
+	DragCorrectionThreshold = 0.5f;
+	DragCorrectionBlendSpeed = 10.f;
+	DragInputSequence = 0;
+	LastDragStreamTime = 0.0;
+	LastDragCorrectionTime = 0.0;
+	bApplyingServerDragInput = false;
+	ResetDeltaTransform(ServerAppliedDragDelta);
 	bReplicates = false;
 	bIgnoreNonReplicatedObjects = false;
+	bManageNetDormancy = false;
+	NetDormancyTimeout = 2.f;
+	bScheduleServerEdits = false;
+	bDetectDesync = false;
+	DesyncCheckInterval = 2.f;
+	DesyncGroupSize = 16;
+	LastDesyncCheckTime = 0.0;
 
 	ResetDeltaTransform(AccumulatedDeltaTransform);
 	ResetDeltaTransform(NetworkDeltaTransform);
@@ -46,10 +82,33 @@ ATransformerPawn::ATransformerPawn()
 	SetSpaceType(CurrentSpaceType);
 
 	bTransformUFocusableObjects = true;
+	bShowRemoteSelectionIndicator = false;
+	RemoteSelectionStencilValue = 1;
 	bRotateOnLocalAxis = false;
 	bForceMobility = false;
 	bToggleSelectedInMultiSelection = true;
 	bComponentBased = false;
+	CloneBudgetMs = 4.f;
+	bCloneAsInstances = false;
+	bUseHierarchicalInstances = true;
+	bDuplicateDrag = false;
+	bDuplicateDragging = false;
+	DuplicateDragGhostMaterial = nullptr;
+	bSoftDelete = false;
+	bVertexSnapping = false;
+	bCollisionAwareDrag = false;
+	bCollisionDragCombinedShape = false;
+	CollisionDragChannel = ECC_WorldDynamic;
+	DragSweepDelta = FVector::ZeroVector;
+	bDragSweepRootsGathered = false;
+	VertexSnapScreenRadius = 16.f;
+	GroundTraceChannel = ECC_WorldStatic;
+	GroundTraceDistance = 100000.f;
+	bRecordUndoHistory = false;
+	UndoHistoryMaxEntries = 256;
+	UndoHistoryMaxMemoryKB = 4096;
+	bUndoSelectionDirty = false;
+	bApplyingUndo = false;
 }
 
 void ATransformerPawn::GetLifetimeReplicatedProps(
@@ -57,6 +116,22 @@ void ATransformerPawn::GetLifetimeReplicatedProps(
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 	//Fill here if we need to replicate Properties. For now, nothing needs constant replication/check
+	//(Persistent edits are replicated through ATransformerEditState)
+}
+
+void ATransformerPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//the clones made so far stay
+	CancelTimeSlicedClone(false);
+
+	if (HasAuthority())
+	{
+		if (ATransformerEditState* editState = ATransformerEditState::Get(this, false))
+			editState->RemoveSelection(this);
+		if (UTransformerNetDormancy* netDormancy = UTransformerNetDormancy::Get(this))
+			netDormancy->RemoveEditor(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 UObject* ATransformerPawn::GetUFocusable(USceneComponent* Component) const
@@ -72,6 +147,11 @@ UObject* ATransformerPawn::GetUFocusable(USceneComponent* Component) const
 void ATransformerPawn::SetTransform(USceneComponent* Component, const FTransform& Transform)
 {
 	if (!Component) return;
+	SelectionBounds.MarkMoved(Component);
+	WakeForEditing(Component);
+	RecordUndoTransform(Component);
+	if (UTransformerLayout* layout = GetEditLayout())
+		layout->RecordTransform(Component);
 	if (UObject* focusableObject = GetUFocusable(Component))
 	{
 		IFocusableObject::Execute_OnNewTransformation(focusableObject, this, Component, Transform, bComponentBased);
@@ -85,6 +165,8 @@ void ATransformerPawn::SetTransform(USceneComponent* Component, const FTransform
 
 void ATransformerPawn::Select(USceneComponent* Component, bool* bImplementsUFocusable)
 {
+	WakeForEditing(Component);
+	SetRemoteSelectionIndicator(Component, true);
 	UObject* focusableObject = GetUFocusable(Component);
 	if (focusableObject)
 		IFocusableObject::Execute_Focus(focusableObject, this, Component, bComponentBased);
@@ -94,11 +176,50 @@ void ATransformerPawn::Select(USceneComponent* Component, bool* bImplementsUFocu
 
 void ATransformerPawn::Deselect(USceneComponent* Component, bool* bImplementsUFocusable)
 {
+	SetRemoteSelectionIndicator(Component, false);
 	UObject* focusableObject = GetUFocusable(Component);
 	if (focusableObject)
 		IFocusableObject::Execute_Unfocus(focusableObject, this, Component, bComponentBased);
 	if (bImplementsUFocusable)
 		*bImplementsUFocusable = !!focusableObject;
+
+	//no longer edited by this pawn. Let it time out
+	if (bManageNetDormancy && Component && HasAuthority())
+	{
+		if (UTransformerNetDormancy* netDormancy = UTransformerNetDormancy::Get(this))
+			netDormancy->Release(Component->GetOwner(), this, NetDormancyTimeout);
+	}
+}
+
+void ATransformerPawn::WakeForEditing(USceneComponent* Component)
+{
+	if (!bManageNetDormancy || !Component) return;
+
+	AActor* owner = Component->GetOwner();
+	if (!owner || !owner->HasAuthority() || !owner->GetIsReplicated()) return;
+
+	//other Pawns may be editing it as well: the World keeps it awake until none is
+	if (UTransformerNetDormancy* netDormancy = UTransformerNetDormancy::Get(this))
+		netDormancy->Wake(owner, this);
+}
+
+void ATransformerPawn::ScheduleEditedActorsDormancy()
+{
+	if (!bManageNetDormancy || !HasAuthority()) return;
+
+	if (UTransformerNetDormancy* netDormancy = UTransformerNetDormancy::Get(this))
+		netDormancy->ReleaseAll(this, NetDormancyTimeout);
+}
+
+void ATransformerPawn::RecordCommittedTransforms()
+{
+	if (!HasAuthority() || GetNetMode() == NM_Standalone || SelectedComponents.Num() == 0) return;
+
+	if (ATransformerEditState* editState = ATransformerEditState::Get(this, true))
+	{
+		for (auto& c : SelectedComponents)
+			editState->RecordTransform(c);
+	}
 }
 
 void ATransformerPawn::FilterHits(TArray<FHitResult>& outHits)
@@ -150,9 +271,28 @@ ETransformationDomain ATransformerPawn::GetCurrentDomain(bool& TransformInProgre
 
 void ATransformerPawn::ClearDomain()
 {
+	//Clients clone through the Server (ReplicateFinishTransform), so the ghosts stay until then
+	if (bDuplicateDragging && GetNetMode() == NM_Standalone)
+		EndDuplicateDrag(true);
+
 	//Clear the Accumulated tranform when we stop Transforming
 	ResetDeltaTransform(AccumulatedDeltaTransform);
 	SetDomain(ETransformationDomain::TD_None);
+
+	//a sweep still in flight is dropped with the drag (it would only be resolved next frame)
+	ResetDragSweeps();
+
+	//The transform has been committed
+	CommitTransformEdit();
+}
+
+void ATransformerPawn::CommitTransformEdit()
+{
+	ScheduleEditedActorsDormancy();
+	RecordCommittedTransforms();
+	CloseUndoTransform();
+	if (UTransformerLayout* layout = GetEditLayout())
+		layout->CommitJournal();
 }
 
 bool ATransformerPawn::GetMouseStartEndPoints(float TraceDistance, FVector& outStartPoint, FVector& outEndPoint)
@@ -191,6 +331,7 @@ void ATransformerPawn::ResetDeltaTransform(FTransform& Transform)
 void ATransformerPawn::SetDomain(ETransformationDomain Domain)
 {
 	CurrentDomain = Domain;
+	DragPivot.Reset();
 
 	if (Gizmo.IsValid())
 		Gizmo->SetTransformProgressState(CurrentDomain != ETransformationDomain::TD_None
@@ -324,8 +465,46 @@ bool ATransformerPawn::TraceByProfile(const FVector& StartLocation
 void ATransformerPawn::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
+
+	//Corrections keep blending in even if the Gizmo is gone (e.g. Deselected right after the drag)
+	if (DragCorrections.Num() > 0)
+		BlendDragCorrections(DeltaSeconds);
+
+	if (bDetectDesync && GetLocalRole() < ROLE_Authority && IsLocallyControlled()
+		&& FPlatformTime::Seconds() - LastDesyncCheckTime >= DesyncCheckInterval)
+		SendSelectionChecksums();
+
+	//Selection changes of the frame are recorded at once
+	if (bEditStateSelectionDirty)
+	{
+		bEditStateSelectionDirty = false;
+		if (HasAuthority() && GetNetMode() != NM_Standalone)
+		{
+			if (ATransformerEditState* editState = ATransformerEditState::Get(this, true))
+				editState->RecordSelection(this, SelectedComponents);
+		}
+		if (UTransformerLayout* layout = GetEditLayout())
+			layout->RecordSelection(SelectedComponents);
+	}
+
+	if (TimeSlicedClone.IsValid())
+		UpdateTimeSlicedClone();
+
+	if (DropToGround.IsValid())
+		FinishDropToGround();
+
+	//Transforms made outside of a drag (e.g. a single Apply Transform) are one entry per frame
+	if (PendingUndoTransforms.Num() > 0 && CurrentDomain == ETransformationDomain::TD_None)
+		CloseUndoTransform();
+
+	if (bUndoSelectionDirty)
+		FlushUndoSelection();
+
 	if (!Gizmo.IsValid()) return;
 
+	if (IsPredictingDrag())
+		RestorePredictedDragTransforms();
+
 	if (APlayerController* PlayerController = Cast< APlayerController>(Controller))
 	{
 		FVector worldLocation, worldDirection;
@@ -340,11 +519,19 @@ void ATransformerPawn::Tick(float DeltaSeconds)
 					deltaTransform.GetRotation() * NetworkDeltaTransform.GetRotation(),
 					deltaTransform.GetLocation() + NetworkDeltaTransform.GetLocation(),
 					deltaTransform.GetScale3D() + NetworkDeltaTransform.GetScale3D());
+
+				if (IsPredictingDrag())
+					StreamDragInput();
 			}
 				
 		}			
 	}
 	
+	//a Gizmo on the Selection Center follows the Selection. Not while rotating / scaling around it though
+	if (IsGizmoOnSelectionCenter() && SelectionBounds.HasMoved() && !bDuplicateDragging
+		&& (CurrentDomain == ETransformationDomain::TD_None || CurrentTransformation == ETransformationType::TT_Translation))
+		UpdateGizmoPlacement();
+
 	//Only consider Local View
 	if (APlayerController* LocalPlayerController = UGameplayStatics::GetPlayerController(this, 0))
 	{
@@ -371,6 +558,17 @@ FTransform ATransformerPawn::UpdateTransform(const FVector& LookingVector
 	if (!Gizmo.IsValid() || CurrentDomain == ETransformationDomain::TD_None) 
 		return deltaTransform;
 
+	//Collision Aware Drag: what was swept last frame is applied first, so that this frame's move is swept from there
+	const bool bSweepDrag = bCollisionAwareDrag && CurrentTransformation == ETransformationType::TT_Translation;
+	FTransform sweptTransform;
+	sweptTransform.SetScale3D(FVector::ZeroVector);
+	if (bSweepDrag)
+	{
+		sweptTransform.SetLocation(ResolveDragSweeps());
+		if (!sweptTransform.GetLocation().IsZero())
+			ApplyDeltaTransform(sweptTransform);
+	}
+
 	FVector rayEnd = RayOrigin + 1'000'000'00 * RayDirection;
 
 	FTransform calcDeltaTransform = Gizmo->GetDeltaTransform(LookingVector, RayOrigin, rayEnd, CurrentDomain);
@@ -382,31 +580,206 @@ FTransform ATransformerPawn::UpdateTransform(const FVector& LookingVector
 	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
 	float* snappingValue = SnappingValues.Find(CurrentTransformation);
 
-	if (snappingEnabled && *snappingEnabled && snappingValue)
+	FTransform vertexSnappedTransform;
+	if (bVertexSnapping && CurrentTransformation == ETransformationType::TT_Translation
+		&& GetVertexSnappedTransform(RayOrigin, RayDirection, vertexSnappedTransform))
+	{
+		//a jump to the vertex: nothing left to accumulate for the grid
+		deltaTransform = vertexSnappedTransform;
+		ResetDeltaTransform(AccumulatedDeltaTransform);
+	}
+	else if (snappingEnabled && *snappingEnabled && snappingValue)
 			deltaTransform = Gizmo->GetSnappedTransform(AccumulatedDeltaTransform
 				, calcDeltaTransform, CurrentDomain, *snappingValue);
 				//GetSnapped Transform Modifies Accumulated Delta Transform by how much Snapping Occurred
+
+	if (bSweepDrag)
+	{
+		QueueDragSweeps(deltaTransform.GetLocation());
+		return sweptTransform;
+	}
 	
 	ApplyDeltaTransform(deltaTransform);
 	return deltaTransform;
 }
 
+void ATransformerPawn::SetCollisionAwareDrag(bool bEnabled, bool bCombinedShape)
+{
+	bCollisionAwareDrag = bEnabled;
+	bCollisionDragCombinedShape = bCombinedShape;
+	ResetDragSweeps();
+}
+
+void ATransformerPawn::ResetDragSweeps()
+{
+	DragSweepHandles.Reset();
+	DragSweepRoots.Reset();
+	bDragSweepRootsGathered = false;
+	DragSweepIgnoredActors.Reset();
+	DragSweepDelta = FVector::ZeroVector;
+}
+
+void ATransformerPawn::QueueDragSweeps(const FVector& Delta)
+{
+	DragSweepHandles.Reset();
+	DragSweepDelta = Delta;
+
+	UWorld* world = GetWorld();
+	if (!world || Delta.IsNearlyZero()) return;
+
+	const TArray<USceneComponent*>& components = bDuplicateDragging ? DuplicateDragGhosts : SelectedComponents;
+
+	if (!bDragSweepRootsGathered)
+	{
+		bDragSweepRootsGathered = true;
+		for (auto& c : components)
+		{
+			if (c) DragSweepIgnoredActors.Add(c->GetOwner());
+		}
+
+		//ghosts start inside the Selection they duplicate
+		if (bDuplicateDragging)
+		{
+			for (auto& c : SelectedComponents)
+			{
+				if (c) DragSweepIgnoredActors.Add(c->GetOwner());
+			}
+		}
+
+		//whatever is attached to a moved Component moves with it
+		TArray<USceneComponent*> roots;
+		GetRootComponents(components, roots);
+
+		FBox combinedBounds(ForceInit);
+		for (USceneComponent* c : roots)
+		{
+			if (!(bForceMobility || c->Mobility == EComponentMobility::Type::Movable)) continue;
+
+			const FBox bounds = FTransformerSelectionBounds::GetHierarchyBounds(c, true);
+			if (!bounds.IsValid) continue;
+
+			if (bCollisionDragCombinedShape)
+				combinedBounds += bounds;
+			else
+				DragSweepRoots.Add({ c, bounds.ShiftBy(-c->GetComponentLocation()) });
+		}
+
+		//a single root stands for all: they all move by the same Delta
+		if (combinedBounds.IsValid)
+			DragSweepRoots.Add({ roots[0], combinedBounds.ShiftBy(-roots[0]->GetComponentLocation()) });
+	}
+
+	//everything is reported as overlapping, what actually blocks the Channel is picked when resolved
+	// (so that the Selection can be skipped without giving each sweep a list of everything being moved)
+	static const FName sweepName(TEXT("TransformerDragSweep"));
+	const FCollisionQueryParams params(sweepName, false);
+	const FCollisionResponseParams responseParams(ECR_Overlap);
+
+	DragSweepHandles.Reserve(DragSweepRoots.Num());
+	for (const FDragSweepRoot& root : DragSweepRoots)
+	{
+		USceneComponent* rootComponent = root.Root.Get();
+		if (!rootComponent) continue;
+
+		const FBox bounds = root.Bounds.ShiftBy(rootComponent->GetComponentLocation());
+		const FVector start = bounds.GetCenter();
+		DragSweepHandles.Add(world->AsyncSweepByChannel(EAsyncTraceType::Multi, start, start + Delta, FQuat::Identity
+			, CollisionDragChannel, FCollisionShape::MakeBox(bounds.GetExtent()), params, responseParams));
+	}
+}
+
+void ATransformerPawn::GetRootComponents(const TArray<USceneComponent*>& Components, TArray<USceneComponent*>& outRoots)
+{
+	TSet<const USceneComponent*> components;
+	components.Reserve(Components.Num());
+	for (auto& c : Components)
+	{
+		if (c) components.Add(c);
+	}
+
+	for (auto& c : Components)
+	{
+		if (!c) continue;
+		bool bRoot = true;
+		for (USceneComponent* parent = c->GetAttachParent(); parent && bRoot; parent = parent->GetAttachParent())
+			bRoot = !components.Contains(parent);
+		if (bRoot)
+			outRoots.Add(c);
+	}
+}
+
+FVector ATransformerPawn::ResolveDragSweeps()
+{
+	const FVector delta = DragSweepDelta;
+	DragSweepDelta = FVector::ZeroVector;
+
+	//nothing to collide with
+	if (DragSweepHandles.Num() == 0) return delta;
+
+	UWorld* world = GetWorld();
+	double time = 1.0;
+	FTraceDatum traceDatum;
+	for (const FTraceHandle& handle : DragSweepHandles)
+	{
+		//results are lost if a frame was skipped: better not to move than to move through something
+		if (!world || !world->QueryTraceData(handle, traceDatum))
+		{
+			time = 0.0;
+			break;
+		}
+
+		for (const FHitResult& hit : traceDatum.OutHits)
+		{
+			if (hit.bStartPenetrating || hit.Time >= time) continue;
+			const UPrimitiveComponent* component = hit.GetComponent();
+			if (!component || DragSweepIgnoredActors.Contains(hit.GetActor())
+				|| component->GetCollisionResponseToChannel(CollisionDragChannel) != ECR_Block)
+				continue;
+			time = hit.Time;
+		}
+	}
+	DragSweepHandles.Reset();
+
+	if (time >= 1.0) return delta;
+
+	//stop just short of the hit, so that the next sweep doesn't start touching it
+	const double skinDistance = 0.1;
+	return delta * FMath::Max(0.0, time - skinDistance / delta.Size());
+}
+
 void ATransformerPawn::ApplyDeltaTransform(const FTransform& DeltaTransform)
 {
 	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
 	float* snappingValue = SnappingValues.Find(CurrentTransformation);
 
-	for (auto& sc : SelectedComponents)
+	//Pure math, so it works the same for Pawns that have no Gizmo (remote editors, Server)
+	const FVector pivot = GetTransformPivot();
+
+	//Per Component Snapping doesn't depend on the Gizmo's state, the Class Default Object does it for Pawns without Gizmo
+	const ABaseGizmo* snappingGizmo = Gizmo.IsValid() ? Gizmo.Get() : nullptr;
+	if (!snappingGizmo)
+	{
+		if (UClass* gizmoClass = GetGizmoClass(CurrentTransformation))
+			snappingGizmo = gizmoClass->GetDefaultObject<ABaseGizmo>();
+	}
+
+	//a Duplicate Drag moves the ghosts instead of the Selection
+	const TArray<USceneComponent*>& components = bDuplicateDragging ? DuplicateDragGhosts : SelectedComponents;
+
+	//a Server Authoritative Drag (the Server applying it, or the client predicting it) doesn't fight other authorities
+	const bool bSkipOwnAuthority = bApplyingServerDragInput || IsPredictingDrag();
+
+	for (auto& sc : components)
 	{
 		if (!sc) continue;
+		if (bSkipOwnAuthority && HasOwnMovementAuthority(sc)) continue;
 		if (bForceMobility || sc->Mobility == EComponentMobility::Type::Movable)
 		{
 			const FTransform& componentTransform = sc->GetComponentTransform();
 
 			FQuat deltaRotation = DeltaTransform.GetRotation();
 
-			FVector deltaLocation = componentTransform.GetLocation()
-				- Gizmo->GetActorLocation();
+			FVector deltaLocation = componentTransform.GetLocation() - pivot;
 
 			//DeltaScale is Unrotated Scale to Get Local Scale since World Scale is not supported
 			FVector deltaScale = componentTransform.GetRotation()
@@ -421,17 +794,20 @@ void ATransformerPawn::ApplyDeltaTransform(const FTransform& DeltaTransform)
 				//adding Gizmo Location + prevDeltaLocation 
 				// (i.e. location from Gizmo to Object after optional Rotating)
 				// + deltaTransform Location Offset
-				deltaLocation + Gizmo->GetActorLocation() + DeltaTransform.GetLocation(),
+				deltaLocation + pivot + DeltaTransform.GetLocation(),
 				deltaScale + componentTransform.GetScale3D());
 
 
 			/* SNAPPING LOGIC PER COMPONENT */
-			if (snappingEnabled && *snappingEnabled && snappingValue)
-				newTransform = Gizmo->GetSnappedTransformPerComponent(componentTransform
+			if (snappingEnabled && *snappingEnabled && snappingValue && snappingGizmo)
+				newTransform = snappingGizmo->GetSnappedTransformPerComponent(componentTransform
 					, newTransform, CurrentDomain, *snappingValue);
 
 			sc->SetMobility(EComponentMobility::Type::Movable);
-			SetTransform(sc, newTransform);
+			if (bDuplicateDragging)
+				sc->SetWorldTransform(newTransform); //ghosts are not edits
+			else
+				SetTransform(sc, newTransform);
 		}
 		else
 		{
@@ -460,6 +836,8 @@ bool ATransformerPawn::HandleTracedObjects(const TArray<FHitResult>& HitResults
 					SetDomain(Gizmo->GetTransformationDomain(componentHit));
 					if (CurrentDomain != ETransformationDomain::TD_None)
 					{
+						if (bDuplicateDrag)
+							BeginDuplicateDrag();
 						Gizmo->SetTransformProgressState(true, CurrentDomain);
 						return true; //finish only if the component actually has a domain, else continue
 					}
@@ -534,12 +912,43 @@ void ATransformerPawn::SetSnappingValue(ETransformationType TransformationType,
 	SnappingValues.Add(TransformationType, SnappingValue);
 }
 
+void ATransformerPawn::SetVertexSnapping(bool bEnabled, float ScreenRadius)
+{
+	bVertexSnapping = bEnabled;
+	VertexSnapScreenRadius = FMath::Max(ScreenRadius, 1.f);
+}
+
+bool ATransformerPawn::GetVertexSnappedTransform(const FVector& RayOrigin, const FVector& RayDirection
+	, FTransform& outDeltaTransform) const
+{
+	const ATranslationGizmo* translationGizmo = Cast<ATranslationGizmo>(Gizmo.Get());
+	APlayerController* playerController = Cast<APlayerController>(Controller);
+	if (!translationGizmo || !playerController || !playerController->PlayerCameraManager) return false;
+
+	int32 viewportWidth, viewportHeight;
+	playerController->GetViewportSize(viewportWidth, viewportHeight);
+	if (viewportWidth <= 0) return false;
+
+	//the FOV is horizontal
+	const float pixelTanAngle = 2.f * FMath::Tan(FMath::DegreesToRadians(playerController->PlayerCameraManager->GetFOVAngle()) * 0.5f)
+		/ viewportWidth;
+
+	//what is being moved is not snapped to
+	TSet<const AActor*> ignoredActors;
+	for (auto& c : bDuplicateDragging ? DuplicateDragGhosts : SelectedComponents)
+	{
+		if (c) ignoredActors.Add(c->GetOwner());
+	}
+
+	return translationGizmo->GetVertexSnappedTransform(RayOrigin, RayDirection, VertexSnapScreenRadius, pixelTanAngle
+		, CurrentDomain, ignoredActors, outDeltaTransform);
+}
+
 void ATransformerPawn::GetSelectedComponents(TArray<class USceneComponent*>& outComponentList
 	, USceneComponent*& outGizmoPlacedComponent) const
 {
 	outComponentList = SelectedComponents;
-	if (Gizmo.IsValid())
-		outGizmoPlacedComponent = Gizmo->GetParentComponent();
+	outGizmoPlacedComponent = GetGizmoPlacementComponent();
 }
 
 TArray<USceneComponent*> ATransformerPawn::GetSelectedComponents() const
@@ -562,671 +971,2984 @@ void ATransformerPawn::CloneSelected(bool bSelectNewClones
 		SelectMultipleComponents(CloneComponents, bAppendToList);
 }
 
-TArray<class USceneComponent*> ATransformerPawn::CloneFromList(const TArray<USceneComponent*>& ComponentList)
+bool ATransformerPawn::CloneSelectedTimeSliced(bool bSelectNewClones
+	, bool bAppendToList, ECloneSelectionUpdate SelectionUpdate)
 {
+	if (TimeSlicedClone.IsValid())
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("A Time Sliced Clone is already in progress"));
+		return false;
+	}
 
-	TArray<class USceneComponent*> outClones;
-	if (bComponentBased)
+	if (GetLocalRole() < ROLE_Authority)
 	{
-		TArray<USceneComponent*> Components;
-		
-		for (auto& i : ComponentList)
-		{
-			if (i) Components.Add(i);
-		}
-		outClones = CloneComponents(Components);
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Cloning in a Non-Authority! Please use the Clone RPCs instead"));
 	}
-	else
+
+	//What gets cloned is decided now, since the Selection changes while cloning (Incremental Selection)
+	TSharedPtr<FTimeSlicedClone> job = MakeShared<FTimeSlicedClone>();
+	job->bComponentBased = bComponentBased;
+	job->bCloneAsInstances = bCloneAsInstances && !bComponentBased;
+	job->bSelectNewClones = bSelectNewClones;
+	job->bAppendToList = bAppendToList;
+	job->SelectionUpdate = SelectionUpdate;
+	job->StartTime = FPlatformTime::Seconds();
+
+	TSet<AActor*> actorsProcessed;
+	for (auto& c : SelectedComponents)
 	{
-		TArray<AActor*> Actors;
-		for (auto& i : ComponentList)
+		if (!c || !c->GetOwner()) continue;
+		if (bComponentBased)
 		{
-			if (i)
-				Actors.Add(i->GetOwner());
+			job->TemplateComponents.Add(c);
+			continue;
 		}
-		outClones = CloneActors(Actors);
-	}
 
-	if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
-		Gizmo->SetTransformProgressState(true, CurrentDomain);
+		bool bAlreadyProcessed;
+		actorsProcessed.Add(c->GetOwner(), &bAlreadyProcessed);
+		if (!bAlreadyProcessed)
+			job->TemplateActors.Add(c->GetOwner());
+	}
 
-	return outClones;
+	TimeSlicedClone = job;
+	TimeSlicedCloneStats = FTransformerCloneStats();
+	return true;
 }
 
-TArray<class USceneComponent*> ATransformerPawn::CloneActors(const TArray<AActor*>& Actors)
+void ATransformerPawn::CancelTimeSlicedClone(bool bDestroyClones)
 {
-	TArray<class USceneComponent*> outClones;
+	if (!TimeSlicedClone.IsValid()) return;
 
-	UWorld* world = GetWorld();
-	if (!world) return outClones;
-	
-	TSet<AActor*>	actorsProcessed;
-	TArray<AActor*> actorsToSelect;
-	for (auto& templateActor : Actors)
+	if (bDestroyClones)
 	{
-		if (!templateActor) continue;
-		bool bAlreadyProcessed;
-		actorsProcessed.Add(templateActor, &bAlreadyProcessed);
-		if (bAlreadyProcessed) continue;
-
-		FTransform spawnTransform;
-		FActorSpawnParameters spawnParams;
+		UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this);
+		bool bDeselected = false;
+		for (auto& c : TimeSlicedClone->Clones)
+		{
+			USceneComponent* clone = c.Get();
+			if (!clone) continue;
 
-		spawnParams.Template = templateActor;
-		if (templateActor)
-			templateActor->bNetStartup = false;
+			if (SelectedComponents.Contains(clone))
+			{
+				DeselectComponent_Internal(SelectedComponents, clone);
+				bDeselected = true;
+			}
 
-		if (AActor* actor = world->SpawnActor(templateActor->GetClass()
-			, &spawnTransform, spawnParams))
-		{
-			outClones.Add(actor->GetRootComponent());
+			if (TimeSlicedClone->bComponentBased)
+			{
+				if (registry) registry->Unregister(clone);
+				clone->DestroyComponent(true);
+			}
+			else if (AActor* actor = clone->GetOwner())
+				actor->Destroy();
 		}
+		TimeSlicedClone->Clones.Empty();
+
+		if (bDeselected)
+			UpdateGizmoPlacement();
 	}
-	return outClones;
+
+	FinishTimeSlicedClone(true);
 }
 
-TArray<class USceneComponent*> ATransformerPawn::CloneComponents(const TArray<class USceneComponent*>& Components)
+bool ATransformerPawn::IsTimeSlicedCloneInProgress() const
 {
-	TArray<class USceneComponent*> outClones;
-
-	UWorld* world = GetWorld();
-	if (!world) return outClones;
+	return TimeSlicedClone.IsValid();
+}
 
-	TMap<USceneComponent*, USceneComponent*> OcCc; //Original component - Clone component
-	TMap<USceneComponent*, USceneComponent*> CcOp; //Clone component - Original parent
+TArray<USceneComponent*> ATransformerPawn::GetTimeSlicedClones() const
+{
+	TArray<USceneComponent*> clones;
+	if (!TimeSlicedClone.IsValid()) return clones;
 
-	//clone components phase
-	for (auto& templateComponent : Components)
+	clones.Reserve(TimeSlicedClone->Clones.Num());
+	for (auto& c : TimeSlicedClone->Clones)
 	{
-		if (!templateComponent) continue;
-		AActor* owner = templateComponent->GetOwner();
-		if (!owner) continue;
-
-		if (USceneComponent* clone = Cast<USceneComponent>(
-			StaticDuplicateObject(templateComponent, owner)))
-		{
-			PostCreateBlueprintComponent(clone);
-			clone->OnComponentCreated();
+		if (c.IsValid()) clones.Add(c.Get());
+	}
+	return clones;
+}
 
-			clone->RegisterComponent();
-			clone->SetRelativeTransform(templateComponent->GetRelativeTransform());
+void ATransformerPawn::UpdateTimeSlicedClone()
+{
+	TSharedPtr<FTimeSlicedClone> job = TimeSlicedClone;
 
-			outClones.Add(clone);
-			//Add to these two maps for reparenting in next phase
-			OcCc.Add(templateComponent, clone); //Original component - Clone component
+	const double startTime = FPlatformTime::Seconds();
+	const double deadline = startTime + FMath::Max(CloneBudgetMs, 0.f) / 1000.0;
 
-			if (templateComponent == owner->GetRootComponent())
-				CcOp.Add(clone, owner->GetRootComponent()); //this will cause a loop in the maps, so we must check for this!
-			else 
-				CcOp.Add(clone, templateComponent->GetAttachParent()); //Clone component - Original parent
+	TArray<USceneComponent*> frameClones;
+	int32 templateCount;
+	if (job->bComponentBased)
+	{
+		//Components are cloned all at once, as the reparenting needs every clone of the hierarchy
+		TArray<USceneComponent*> templates;
+		for (auto& c : job->TemplateComponents)
+		{
+			if (c.IsValid()) templates.Add(c.Get());
 		}
+		frameClones = CloneComponents(templates);
+		templateCount = job->NextTemplate = job->TemplateComponents.Num();
 	}
-
-	TArray<USceneComponent*> componentsToSelect;
-	//reparenting phase
-	FAttachmentTransformRules attachmentRule(EAttachmentRule::KeepWorld, false);
-	for (auto& cp : CcOp)
+	else
 	{
-		//original parent
-		USceneComponent* parent = cp.Value; 
-
-		AActor* actorOwner = cp.Value->GetOwner();
-
-		//find if we cloned the original parent
-		USceneComponent** cloneParent = OcCc.Find(parent); 
-
-		if (cloneParent)
+		//As many Actors as the budget allows (at least one). The rest are cloned in the next frames
+		TArray<AActor*> instanceTemplates;
+		templateCount = job->TemplateActors.Num();
+		while (job->NextTemplate < templateCount)
 		{
-			if (*cloneParent != cp.Key) //make sure comp is not its own parent
-				parent = *cloneParent;
+			AActor* templateActor = job->TemplateActors[job->NextTemplate++].Get();
+			UStaticMeshComponent* meshComponent;
+			if (job->bCloneAsInstances && ATransformerInstancedMeshes::CanInstance(templateActor, meshComponent))
+				instanceTemplates.Add(templateActor); //instanced in bulk below
+			else if (AActor* clone = CloneActor(templateActor))
+			{
+				if (clone->GetRootComponent())
+					frameClones.Add(clone->GetRootComponent());
+			}
+
+			if (FPlatformTime::Seconds() >= deadline)
+				break;
 		}
-		else 
+
+		if (instanceTemplates.Num() > 0)
 		{
-			//couldn't find its parent, so find the parent of the parent and see if it's in the list.
-			//repeat until found or root is reached
-			while (1)
+			//these all passed CanInstance, so the ones left could not get an Instancer: they're cloned as Actors instead
+			const TArray<AActor*> notInstanced = CloneActorsAsInstances(instanceTemplates);
+			TimeSlicedCloneStats.ClonesSpawned += instanceTemplates.Num() - notInstanced.Num();
+			if (notInstanced.Num() > 0)
 			{
-				//if parent is root, then no need to find parents above it. (none)
-				//attach to original parent, since there are no cloned parents.
-				if (parent == actorOwner->GetRootComponent())
-				{
-					parent = cp.Value;
-					break;
-				}
-				
-				//check if parents have been cloned
-				cloneParent = OcCc.Find(parent->GetAttachParent());
-				if (cloneParent)
-				{
-					//attach to cloned parent if found
-					parent = *cloneParent;
-					break;
-				}
-				parent = parent->GetAttachParent(); //move up in the hierarchy
+				UE_LOG(LogRuntimeTransformer, Warning, TEXT("%d Actors could not be cloned as Instances. Cloning them as Actors")
+					, notInstanced.Num());
+			}
+			for (auto& templateActor : notInstanced)
+			{
+				AActor* clone = CloneActor(templateActor);
+				if (clone && clone->GetRootComponent())
+					frameClones.Add(clone->GetRootComponent());
 			}
 		}
+	}
+
+	const double endTime = FPlatformTime::Seconds();
+	const double frameMs = (endTime - startTime) * 1000.0;
+	job->TotalFrameMs += frameMs;
+	++TimeSlicedCloneStats.Frames;
+	TimeSlicedCloneStats.ClonesSpawned += frameClones.Num();
+	TimeSlicedCloneStats.MaxFrameMs = FMath::Max(TimeSlicedCloneStats.MaxFrameMs, (float)frameMs);
+	TimeSlicedCloneStats.AverageFrameMs = job->TotalFrameMs / TimeSlicedCloneStats.Frames;
+	TimeSlicedCloneStats.TotalSeconds = endTime - job->StartTime;
 
-		cp.Key->AttachToComponent(parent, attachmentRule);
+	for (auto& clone : frameClones)
+		job->Clones.Add(clone);
 
-		//Selecting childs and parents can cause weird issues 
-		// so only select the topmost clones (those that do not have cloned parents!)
-		//only select those that have an "original parent". 
-		//if ((parent == cp.Value 
-		//	|| parent == actorOwner->GetRootComponent())) 
-		//	//check if the parent of the cloned is original (means it's topmost)
-		//	outParents.Add(cp.Key);
+	if (job->bSelectNewClones && job->SelectionUpdate == ECloneSelectionUpdate::CSU_Incremental
+		&& frameClones.Num() > 0)
+	{
+		SelectMultipleComponents(frameClones, job->bAppendToList);
+		//the clones of the next frames are added to the ones of this frame
+		job->bAppendToList = true;
+
+		if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
+			Gizmo->SetTransformProgressState(true, CurrentDomain);
 	}
 
-	return outClones;
+	if (TimeSlicedClone != job) return; //cancelled while selecting
+	OnCloneProgress.Broadcast(job->NextTemplate, templateCount);
+
+	if (TimeSlicedClone == job && job->NextTemplate >= templateCount)
+		FinishTimeSlicedClone(false);
 }
 
-void ATransformerPawn::SelectComponent(class USceneComponent* Component
-	, bool bAppendToList)
+void ATransformerPawn::FinishTimeSlicedClone(bool bCancelled)
 {
-	if (!Component) return;
+	TSharedPtr<FTimeSlicedClone> job = MoveTemp(TimeSlicedClone);
+	if (!job.IsValid()) return;
 
-	if (ShouldSelect(Component->GetOwner(), Component))
+	TArray<USceneComponent*> clones;
+	for (auto& c : job->Clones)
 	{
-		if (false == bAppendToList)
-			DeselectAll();
-		AddComponent_Internal(SelectedComponents, Component);
-		UpdateGizmoPlacement();
+		if (c.IsValid()) clones.Add(c.Get());
 	}
-}
-
-void ATransformerPawn::SelectActor(AActor* Actor
-	, bool bAppendToList)
-{
-	if (!Actor) return;
 
-	if (ShouldSelect(Actor, Actor->GetRootComponent()))
+	if (!bCancelled && job->bSelectNewClones && job->SelectionUpdate == ECloneSelectionUpdate::CSU_OnFinish)
 	{
-		if (false == bAppendToList)
-			DeselectAll();
-		AddComponent_Internal(SelectedComponents, Actor->GetRootComponent());
-		UpdateGizmoPlacement();
+		SelectMultipleComponents(clones, job->bAppendToList);
+
+		if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
+			Gizmo->SetTransformProgressState(true, CurrentDomain);
 	}
+
+	TimeSlicedCloneStats.TotalSeconds = FPlatformTime::Seconds() - job->StartTime;
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("Time Sliced Clone %s: %d clones in %d frames (%.2f ms max, %.2f ms average per frame. Budget: %.2f ms)")
+		, bCancelled ? TEXT("cancelled") : TEXT("finished")
+		, TimeSlicedCloneStats.ClonesSpawned, TimeSlicedCloneStats.Frames
+		, TimeSlicedCloneStats.MaxFrameMs, TimeSlicedCloneStats.AverageFrameMs, CloneBudgetMs);
+
+	OnCloneFinished.Broadcast(clones, bCancelled);
 }
 
-void ATransformerPawn::SelectMultipleComponents(const TArray<USceneComponent*>& Components
-	, bool bAppendToList)
+int32 ATransformerPawn::CopySelected()
 {
-	bool bValidList = false;
-
-	for (auto& c : Components)
+	TSet<AActor*> actorsProcessed;
+	TArray<AActor*> actors;
+	for (auto& c : SelectedComponents)
 	{
-		if (!c) continue;
-		if (!ShouldSelect(c->GetOwner(), c)) continue;
-
-		if (false == bAppendToList)
-		{
-			DeselectAll();
-			bAppendToList = true;
-			//only run once. This is not place outside in case a list is empty or contains only invalid components
-		}
-		bValidList = true;
-		AddComponent_Internal(SelectedComponents, c);
+		AActor* actor = c ? c->GetOwner() : nullptr;
+		if (!actor) continue;
+		bool bAlreadyProcessed;
+		actorsProcessed.Add(actor, &bAlreadyProcessed);
+		if (!bAlreadyProcessed)
+			actors.Add(actor);
 	}
 
-	if(bValidList) UpdateGizmoPlacement();
+	if (actors.Num() == 0) return 0;
+	return FTransformerClipboard::Get().Copy(actors, FTransform(GetTransformPivot()));
 }
 
-void ATransformerPawn::SelectMultipleActors(const TArray<AActor*>& Actors
-	, bool bAppendToList)
+TArray<class USceneComponent*> ATransformerPawn::Paste(const FTransform& Target
+	, bool bSelectNewClones, bool bAppendToList)
 {
-	bool bValidList = false;
-	for (auto& a : Actors)
-	{
-		if (!a) continue;
-		if (!ShouldSelect(a, a->GetRootComponent())) continue;
+	return PasteAtTransforms({ Target }, bSelectNewClones, bAppendToList);
+}
 
-		if (false == bAppendToList)
-		{
-			DeselectAll();
-			bAppendToList = true;
-			//only run once. This is not place outside in case a list is empty or contains only invalid components
-		}
+TArray<class USceneComponent*> ATransformerPawn::PasteAtTransforms(const TArray<FTransform>& Targets
+	, bool bSelectNewClones, bool bAppendToList)
+{
+	TArray<USceneComponent*> outClones;
 
-		bValidList = true;
-		AddComponent_Internal(SelectedComponents, a->GetRootComponent());
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Pasting in a Non-Authority! Pasted Actors only exist in this machine"));
 	}
-	if(bValidList) UpdateGizmoPlacement();
+
+	for (AActor* actor : FTransformerClipboard::Get().Paste(GetWorld(), Targets))
+	{
+		if (actor->GetRootComponent())
+			outClones.Add(actor->GetRootComponent());
+	}
+
+	if (bSelectNewClones)
+		SelectMultipleComponents(outClones, bAppendToList);
+
+	return outClones;
 }
 
-void ATransformerPawn::DeselectComponent(USceneComponent* Component)
+bool ATransformerPawn::ExportClipboard(const FString& FilePath)
 {
-	if (!Component) return;
-	DeselectComponent_Internal(SelectedComponents, Component);
-	UpdateGizmoPlacement();
+	return FTransformerClipboard::Get().ExportToFile(FilePath);
 }
 
-void ATransformerPawn::DeselectActor(AActor* Actor)
+bool ATransformerPawn::ImportClipboard(const FString& FilePath)
 {
-	if (Actor)
-		DeselectComponent(Actor->GetRootComponent());
+	return FTransformerClipboard::Get().ImportFromFile(FilePath);
 }
 
-TArray<USceneComponent*> ATransformerPawn::DeselectAll(bool bDestroyDeselected)
+void ATransformerPawn::SetDuplicateDrag(bool bDuplicate)
 {
-	TArray<USceneComponent*> componentsToDeselect = SelectedComponents;
-	for (auto& i : componentsToDeselect)
-		DeselectComponent(i);
-		//calling internal so as not to modify SelectedComponents until the last bit!
-	SelectedComponents.Empty();
-	UpdateGizmoPlacement();
+	bDuplicateDrag = bDuplicate;
+}
 
-	if (bDestroyDeselected)
+void ATransformerPawn::CancelDuplicateDrag()
+{
+	if (!bDuplicateDragging) return;
+
+	EndDuplicateDrag(false);
+	ResetDeltaTransform(AccumulatedDeltaTransform);
+	ResetDeltaTransform(NetworkDeltaTransform);
+	SetDomain(ETransformationDomain::TD_None);
+}
+
+void ATransformerPawn::BeginDuplicateDrag()
+{
+	if (bDuplicateDragging) return;
+
+	USceneComponent* placementComponent = GetGizmoPlacementComponent();
+	USceneComponent* placementGhost = nullptr;
+
+	for (auto& c : SelectedComponents)
 	{
-		for (auto& c : componentsToDeselect)
+		if (!c) continue;
+		if (USceneComponent* ghost = SpawnDragGhost(c))
 		{
-			if (!IsValid(c)) continue; //a component that was in the same actor destroyed will be pending kill
-			if (AActor* actor = c->GetOwner())
-			{
-				//We destroy the actor if no components are left to destroy, or the system is currently ActorBased
-				if (bComponentBased && actor->GetComponents().Num() > 1)
-					c->DestroyComponent(true);
-				else
-					actor->Destroy();
-			}
+			DuplicateDragTemplates.Add(c);
+			DuplicateDragGhosts.Add(ghost);
+			if (c == placementComponent)
+				placementGhost = ghost;
 		}
 	}
 
-	return componentsToDeselect;
+	bDuplicateDragging = DuplicateDragGhosts.Num() > 0;
+
+	//the Gizmo goes along with the ghosts
+	if (placementGhost && Gizmo.IsValid())
+		Gizmo->AttachToComponent(placementGhost, FAttachmentTransformRules::SnapToTargetIncludingScale);
+	else if (IsGizmoOnSelectionCenter() && bDuplicateDragging && Gizmo.IsValid())
+		Gizmo->AttachToComponent(DuplicateDragGhosts[0], FAttachmentTransformRules::KeepWorldTransform);
 }
 
-void ATransformerPawn::AddComponent_Internal(TArray<USceneComponent*>& OutComponentList
-	, USceneComponent* Component)
+USceneComponent* ATransformerPawn::SpawnDragGhost(USceneComponent* Template) const
 {
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+	UWorld* world = GetWorld();
+	if (!world || !Template) return nullptr;
 
-	int32 Index = OutComponentList.Find(Component);
+	TArray<UStaticMeshComponent*> meshes;
+	if (UStaticMeshComponent* mesh = Cast<UStaticMeshComponent>(Template))
+		meshes.Add(mesh);
 
-	if (INDEX_NONE == Index) //Component is not in list
+	TArray<USceneComponent*> children;
+	Template->GetChildrenComponents(true, children);
+	for (auto& child : children)
 	{
-		OutComponentList.Emplace(Component);
-		bool bImplementsInterface;
-		Select(OutComponentList.Last(), &bImplementsInterface);
-		OnComponentSelectionChange(Component, true, bImplementsInterface);
+		if (UStaticMeshComponent* mesh = Cast<UStaticMeshComponent>(child))
+			meshes.Add(mesh);
 	}
-	else if (bToggleSelectedInMultiSelection)
-		DeselectComponentAtIndex_Internal(OutComponentList, Index);
-}
 
-void ATransformerPawn::DeselectComponent_Internal(TArray<USceneComponent*>& OutComponentList
-	, USceneComponent* Component)
-{
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+	//even without meshes, the ghost keeps the transform the clone will get
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	spawnParams.ObjectFlags |= RF_Transient;
+	AActor* ghostActor = world->SpawnActor<AActor>(AActor::StaticClass(), Template->GetComponentTransform(), spawnParams);
+	if (!ghostActor) return nullptr;
+	ghostActor->SetReplicates(false);
+	ghostActor->SetActorEnableCollision(false);
+
+	USceneComponent* root = NewObject<USceneComponent>(ghostActor);
+	root->SetMobility(EComponentMobility::Movable);
+	ghostActor->SetRootComponent(root);
+	ghostActor->AddInstanceComponent(root);
+	root->SetWorldTransform(Template->GetComponentTransform());
+	root->RegisterComponent();
+
+	const FTransform& templateTransform = Template->GetComponentTransform();
+	for (auto& mesh : meshes)
+	{
+		if (!mesh->GetStaticMesh() || !mesh->IsVisible()) continue;
+
+		UStaticMeshComponent* ghostMesh = NewObject<UStaticMeshComponent>(ghostActor);
+		ghostMesh->SetMobility(EComponentMobility::Movable);
+		ghostMesh->SetStaticMesh(mesh->GetStaticMesh());
+		const int32 materialCount = mesh->GetNumMaterials();
+		for (int32 i = 0; i < materialCount; ++i)
+			ghostMesh->SetMaterial(i, DuplicateDragGhostMaterial ? DuplicateDragGhostMaterial : mesh->GetMaterial(i));
+
+		ghostMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		ghostMesh->SetGenerateOverlapEvents(false);
+		ghostMesh->SetCanEverAffectNavigation(false);
+		ghostMesh->SetCastShadow(mesh->CastShadow);
+		ghostMesh->SetupAttachment(root);
+		ghostMesh->SetRelativeTransform(mesh->GetComponentTransform().GetRelativeTransform(templateTransform));
+		ghostActor->AddInstanceComponent(ghostMesh);
+		ghostMesh->RegisterComponent();
+	}
 
-	int32 Index = OutComponentList.Find(Component);
-	if (INDEX_NONE != Index)
-		DeselectComponentAtIndex_Internal(OutComponentList, Index);
+	return root;
 }
 
-void ATransformerPawn::DeselectComponentAtIndex_Internal(
-	TArray<USceneComponent*>& OutComponentList
-	, int32 Index)
+void ATransformerPawn::EndDuplicateDrag(bool bMaterialize)
 {
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
-	if (OutComponentList.IsValidIndex(Index))
+	if (!bDuplicateDragging) return;
+	bDuplicateDragging = false;
+
+	TArray<USceneComponent*> templates;
+	TArray<FTransform> transforms;
+	for (int32 i = 0; i < DuplicateDragGhosts.Num(); ++i)
 	{
-		USceneComponent* Component = OutComponentList[Index];
-		bool bImplementsInterface;
-		Deselect(Component, &bImplementsInterface);
-		OutComponentList.RemoveAt(Index);
-		OnComponentSelectionChange(Component, false, bImplementsInterface);
+		USceneComponent* templateComponent = DuplicateDragTemplates[i].Get();
+		if (!templateComponent || !DuplicateDragGhosts[i]) continue;
+		templates.Add(templateComponent);
+		transforms.Add(DuplicateDragGhosts[i]->GetComponentTransform());
 	}
 
-}
-
-void ATransformerPawn::SetGizmo()
-{
+	for (auto& ghost : DuplicateDragGhosts)
+	{
+		if (ghost && ghost->GetOwner())
+			ghost->GetOwner()->Destroy();
+	}
+	DuplicateDragGhosts.Reset();
+	DuplicateDragTemplates.Reset();
 
-	//If there are selected components, then we see whether we need to create a new gizmo.
-	if (SelectedComponents.Num() > 0)
+	TArray<USceneComponent*> clones;
+	if (bMaterialize)
 	{
-		bool bCreateGizmo = true;
-		if (Gizmo.IsValid())
+		if (bComponentBased)
 		{
-			if (CurrentTransformation == Gizmo->GetGizmoType())
+			clones = CloneComponents(templates);
+			if (clones.Num() == templates.Num())
 			{
-				bCreateGizmo = false; // do not create gizmo if there is already a matching gizmo
+				//parents first, as moving a parent moves its (cloned) children
+				TArray<int32> order;
+				TArray<int32> depths;
+				for (int32 i = 0; i < clones.Num(); ++i)
+				{
+					int32 depth = 0;
+					for (USceneComponent* parent = clones[i]->GetAttachParent(); parent; parent = parent->GetAttachParent())
+						++depth;
+					order.Add(i);
+					depths.Add(depth);
+				}
+				order.Sort([&depths](int32 A, int32 B) { return depths[A] < depths[B]; });
+
+				for (int32 i : order)
+					clones[i]->SetWorldTransform(transforms[i]);
 			}
-			else
+		}
+		else
+		{
+			for (int32 i = 0; i < templates.Num(); ++i)
 			{
-				// Destroy the current gizmo as the transformation types do not match
-				Gizmo->Destroy();
-				Gizmo.Reset();
+				AActor* clone = CloneActor(templates[i]->GetOwner());
+				if (!clone || !clone->GetRootComponent()) continue;
+				clone->SetActorTransform(transforms[i]);
+				clones.Add(clone->GetRootComponent());
 			}
 		}
+	}
 
-		if (bCreateGizmo)
+	if (clones.Num() > 0)
+		SelectMultipleComponents(clones, false);
+	else
+		UpdateGizmoPlacement(); //the Gizmo goes back to the Selection
+}
+
+TArray<class USceneComponent*> ATransformerPawn::CloneFromList(const TArray<USceneComponent*>& ComponentList)
+{
+
+	TArray<class USceneComponent*> outClones;
+	if (bComponentBased)
+	{
+		TArray<USceneComponent*> Components;
+		
+		for (auto& i : ComponentList)
 		{
-			if (UWorld* world = GetWorld())
-			{
-				UClass* GizmoClass = GetGizmoClass(CurrentTransformation);
-				if (GizmoClass)
-				{
-					Gizmo = Cast<ABaseGizmo>(world->SpawnActor(GizmoClass));
-					Gizmo->OnGizmoStateChange.AddDynamic(this, &ATransformerPawn::OnGizmoStateChanged);
-				}
-			}
+			if (i) Components.Add(i);
 		}
+		outClones = CloneComponents(Components);
 	}
-	//Since there are no selected components, we must destroy any gizmos present
 	else
 	{
-		if (Gizmo.IsValid())
+		TArray<AActor*> Actors;
+		for (auto& i : ComponentList)
 		{
-			Gizmo->Destroy();
-			Gizmo.Reset();
+			if (i)
+				Actors.Add(i->GetOwner());
 		}
+		outClones = CloneActors(Actors);
 	}
 
+	if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
+		Gizmo->SetTransformProgressState(true, CurrentDomain);
 
+	return outClones;
 }
 
-void ATransformerPawn::UpdateGizmoPlacement()
+TArray<class USceneComponent*> ATransformerPawn::CloneActors(const TArray<AActor*>& Actors)
 {
-	SetGizmo();
-	//means that there are no active gizmos (no selections) so nothing to do in this func
-	if (!Gizmo.IsValid()) return;
+	TArray<class USceneComponent*> outClones;
+
+	UWorld* world = GetWorld();
+	if (!world) return outClones;
+	
+	TSet<AActor*>	actorsProcessed;
+	TArray<AActor*>	templateActors;
+	for (auto& templateActor : Actors)
+	{
+		if (!templateActor) continue;
+		bool bAlreadyProcessed;
+		actorsProcessed.Add(templateActor, &bAlreadyProcessed);
+		if (!bAlreadyProcessed)
+			templateActors.Add(templateActor);
+	}
 
-	USceneComponent* ComponentToAttachTo = nullptr;
+	//Instances can't be selected, so they're not part of the clones returned
+	if (bCloneAsInstances)
+		templateActors = CloneActorsAsInstances(templateActors);
 
-	switch (GizmoPlacement)
+	for (auto& templateActor : templateActors)
 	{
-	case EGizmoPlacement::GP_OnFirstSelection: 
-		ComponentToAttachTo = SelectedComponents[0]; break;
-	case EGizmoPlacement::GP_OnLastSelection:
-		ComponentToAttachTo = SelectedComponents.Last(); break;
+		if (AActor* actor = CloneActor(templateActor))
+			outClones.Add(actor->GetRootComponent());
 	}
+	return outClones;
+}
 
-	if (ComponentToAttachTo)
+TArray<AActor*> ATransformerPawn::CloneActorsAsInstances(const TArray<AActor*>& TemplateActors)
+{
+	ATransformerInstancedMeshes* instancedMeshes = ATransformerInstancedMeshes::Get(this, true);
+	if (!instancedMeshes) return TemplateActors;
+
+	TArray<AActor*> notInstanced;
+	instancedMeshes->InstanceActors(TemplateActors, bUseHierarchicalInstances, &notInstanced);
+	return notInstanced;
+}
+
+int32 ATransformerPawn::BakeSelectedToInstances()
+{
+	if (GetLocalRole() < ROLE_Authority)
 	{
-		Gizmo->AttachToComponent(ComponentToAttachTo
-		, FAttachmentTransformRules::SnapToTargetIncludingScale);
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Baking to Instances in a Non-Authority is not supported"));
+		return 0;
 	}
-	else
+	if (GetNetMode() != NM_Standalone)
 	{
-	//	Gizmo->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Baking to Instances in a networked game. Instances are not replicated!"));
 	}
 
-	Gizmo->UpdateGizmoSpace(CurrentSpaceType);
+	TSet<AActor*> actorsProcessed;
+	TArray<AActor*> actors;
+	for (auto& c : SelectedComponents)
+	{
+		AActor* actor = c ? c->GetOwner() : nullptr;
+		if (!actor) continue;
+		bool bAlreadyProcessed;
+		actorsProcessed.Add(actor, &bAlreadyProcessed);
+		if (!bAlreadyProcessed)
+			actors.Add(actor);
+	}
+
+	ATransformerInstancedMeshes* instancedMeshes = actors.Num() > 0 ? ATransformerInstancedMeshes::Get(this, true) : nullptr;
+	if (!instancedMeshes) return 0;
+
+	TArray<AActor*> notInstanced;
+	const int32 bakedCount = instancedMeshes->InstanceActors(actors, bUseHierarchicalInstances, &notInstanced);
+	if (bakedCount == 0) return 0;
+
+	for (auto& actor : notInstanced)
+		actorsProcessed.Remove(actor);
+
+	//actorsProcessed now has only the baked actors
+	for (int32 i = SelectedComponents.Num() - 1; i >= 0; --i)
+	{
+		USceneComponent* c = SelectedComponents[i];
+		if (c && actorsProcessed.Contains(c->GetOwner()))
+			DeselectComponentAtIndex_Internal(SelectedComponents, i);
+	}
+	UpdateGizmoPlacement();
+
+	for (auto& actor : actorsProcessed)
+		actor->Destroy();
+
+	return bakedCount;
 }
 
+AActor* ATransformerPawn::CloneActor(AActor* TemplateActor)
+{
+	UWorld* world = GetWorld();
+	if (!world || !TemplateActor) return nullptr;
+
+	FTransform spawnTransform;
+	FActorSpawnParameters spawnParams;
 
-///////////////////////// NETWORKING ////////////////////////////////////////////////////////////////////////
+	//a soft deleted Clone of the same Template is as good as a new one
+	UTransformerActorPool* actorPool = ShouldSoftDelete() ? UTransformerActorPool::Get(this) : nullptr;
+	if (actorPool)
+	{
+		if (AActor* reused = actorPool->ReuseClone(TemplateActor))
+		{
+			//moved to where the Template is when it was brought back
+			if (UTransformerLayout* layout = GetEditLayout())
+			{
+				layout->RecordSoftDeleted(reused, true);
+				layout->RecordTransform(reused->GetRootComponent());
+			}
+			return reused;
+		}
+	}
 
+	spawnParams.Template = TemplateActor;
+	TemplateActor->bNetStartup = false;
 
-void ATransformerPawn::ReplicatedMouseTraceByObjectTypes(float TraceDistance
-	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels, bool bAppendToList)
+	AActor* clone = world->SpawnActor(TemplateActor->GetClass(), &spawnTransform, spawnParams);
+	if (actorPool)
+		actorPool->RegisterClone(clone, TemplateActor);
+	if (UTransformerLayout* layout = GetEditLayout())
+		layout->RecordClone(clone, TemplateActor);
+	return clone;
+}
+
+TArray<class USceneComponent*> ATransformerPawn::CloneComponents(const TArray<class USceneComponent*>& Components
+	, const TArray<FName>* CloneNames)
 {
-	FVector start, end;
-	if (GetMouseStartEndPoints(TraceDistance, start, end))
+	TArray<class USceneComponent*> outClones;
+
+	UWorld* world = GetWorld();
+	if (!world) return outClones;
+
+	//Clones[i] is the clone of Components[i] (nullptr if it could not be cloned)
+	TArray<USceneComponent*> clones;
+	clones.SetNumZeroed(Components.Num());
+
+	TMap<USceneComponent*, int32> clonedIndices; //Original component - Index in Components / clones
+
+	//clone components phase. Clones are not registered (nor attached) yet
+	for (int32 i = 0; i < Components.Num(); ++i)
 	{
-		bool bTraceSuccessful = TraceByObjectTypes(start, end
-			, CollisionChannels
-			, TArray<AActor*>(), bAppendToList);
+		USceneComponent* templateComponent = Components[i];
+		if (!templateComponent) continue;
+		AActor* owner = templateComponent->GetOwner();
+		if (!owner) continue;
 
-		//Server
-		if (GetLocalRole() == ROLE_Authority)
-			ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
-		//Client
-		else
+		const bool bNamedClone = CloneNames && CloneNames->IsValidIndex(i);
+
+		if (USceneComponent* clone = Cast<USceneComponent>(
+			StaticDuplicateObject(templateComponent, owner
+				, bNamedClone ? (*CloneNames)[i] : NAME_None)))
 		{
-			if (!bTraceSuccessful && !bAppendToList)
-				ServerDeselectAll(false);
-			else
+			PostCreateBlueprintComponent(clone);
+			clone->OnComponentCreated();
+
+			//Named Clones exist on both ends of the network with the same name,
+			// so they're referenced by name rather than replicated
+			if (bNamedClone)
 			{
-				// If a Local Trace was on a Gizmo, just tell the Server that we 
-				// have hit our Gizmo and just change the Domain there.
-				// Else, do the Server Trace
-				if (CurrentDomain == ETransformationDomain::TD_None)
-					ServerTraceByObjectTypes(start, end, CollisionChannels, bAppendToList);
-				else
-					ServerSetDomain(CurrentDomain);
+				clone->SetIsReplicated(false);
+				clone->SetNetAddressable();
 			}
-			
+
+			clones[i] = clone;
+			clonedIndices.Add(templateComponent, i);
 		}
+	}
 
-		
+	//parenting phase. Each clone goes under the clone of its nearest cloned ancestor (or else its original parent).
+	//The nearest cloned ancestor of the non-cloned ancestors is cached, so every ancestor is walked once
+	TMap<USceneComponent*, int32> nearestClonedAncestors; //Non-cloned component - Index of its nearest cloned ancestor (INDEX_NONE if none)
+	TArray<USceneComponent*> walkedAncestors;
+	auto findClonedAncestor = [&](USceneComponent* TemplateComponent) -> int32
+		{
+			AActor* actorOwner = TemplateComponent->GetOwner();
+			USceneComponent* ancestor = TemplateComponent->GetAttachParent();
+			int32 clonedAncestor = INDEX_NONE;
+
+			walkedAncestors.Reset();
+			while (ancestor)
+			{
+				if (const int32* index = clonedIndices.Find(ancestor))
+				{
+					clonedAncestor = *index;
+					break;
+				}
+				if (const int32* cached = nearestClonedAncestors.Find(ancestor))
+				{
+					clonedAncestor = *cached;
+					break;
+				}
+				walkedAncestors.Add(ancestor);
+
+				//if parent is root, then no need to find parents above it. (none)
+				if (ancestor == actorOwner->GetRootComponent())
+					break;
+				ancestor = ancestor->GetAttachParent();
+			}
+
+			for (auto& walked : walkedAncestors)
+				nearestClonedAncestors.Add(walked, clonedAncestor);
+			return clonedAncestor;
+		};
+
+	TArray<int32> parentIndices; //Index of the clone each clone attaches to (INDEX_NONE: attaches to an original component)
+	parentIndices.Init(INDEX_NONE, Components.Num());
+	for (int32 i = 0; i < clones.Num(); ++i)
+	{
+		USceneComponent* clone = clones[i];
+		if (!clone) continue;
+
+		USceneComponent* templateComponent = Components[i];
+		AActor* actorOwner = templateComponent->GetOwner();
+
+		//a clone of the root stays with the actor it was cloned from (attached to its original)
+		USceneComponent* parent = templateComponent;
+		USceneComponent* parentTemplate = templateComponent;
+		if (templateComponent != actorOwner->GetRootComponent())
+		{
+			parentIndices[i] = findClonedAncestor(templateComponent);
+			if (parentIndices[i] == INDEX_NONE || parentIndices[i] == i)
+			{
+				parentIndices[i] = INDEX_NONE;
+				parent = parentTemplate = templateComponent->GetAttachParent();
+			}
+			else
+			{
+				parent = clones[parentIndices[i]];
+				parentTemplate = Components[parentIndices[i]];
+			}
+		}
+
+		//Clones are placed where their originals are. A cloned parent will be where its original is too
+		clone->SetupAttachment(parent);
+		clone->SetRelativeTransform(parentTemplate
+			? templateComponent->GetComponentTransform().GetRelativeTransform(parentTemplate->GetComponentTransform())
+			: templateComponent->GetComponentTransform());
+	}
+
+	//registration phase, parents before children, so that each clone registers (and creates its render state) once
+	// already attached and in place
+	TArray<uint8> registered;
+	registered.SetNumZeroed(clones.Num());
+	TArray<int32> pending;
+	for (int32 i = 0; i < clones.Num(); ++i)
+	{
+		for (int32 j = i; j != INDEX_NONE && clones[j] && !registered[j]; j = parentIndices[j])
+			pending.Push(j);
+
+		while (pending.Num() > 0)
+		{
+			const int32 j = pending.Pop(false);
+			registered[j] = 1;
+			clones[j]->RegisterComponent();
+		}
+	}
+
+	UTransformerLayout* layout = GetEditLayout();
+	UTransformerVertexSnapping* vertexSnapping = UTransformerVertexSnapping::Get(this);
+	for (int32 i = 0; i < clones.Num(); ++i)
+	{
+		if (!clones[i]) continue;
+		outClones.Add(clones[i]);
+		if (layout)
+			layout->RecordClone(clones[i], Components[i]);
+		if (vertexSnapping)
+			vertexSnapping->AddComponent(clones[i]);
+	}
+
+	return outClones;
+}
+
+void ATransformerPawn::SelectComponent(class USceneComponent* Component
+	, bool bAppendToList)
+{
+	if (!Component) return;
+
+	if (ShouldSelect(Component->GetOwner(), Component))
+	{
+		if (false == bAppendToList)
+			DeselectAll();
+		AddComponent_Internal(SelectedComponents, Component);
+		UpdateGizmoPlacement();
+	}
+}
+
+void ATransformerPawn::SelectActor(AActor* Actor
+	, bool bAppendToList)
+{
+	if (!Actor) return;
+
+	if (ShouldSelect(Actor, Actor->GetRootComponent()))
+	{
+		if (false == bAppendToList)
+			DeselectAll();
+		AddComponent_Internal(SelectedComponents, Actor->GetRootComponent());
+		UpdateGizmoPlacement();
+	}
+}
+
+void ATransformerPawn::SelectMultipleComponents(const TArray<USceneComponent*>& Components
+	, bool bAppendToList)
+{
+	bool bValidList = false;
+
+	for (auto& c : Components)
+	{
+		if (!c) continue;
+		if (!ShouldSelect(c->GetOwner(), c)) continue;
+
+		if (false == bAppendToList)
+		{
+			DeselectAll();
+			bAppendToList = true;
+			//only run once. This is not place outside in case a list is empty or contains only invalid components
+		}
+		bValidList = true;
+		AddComponent_Internal(SelectedComponents, c);
+	}
+
+	if(bValidList) UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::SelectMultipleActors(const TArray<AActor*>& Actors
+	, bool bAppendToList)
+{
+	bool bValidList = false;
+	for (auto& a : Actors)
+	{
+		if (!a) continue;
+		if (!ShouldSelect(a, a->GetRootComponent())) continue;
+
+		if (false == bAppendToList)
+		{
+			DeselectAll();
+			bAppendToList = true;
+			//only run once. This is not place outside in case a list is empty or contains only invalid components
+		}
+
+		bValidList = true;
+		AddComponent_Internal(SelectedComponents, a->GetRootComponent());
+	}
+	if(bValidList) UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::DeselectComponent(USceneComponent* Component)
+{
+	if (!Component) return;
+	DeselectComponent_Internal(SelectedComponents, Component);
+	UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::DeselectActor(AActor* Actor)
+{
+	if (Actor)
+		DeselectComponent(Actor->GetRootComponent());
+}
+
+UTransformerLayout* ATransformerPawn::GetEditLayout() const
+{
+	return HasAuthority() ? UTransformerLayout::Get(this) : nullptr;
+}
+
+bool ATransformerPawn::ShouldSoftDelete() const
+{
+	return bSoftDelete && GetNetMode() == NM_Standalone;
+}
+
+TArray<USceneComponent*> ATransformerPawn::DeselectAll(bool bDestroyDeselected)
+{
+	UTransformerActorPool* actorPool = (bDestroyDeselected && ShouldSoftDelete()) ? UTransformerActorPool::Get(this) : nullptr;
+
+	//The Actors about to be destroyed are kept (serialized, or parked if soft deleting) so that the Delete can be undone
+	FTransformerUndoEntry deleteEntry;
+	if (bDestroyDeselected && ShouldRecordUndo())
+	{
+		CloseUndoTransform();
+		FlushUndoSelection();
+
+		TSet<AActor*> actorsProcessed;
+		TArray<AActor*> actorsToDestroy;
+		for (auto& c : SelectedComponents)
+		{
+			AActor* actor = IsValid(c) ? c->GetOwner() : nullptr;
+			if (!actor || (bComponentBased && actor->GetComponents().Num() > 1)) continue;
+			bool bAlreadyProcessed;
+			actorsProcessed.Add(actor, &bAlreadyProcessed);
+			if (!bAlreadyProcessed)
+				actorsToDestroy.Add(actor);
+		}
+
+		if (actorsToDestroy.Num() > 0)
+		{
+			deleteEntry.Type = ETransformerUndoType::Delete;
+			if (actorPool)
+			{
+				deleteEntry.bSoftDeleted = true;
+				deleteEntry.Restored.Append(actorsToDestroy);
+			}
+			else
+			{
+				deleteEntry.Deleted = MakeShared<FTransformerClipboard>();
+				deleteEntry.Deleted->Copy(actorsToDestroy, FTransform::Identity);
+			}
+		}
+	}
+
+	//nothing left to place the Gizmo on: no need to keep the bounds up to date while deselecting
+	SelectionBounds.Reset();
+
+	TArray<USceneComponent*> componentsToDeselect = SelectedComponents;
+	for (auto& i : componentsToDeselect)
+		DeselectComponent(i);
+		//calling internal so as not to modify SelectedComponents until the last bit!
+	SelectedComponents.Empty();
+	bEditStateSelectionDirty = true;
+	bUndoSelectionDirty = true;
+	UpdateGizmoPlacement();
+
+	if (bDestroyDeselected)
+	{
+		//Destructions that don't replicate are kept for late joiners
+		ATransformerEditState* editState = (HasAuthority() && GetNetMode() != NM_Standalone)
+			? ATransformerEditState::Get(this, true) : nullptr;
+		UTransformerLayout* layout = GetEditLayout();
+		UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this);
+
+		for (auto& c : componentsToDeselect)
+		{
+			if (!IsValid(c)) continue; //a component that was in the same actor destroyed will be pending kill
+			if (AActor* actor = c->GetOwner())
+			{
+				//We destroy the actor if no components are left to destroy, or the system is currently ActorBased
+				if (bComponentBased && actor->GetComponents().Num() > 1)
+				{
+					if (editState) editState->RecordDestroyed(c);
+					if (layout) layout->RecordDestroyed(c);
+					if (registry) registry->Unregister(c);
+					c->DestroyComponent(true);
+				}
+				else if (actorPool)
+				{
+					actorPool->Park(actor);
+					if (layout) layout->RecordSoftDeleted(actor);
+				}
+				else
+				{
+					if (editState) editState->RecordDestroyed(actor);
+					if (layout) layout->RecordDestroyed(actor);
+					actor->Destroy();
+				}
+			}
+		}
+	}
+
+	if (deleteEntry.Type == ETransformerUndoType::Delete)
+	{
+		PushUndoEntry(MoveTemp(deleteEntry));
+
+		//the Selection change is part of the Delete
+		ResetUndoSelection();
+	}
+
+	return componentsToDeselect;
+}
+
+void ATransformerPawn::SaveSelectionSet(FName Name)
+{
+	if (UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this))
+		registry->SaveSelectionSet(Name, registry->MakeSet(SelectedComponents));
+}
+
+bool ATransformerPawn::SelectSelectionSet(FName Name, bool bAppendToList)
+{
+	UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this);
+	const FTransformerSelectionSet* set = registry ? registry->FindSelectionSet(Name) : nullptr;
+	if (!set) return false;
+
+	SelectSet(*set, bAppendToList);
+	return true;
+}
+
+void ATransformerPawn::SelectSet(const FTransformerSelectionSet& Set, bool bAppendToList)
+{
+	UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this);
+	if (!registry) return;
+
+	//Reconciling only deselects / selects what differs, and filters with ShouldSelect
+	TArray<USceneComponent*> components;
+	if (bAppendToList)
+		components = SelectedComponents;
+	registry->GetSetComponents(Set, components);
+	ReconcileSelection(components);
+}
+
+int32 ATransformerPawn::SelectByQuery(const FTransformerSelectionQuery& Query, bool bAppendToList)
+{
+	UTransformerSelectableRegistry* registry = UTransformerSelectableRegistry::Get(this);
+	if (!registry) return INDEX_NONE;
+
+	const int32 queryId = ++LastSelectionQueryId;
+	TWeakObjectPtr<ATransformerPawn> weakThis(this);
+	registry->RunQuery(Query, [weakThis, queryId, bAppendToList](TArray<TWeakObjectPtr<USceneComponent>>&& Matches)
+		{
+			if (ATransformerPawn* pawn = weakThis.Get())
+				pawn->ApplySelectionQuery(queryId, Matches, bAppendToList);
+		});
+	return queryId;
+}
+
+void ATransformerPawn::ApplySelectionQuery(int32 QueryId, const TArray<TWeakObjectPtr<USceneComponent>>& Matches
+	, bool bAppendToList)
+{
+	TArray<USceneComponent*> components;
+	if (bAppendToList)
+		components = SelectedComponents;
+	const int32 firstMatch = components.Num();
+	components.Reserve(firstMatch + Matches.Num());
+	for (const TWeakObjectPtr<USceneComponent>& match : Matches)
+	{
+		if (USceneComponent* component = match.Get())
+			components.Add(component);
+	}
+
+	//ShouldSelect only runs for the matches (and whatever was already Selected, if appending)
+	ReconcileSelection(components);
+
+	TSet<USceneComponent*> selectedSet(SelectedComponents);
+	TArray<USceneComponent*> selected;
+	for (int32 i = firstMatch; i < components.Num(); ++i)
+	{
+		if (selectedSet.Contains(components[i]))
+			selected.Add(components[i]);
+	}
+	OnSelectionQueryApplied.Broadcast(QueryId, selected);
+}
+
+bool ATransformerPawn::ShouldRecordUndo() const
+{
+	//Clients don't keep a History: their edits are recorded in the Server as they're performed there
+	return bRecordUndoHistory && !bApplyingUndo && HasAuthority();
+}
+
+void ATransformerPawn::PushUndoEntry(FTransformerUndoEntry&& Entry)
+{
+	//the limits could have been edited since the last entry
+	UndoHistory.SetLimits(UndoHistoryMaxEntries, (SIZE_T)FMath::Max(UndoHistoryMaxMemoryKB, 1) * 1024);
+	UndoHistory.Push(MoveTemp(Entry));
+}
+
+void ATransformerPawn::RecordUndoTransform(USceneComponent* Component)
+{
+	if (!ShouldRecordUndo() || PendingUndoTransforms.Contains(Component)) return;
+	PendingUndoTransforms.Add(Component, Component->GetComponentTransform());
+}
+
+void ATransformerPawn::CloseUndoTransform()
+{
+	if (PendingUndoTransforms.Num() == 0) return;
+
+	FTransformerUndoEntry entry;
+	entry.Type = ETransformerUndoType::Transform;
+	for (auto& it : PendingUndoTransforms)
+	{
+		USceneComponent* component = it.Key.Get();
+		if (!component || component->GetComponentTransform().Equals(it.Value)) continue;
+
+		entry.Components.Add(component);
+		entry.Before.Add(it.Value);
+		entry.After.Add(component->GetComponentTransform());
+	}
+	PendingUndoTransforms.Reset();
+
+	if (entry.Components.Num() > 0)
+	{
+		//a Selection change that came before the drag goes before it
+		FlushUndoSelection();
+		PushUndoEntry(MoveTemp(entry));
+	}
+}
+
+void ATransformerPawn::FlushUndoSelection()
+{
+	if (!bUndoSelectionDirty) return;
+	bUndoSelectionDirty = false;
+
+	//only the difference is kept: what was selected and deselected since the last entry
+	TSet<TWeakObjectPtr<USceneComponent>> selection;
+	selection.Reserve(SelectedComponents.Num());
+	TArray<TWeakObjectPtr<USceneComponent>> selected;
+	for (auto& c : SelectedComponents)
+	{
+		bool bAlreadyInSet;
+		selection.Add(c, &bAlreadyInSet);
+		if (!bAlreadyInSet && !UndoSelectionSnapshot.Contains(c))
+			selected.Add(c);
+	}
+
+	TArray<TWeakObjectPtr<USceneComponent>> deselected;
+	for (auto& c : UndoSelectionSnapshot)
+	{
+		if (!selection.Contains(c))
+			deselected.Add(c);
+	}
+
+	UndoSelectionSnapshot = MoveTemp(selection);
+	if (selected.Num() == 0 && deselected.Num() == 0) return;
+
+	if (ShouldRecordUndo())
+	{
+		FTransformerUndoEntry entry;
+		entry.Type = ETransformerUndoType::Selection;
+		entry.Components = MoveTemp(selected);
+		entry.Deselected = MoveTemp(deselected);
+		PushUndoEntry(MoveTemp(entry));
+	}
+}
+
+void ATransformerPawn::ResetUndoSelection()
+{
+	UndoSelectionSnapshot.Reset();
+	for (auto& c : SelectedComponents)
+		UndoSelectionSnapshot.Add(c);
+	bUndoSelectionDirty = false;
+}
+
+void ATransformerPawn::Undo()
+{
+	if (GetLocalRole() < ROLE_Authority)
+		ServerUndo();
+	else
+		ApplyUndoEntry(true);
+}
+
+void ATransformerPawn::Redo()
+{
+	if (GetLocalRole() < ROLE_Authority)
+		ServerRedo();
+	else
+		ApplyUndoEntry(false);
+}
+
+void ATransformerPawn::ClearUndoHistory()
+{
+	UndoHistory.Empty();
+	PendingUndoTransforms.Reset();
+	ResetUndoSelection();
+}
+
+void ATransformerPawn::SetRecordUndoHistory(bool bRecord)
+{
+	if (bRecord == bRecordUndoHistory) return;
+
+	//the History starts from what is there now
+	ClearUndoHistory();
+	bRecordUndoHistory = bRecord;
+}
+
+void ATransformerPawn::DropSelectionToGround(bool bAlignToNormal)
+{
+	if (GetLocalRole() < ROLE_Authority)
+		ServerDropSelectionToGround(bAlignToNormal);
+	else
+		BeginDropToGround(bAlignToNormal);
+}
+
+//Height of the Landscape under Location (and the normal there), sampled from its collision heightfield
+static TOptional<double> SampleLandscapeHeight(const ALandscapeProxy* Landscape, const FVector& Location, FVector& outNormal)
+{
+	const TOptional<float> height = Landscape->GetHeightAtLocation(Location);
+	if (!height.IsSet()) return TOptional<double>();
+
+	//central differences, a quad apart
+	const double step = FMath::Max(Landscape->GetActorScale3D().X, 1.0);
+	const TOptional<float> left = Landscape->GetHeightAtLocation(Location - FVector(step, 0.0, 0.0));
+	const TOptional<float> right = Landscape->GetHeightAtLocation(Location + FVector(step, 0.0, 0.0));
+	const TOptional<float> back = Landscape->GetHeightAtLocation(Location - FVector(0.0, step, 0.0));
+	const TOptional<float> front = Landscape->GetHeightAtLocation(Location + FVector(0.0, step, 0.0));
+	if (left.IsSet() && right.IsSet() && back.IsSet() && front.IsSet())
+		outNormal = FVector(left.GetValue() - right.GetValue(), back.GetValue() - front.GetValue(), 2.0 * step).GetSafeNormal();
+	else
+		outNormal = FVector::UpVector;
+
+	return (double)height.GetValue();
+}
+
+void ATransformerPawn::BeginDropToGround(bool bAlignToNormal)
+{
+	UWorld* world = GetWorld();
+	if (!world || SelectedComponents.Num() == 0) return;
+
+	TUniquePtr<FDropToGround> drop = MakeUnique<FDropToGround>();
+	drop->bAlignToNormal = bAlignToNormal;
+	drop->Frame = GFrameCounter;
+	for (auto& c : SelectedComponents)
+	{
+		if (c) drop->IgnoredActors.Add(c->GetOwner());
+	}
+
+	//any Proxy of a Landscape samples all of it
+	TArray<ALandscapeProxy*> landscapes;
+	TSet<ULandscapeInfo*> landscapeInfos;
+	for (TActorIterator<ALandscapeProxy> it(world); it; ++it)
+	{
+		bool bKnown = false;
+		if (ULandscapeInfo* info = it->GetLandscapeInfo())
+			landscapeInfos.Add(info, &bKnown);
+		if (!bKnown)
+			landscapes.Add(*it);
+	}
+
+	TArray<USceneComponent*> roots;
+	GetRootComponents(SelectedComponents, roots);
+
+	//as with Collision Aware Drag, what blocks the Channel is picked when resolved, so the Selection can be skipped
+	static const FName traceName(TEXT("TransformerDropToGround"));
+	const FCollisionQueryParams params(traceName, false);
+	const FCollisionResponseParams responseParams(ECR_Overlap);
+
+	drop->Roots.Reserve(roots.Num());
+	for (USceneComponent* c : roots)
+	{
+		if (!(bForceMobility || c->Mobility == EComponentMobility::Type::Movable)) continue;
+
+		FDropToGround::FRoot& root = drop->Roots.AddDefaulted_GetRef();
+		root.Component = c;
+
+		//traced down from the top, so that what is sunk into the ground comes up
+		const FVector location = c->GetComponentLocation();
+		const FBox bounds = FTransformerSelectionBounds::GetHierarchyBounds(c, true);
+		const FVector traceStart = bounds.IsValid ? FVector(bounds.GetCenter().X, bounds.GetCenter().Y, bounds.Max.Z) : location;
+		root.PivotHeight = bounds.IsValid ? location.Z - bounds.Min.Z : 0.0;
+
+		double traceEndHeight = traceStart.Z - GroundTraceDistance;
+		for (ALandscapeProxy* landscape : landscapes)
+		{
+			root.LandscapeHeight = SampleLandscapeHeight(landscape, traceStart, root.LandscapeNormal);
+			if (root.LandscapeHeight.IsSet())
+			{
+				//only what is on top of the Landscape is left to trace
+				traceEndHeight = FMath::Max(traceEndHeight, root.LandscapeHeight.GetValue());
+				break;
+			}
+		}
+
+		if (traceEndHeight < traceStart.Z)
+		{
+			root.TraceHandle = world->AsyncLineTraceByChannel(EAsyncTraceType::Multi, traceStart
+				, FVector(traceStart.X, traceStart.Y, traceEndHeight), GroundTraceChannel, params, responseParams);
+		}
+	}
+
+	DropToGround = MoveTemp(drop);
+}
+
+void ATransformerPawn::FinishDropToGround()
+{
+	if (GFrameCounter <= DropToGround->Frame) return;
+	const TUniquePtr<FDropToGround> drop = MoveTemp(DropToGround);
+
+	UWorld* world = GetWorld();
+	TArray<USceneComponent*> components;
+	TArray<FTransform> transforms;
+	components.Reserve(drop->Roots.Num());
+	transforms.Reserve(drop->Roots.Num());
+
+	FTraceDatum traceDatum;
+	for (const FDropToGround::FRoot& root : drop->Roots)
+	{
+		USceneComponent* component = root.Component.Get();
+		if (!component) continue;
+
+		//nearest thing below that blocks the Channel. The Landscape is only hit if it couldn't be sampled
+		const FHitResult* groundHit = nullptr;
+		if (world && world->QueryTraceData(root.TraceHandle, traceDatum))
+		{
+			for (const FHitResult& hit : traceDatum.OutHits)
+			{
+				if (groundHit && hit.Time >= groundHit->Time) continue;
+				const UPrimitiveComponent* hitComponent = hit.GetComponent();
+				if (!hitComponent || drop->IgnoredActors.Contains(hit.GetActor())
+					|| (root.LandscapeHeight.IsSet() && Cast<ALandscapeProxy>(hit.GetActor()))
+					|| hitComponent->GetCollisionResponseToChannel(GroundTraceChannel) != ECR_Block)
+					continue;
+				groundHit = &hit;
+			}
+		}
+
+		double groundHeight;
+		FVector groundNormal;
+		if (groundHit)
+		{
+			groundHeight = groundHit->ImpactPoint.Z;
+			groundNormal = groundHit->ImpactNormal;
+		}
+		else if (root.LandscapeHeight.IsSet())
+		{
+			groundHeight = root.LandscapeHeight.GetValue();
+			groundNormal = root.LandscapeNormal;
+		}
+		else
+			continue; //nothing below
+
+		const FTransform& componentTransform = component->GetComponentTransform();
+		FTransform newTransform = componentTransform;
+		FVector up = FVector::UpVector;
+		if (drop->bAlignToNormal)
+		{
+			up = groundNormal;
+			const FQuat rotation = componentTransform.GetRotation();
+			newTransform.SetRotation(FQuat::FindBetweenNormals(rotation.GetUpVector(), groundNormal) * rotation);
+		}
+		const FVector location = componentTransform.GetLocation();
+		newTransform.SetLocation(FVector(location.X, location.Y, groundHeight) + up * root.PivotHeight);
+
+		components.Add(component);
+		transforms.Add(newTransform);
+	}
+
+	CommitTransforms(components, transforms);
+}
+
+void ATransformerPawn::CommitTransforms(const TArray<USceneComponent*>& Components, const TArray<FTransform>& Transforms)
+{
+	if (Components.Num() == 0) return;
+
+	//what was transformed before is an edit of its own
+	CloseUndoTransform();
+
+	//components of each Actor (parents before children), so that each Actor gets one scoped movement update
+	TMap<AActor*, TArray<int32>> actorComponents;
+	for (int32 i = 0; i < Components.Num(); ++i)
+	{
+		if (Components[i])
+			actorComponents.FindOrAdd(Components[i]->GetOwner()).Add(i);
+	}
+
+	auto depth = [](const USceneComponent* Component)
+		{
+			int32 d = 0;
+			for (const USceneComponent* c = Component->GetAttachParent(); c; c = c->GetAttachParent())
+				++d;
+			return d;
+		};
+
+	for (auto& it : actorComponents)
+	{
+		TArray<int32>& indices = it.Value;
+		if (indices.Num() > 1)
+		{
+			indices.StableSort([&Components, &depth](int32 a, int32 b)
+				{
+					return depth(Components[a]) < depth(Components[b]);
+				});
+		}
+
+		//overlaps and children of the Actor are updated once, when the scope ends (after all its transforms are set)
+		USceneComponent* root = it.Key ? it.Key->GetRootComponent() : nullptr;
+		FScopedMovementUpdate scopedUpdate(root ? root : Components[indices[0]], EScopedUpdate::DeferredUpdates);
+		for (int32 i : indices)
+		{
+			USceneComponent* component = Components[i];
+			component->SetMobility(EComponentMobility::Type::Movable);
+			SetTransform(component, Transforms[i]);
+		}
+	}
+
+	CloseUndoTransform();
+	if (GetNetMode() != NM_Standalone)
+	{
+		MulticastSetTransformsChunked(Components, Transforms);
+		if (ATransformerEditState* editState = ATransformerEditState::Get(this, true))
+		{
+			for (auto& component : Components)
+				editState->RecordTransform(component);
+		}
+	}
+	ScheduleEditedActorsDormancy();
+	if (UTransformerLayout* layout = GetEditLayout())
+		layout->CommitJournal();
+}
+
+void ATransformerPawn::GatherSelectionLayout(TArray<FSelectionLayoutItem>& outItems) const
+{
+	TArray<USceneComponent*> roots;
+	GetRootComponents(SelectedComponents, roots);
+
+	outItems.Reset(roots.Num());
+	for (USceneComponent* root : roots)
+	{
+		if (bForceMobility || root->Mobility == EComponentMobility::Type::Movable)
+			outItems.AddDefaulted_GetRef().Component = root;
+	}
+
+	//nothing is written to the Components: they're only read while the Game Thread waits
+	ParallelFor(outItems.Num(), [&outItems](int32 i)
+		{
+			FSelectionLayoutItem& item = outItems[i];
+			item.Transform = item.Component->GetComponentTransform();
+			item.Bounds = FTransformerSelectionBounds::GetHierarchyBounds(item.Component, false);
+			if (!item.Bounds.IsValid)
+				item.Bounds = FBox(item.Transform.GetLocation(), item.Transform.GetLocation());
+		});
+}
+
+//Axes (0 = X, 1 = Y, 2 = Z) of the Domain
+static TArray<int32, TInlineAllocator<3>> GetDomainAxes(ETransformationDomain Domain)
+{
+	switch (Domain)
+	{
+	case ETransformationDomain::TD_X_Axis:		return { 0 };
+	case ETransformationDomain::TD_Y_Axis:		return { 1 };
+	case ETransformationDomain::TD_Z_Axis:		return { 2 };
+	case ETransformationDomain::TD_XY_Plane:	return { 0, 1 };
+	case ETransformationDomain::TD_YZ_Plane:	return { 1, 2 };
+	case ETransformationDomain::TD_XZ_Plane:	return { 0, 2 };
+	case ETransformationDomain::TD_XYZ:			return { 0, 1, 2 };
+	default:									return {};
+	}
+}
+
+void ATransformerPawn::AlignSelection(ETransformationDomain Axes, ESelectionAlignment Alignment, bool bUseBounds)
+{
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		ServerAlignSelection(Axes, Alignment, bUseBounds);
+		return;
+	}
+
+	const TArray<int32, TInlineAllocator<3>> axes = GetDomainAxes(Axes);
+	TArray<FSelectionLayoutItem> items;
+	GatherSelectionLayout(items);
+	if (axes.Num() == 0 || items.Num() < 2) return;
+
+	//extent of the Selection
+	FBox selectionBox(ForceInit);
+	for (const FSelectionLayoutItem& item : items)
+	{
+		if (bUseBounds)
+			selectionBox += item.Bounds;
+		else
+			selectionBox += item.Transform.GetLocation();
+	}
+
+	TArray<USceneComponent*> components;
+	TArray<FTransform> transforms;
+	components.SetNumUninitialized(items.Num());
+	transforms.SetNumUninitialized(items.Num());
+	ParallelFor(items.Num(), [&](int32 i)
+		{
+			const FSelectionLayoutItem& item = items[i];
+			const FVector location = item.Transform.GetLocation();
+			const FBox box = bUseBounds ? item.Bounds : FBox(location, location);
+
+			FVector offset = FVector::ZeroVector;
+			for (int32 axis : axes)
+			{
+				switch (Alignment)
+				{
+				case ESelectionAlignment::SA_Min:		offset[axis] = selectionBox.Min[axis] - box.Min[axis]; break;
+				case ESelectionAlignment::SA_Center:	offset[axis] = selectionBox.GetCenter()[axis] - box.GetCenter()[axis]; break;
+				case ESelectionAlignment::SA_Max:		offset[axis] = selectionBox.Max[axis] - box.Max[axis]; break;
+				}
+			}
+
+			components[i] = item.Component;
+			transforms[i] = item.Transform;
+			transforms[i].SetLocation(location + offset);
+		});
+
+	CommitTransforms(components, transforms);
+}
+
+void ATransformerPawn::DistributeSelection(ETransformationDomain Axes, bool bUseBounds)
+{
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		ServerDistributeSelection(Axes, bUseBounds);
+		return;
+	}
+
+	const TArray<int32, TInlineAllocator<3>> axes = GetDomainAxes(Axes);
+	TArray<FSelectionLayoutItem> items;
+	GatherSelectionLayout(items);
+	if (axes.Num() == 0 || items.Num() < 3) return;
+
+	TArray<FVector> offsets;
+	offsets.SetNumZeroed(items.Num());
+
+	TArray<int32> order;
+	order.SetNumUninitialized(items.Num());
+	for (int32 axis : axes)
+	{
+		//order along the axis
+		for (int32 i = 0; i < order.Num(); ++i)
+			order[i] = i;
+		order.Sort([&items, axis, bUseBounds](int32 a, int32 b)
+			{
+				return bUseBounds ? items[a].Bounds.GetCenter()[axis] < items[b].Bounds.GetCenter()[axis]
+					: items[a].Transform.GetLocation()[axis] < items[b].Transform.GetLocation()[axis];
+			});
+
+		const FSelectionLayoutItem& first = items[order[0]];
+		const FSelectionLayoutItem& last = items[order.Last()];
+		const int32 intervals = order.Num() - 1;
+
+		if (bUseBounds)
+		{
+			//equal gaps: whatever the sizes don't fill of the span between the first and the last
+			double sizes = 0.0;
+			for (const FSelectionLayoutItem& item : items)
+				sizes += item.Bounds.Max[axis] - item.Bounds.Min[axis];
+			const double gap = (last.Bounds.Max[axis] - first.Bounds.Min[axis] - sizes) / intervals;
+
+			double next = first.Bounds.Min[axis];
+			for (int32 index : order)
+			{
+				offsets[index][axis] = next - items[index].Bounds.Min[axis];
+				next += items[index].Bounds.Max[axis] - items[index].Bounds.Min[axis] + gap;
+			}
+		}
+		else
+		{
+			const double start = first.Transform.GetLocation()[axis];
+			const double step = (last.Transform.GetLocation()[axis] - start) / intervals;
+			for (int32 i = 0; i < order.Num(); ++i)
+				offsets[order[i]][axis] = start + step * i - items[order[i]].Transform.GetLocation()[axis];
+		}
+	}
+
+	TArray<USceneComponent*> components;
+	TArray<FTransform> transforms;
+	components.SetNumUninitialized(items.Num());
+	transforms.SetNumUninitialized(items.Num());
+	ParallelFor(items.Num(), [&](int32 i)
+		{
+			components[i] = items[i].Component;
+			transforms[i] = items[i].Transform;
+			transforms[i].AddToTranslation(offsets[i]);
+		});
+
+	CommitTransforms(components, transforms);
+}
+
+void ATransformerPawn::RandomizeSelection(FRotator RotationJitter, float ScaleJitter, int32 Seed)
+{
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		ServerRandomizeSelection(RotationJitter, ScaleJitter, Seed);
+		return;
+	}
+
+	TArray<FSelectionLayoutItem> items;
+	GatherSelectionLayout(items);
+	if (items.Num() == 0) return;
+
+	if (Seed == 0)
+		Seed = FMath::Rand();
+	ScaleJitter = FMath::Clamp(ScaleJitter, 0.f, 0.99f);
+
+	TArray<USceneComponent*> components;
+	TArray<FTransform> transforms;
+	components.SetNumUninitialized(items.Num());
+	transforms.SetNumUninitialized(items.Num());
+	ParallelFor(items.Num(), [&](int32 i)
+		{
+			//a stream per root, so the result doesn't depend on how the work is split
+			FRandomStream stream((int32)HashCombine(GetTypeHash(Seed), GetTypeHash(i)));
+			const FRotator jitter(
+				stream.FRandRange(-RotationJitter.Pitch, RotationJitter.Pitch),
+				stream.FRandRange(-RotationJitter.Yaw, RotationJitter.Yaw),
+				stream.FRandRange(-RotationJitter.Roll, RotationJitter.Roll));
+			const float scale = 1.f + stream.FRandRange(-ScaleJitter, ScaleJitter);
+
+			components[i] = items[i].Component;
+			transforms[i] = items[i].Transform;
+			transforms[i].SetRotation(items[i].Transform.GetRotation() * jitter.Quaternion());
+			transforms[i].SetScale3D(items[i].Transform.GetScale3D() * scale);
+		});
+
+	CommitTransforms(components, transforms);
+}
+
+void ATransformerPawn::ApplyUndoEntry(bool bUndo)
+{
+	//anything not recorded yet is the latest edit
+	CloseUndoTransform();
+	FlushUndoSelection();
+
+	FTransformerUndoEntry* entry = bUndo ? UndoHistory.PeekUndo() : UndoHistory.PeekRedo();
+	if (!entry) return;
+
+	TGuardValue<bool> applyingUndo(bApplyingUndo, true);
+	const bool bNetworked = GetNetMode() != NM_Standalone;
+
+	//Selects exactly the given components (and tells the Clients)
+	auto setSelection = [this, bNetworked](const TArray<USceneComponent*>& Components)
+		{
+			ReconcileSelection(Components);
+			if (bNetworked)
+				MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+		};
+
+	switch (entry->Type)
+	{
+	case ETransformerUndoType::Transform:
+	{
+		TArray<USceneComponent*> components;
+		TArray<FTransform> transforms;
+		const TArray<FTransform>& targetTransforms = bUndo ? entry->Before : entry->After;
+		for (int32 i = 0; i < entry->Components.Num(); ++i)
+		{
+			USceneComponent* component = entry->Components[i].Get();
+			if (!component) continue;
+			SetTransform(component, targetTransforms[i]);
+			components.Add(component);
+			transforms.Add(targetTransforms[i]);
+		}
+
+		if (bNetworked && components.Num() > 0)
+		{
+			MulticastSetTransformsChunked(components, transforms);
+			if (ATransformerEditState* editState = ATransformerEditState::Get(this, true))
+			{
+				for (auto& component : components)
+					editState->RecordTransform(component);
+			}
+		}
+		break;
+	}
+	case ETransformerUndoType::Selection:
+	{
+		//the Selection as it is, without what the entry selected (Undo) / deselected (Redo) and with what it deselected / selected
+		const TArray<TWeakObjectPtr<USceneComponent>>& toDeselect = bUndo ? entry->Components : entry->Deselected;
+		const TArray<TWeakObjectPtr<USceneComponent>>& toSelect = bUndo ? entry->Deselected : entry->Components;
+
+		TSet<USceneComponent*> deselectSet;
+		deselectSet.Reserve(toDeselect.Num());
+		for (auto& c : toDeselect)
+		{
+			if (c.IsValid()) deselectSet.Add(c.Get());
+		}
+
+		TArray<USceneComponent*> components;
+		components.Reserve(SelectedComponents.Num() + toSelect.Num());
+		for (auto& c : SelectedComponents)
+		{
+			if (!deselectSet.Contains(c)) components.Add(c);
+		}
+		for (auto& c : toSelect)
+		{
+			if (c.IsValid()) components.Add(c.Get());
+		}
+		setSelection(components);
+		break;
+	}
+	case ETransformerUndoType::Delete:
+	{
+		if (bUndo && entry->bSoftDeleted)
+		{
+			//unparked as they were. The ones the pool has destroyed since are gone for good
+			UTransformerActorPool* actorPool = UTransformerActorPool::Get(this);
+			UTransformerLayout* layout = GetEditLayout();
+			TArray<USceneComponent*> roots;
+			for (auto& actor : entry->Restored)
+			{
+				if (!actorPool || !actor.IsValid() || !actorPool->Unpark(actor.Get())) continue;
+				if (layout) layout->RecordSoftDeleted(actor.Get(), true);
+				if (actor->GetRootComponent())
+					roots.Add(actor->GetRootComponent());
+			}
+			setSelection(roots);
+		}
+		else if (bUndo)
+		{
+			//brought back as new Actors, which are what a Redo deletes again
+			entry->Restored.Reset();
+			TArray<USceneComponent*> roots;
+			for (AActor* actor : entry->Deleted->Paste(GetWorld(), { FTransform::Identity }))
+			{
+				entry->Restored.Add(actor);
+				if (actor->GetRootComponent())
+					roots.Add(actor->GetRootComponent());
+			}
+			setSelection(roots);
+		}
+		else
+		{
+			TArray<USceneComponent*> roots;
+			for (auto& actor : entry->Restored)
+			{
+				if (actor.IsValid() && actor->GetRootComponent())
+					roots.Add(actor->GetRootComponent());
+			}
+			setSelection(roots);
+
+			if (bNetworked)
+				MulticastDeselectAll(true);
+			else
+			{
+				//deleted the same way it was the first time, so that the entry can still undo it
+				TGuardValue<bool> softDelete(bSoftDelete, entry->bSoftDeleted);
+				DeselectAll(true);
+			}
+		}
+		break;
+	}
+	}
+
+	if (bUndo)
+		UndoHistory.MoveBack();
+	else
+		UndoHistory.MoveForward();
+
+	//The Selection changes made by the Undo / Redo are not new edits
+	ResetUndoSelection();
+}
+
+void ATransformerPawn::AddComponent_Internal(TArray<USceneComponent*>& OutComponentList
+	, USceneComponent* Component)
+{
+	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+
+	int32 Index = OutComponentList.Find(Component);
+
+	if (INDEX_NONE == Index) //Component is not in list
+		AddNewComponent_Internal(OutComponentList, Component);
+	else if (bToggleSelectedInMultiSelection)
+		DeselectComponentAtIndex_Internal(OutComponentList, Index);
+}
+
+void ATransformerPawn::AddNewComponent_Internal(TArray<USceneComponent*>& OutComponentList
+	, USceneComponent* Component)
+{
+	OutComponentList.Emplace(Component);
+	if (&OutComponentList == &SelectedComponents && IsGizmoOnSelectionCenter())
+		SelectionBounds.Add(Component);
+	bEditStateSelectionDirty = true;
+	bUndoSelectionDirty = true;
+	bool bImplementsInterface;
+	Select(OutComponentList.Last(), &bImplementsInterface);
+	OnComponentSelectionChange(Component, true, bImplementsInterface);
+}
+
+void ATransformerPawn::DeselectComponent_Internal(TArray<USceneComponent*>& OutComponentList
+	, USceneComponent* Component)
+{
+	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+
+	int32 Index = OutComponentList.Find(Component);
+	if (INDEX_NONE != Index)
+		DeselectComponentAtIndex_Internal(OutComponentList, Index);
+}
+
+void ATransformerPawn::DeselectComponentAtIndex_Internal(
+	TArray<USceneComponent*>& OutComponentList
+	, int32 Index)
+{
+	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+	if (OutComponentList.IsValidIndex(Index))
+	{
+		USceneComponent* Component = OutComponentList[Index];
+		bool bImplementsInterface;
+		Deselect(Component, &bImplementsInterface);
+		OutComponentList.RemoveAt(Index);
+		SelectionBounds.Remove(Component);
+		bEditStateSelectionDirty = true;
+		bUndoSelectionDirty = true;
+		OnComponentSelectionChange(Component, false, bImplementsInterface);
+	}
+
+}
+
+void ATransformerPawn::SetGizmo()
+{
+
+	//If there are selected components, then we see whether we need to create a new gizmo.
+	if (SelectedComponents.Num() > 0 && ShouldSpawnGizmo())
+	{
+		bool bCreateGizmo = true;
+		if (Gizmo.IsValid())
+		{
+			if (CurrentTransformation == Gizmo->GetGizmoType())
+			{
+				bCreateGizmo = false; // do not create gizmo if there is already a matching gizmo
+			}
+			else
+			{
+				// Destroy the current gizmo as the transformation types do not match
+				Gizmo->Destroy();
+				Gizmo.Reset();
+			}
+		}
+
+		if (bCreateGizmo)
+		{
+			if (UWorld* world = GetWorld())
+			{
+				UClass* GizmoClass = GetGizmoClass(CurrentTransformation);
+				if (GizmoClass)
+				{
+					Gizmo = Cast<ABaseGizmo>(world->SpawnActor(GizmoClass));
+					Gizmo->OnGizmoStateChange.AddDynamic(this, &ATransformerPawn::OnGizmoStateChanged);
+				}
+			}
+		}
+	}
+	//Since there are no selected components (or no gizmo is needed), we must destroy any gizmos present
+	else
+	{
+		if (Gizmo.IsValid())
+		{
+			Gizmo->Destroy();
+			Gizmo.Reset();
+		}
+	}
+
+
+}
+
+void ATransformerPawn::UpdateGizmoPlacement()
+{
+	SetGizmo();
+	//means that there are no active gizmos (no selections) so nothing to do in this func
+	if (!Gizmo.IsValid()) return;
+
+	USceneComponent* ComponentToAttachTo = GetGizmoPlacementComponent();
+	FVector selectionCenter;
+
+	if (ComponentToAttachTo)
+	{
+		Gizmo->AttachToComponent(ComponentToAttachTo
+		, FAttachmentTransformRules::SnapToTargetIncludingScale);
+	}
+	else if (GetSelectionCenter(selectionCenter))
+	{
+		//not on a Component: Tick moves it along when the Selection moves
+		Gizmo->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		Gizmo->SetActorLocation(selectionCenter);
+	}
+	else
+	{
+	//	Gizmo->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	}
+
+	Gizmo->UpdateGizmoSpace(CurrentSpaceType);
+
+	//Local Space of a detached Gizmo is that of the Last Selection
+	if (!ComponentToAttachTo && CurrentSpaceType == ESpaceType::ST_Local && IsGizmoOnSelectionCenter()
+		&& SelectedComponents.Num() > 0 && SelectedComponents.Last())
+		Gizmo->SetActorRotation(SelectedComponents.Last()->GetComponentQuat());
+}
+
+void ATransformerPawn::SetGizmoPlacement(EGizmoPlacement Placement)
+{
+	if (GizmoPlacement == Placement) return;
+	GizmoPlacement = Placement;
+
+	//tracked from scratch, then incrementally for as long as the placement needs it
+	if (IsGizmoOnSelectionCenter())
+		SelectionBounds.Reset(SelectedComponents);
+	else
+		SelectionBounds.Reset();
+
+	UpdateGizmoPlacement();
+}
+
+bool ATransformerPawn::IsGizmoOnSelectionCenter() const
+{
+	return GizmoPlacement == EGizmoPlacement::GP_OnBoundsCenter || GizmoPlacement == EGizmoPlacement::GP_OnCentroid;
+}
+
+bool ATransformerPawn::GetSelectionCenter(FVector& outCenter) const
+{
+	if (!IsGizmoOnSelectionCenter() || SelectionBounds.Num() == 0) return false;
+
+	outCenter = GizmoPlacement == EGizmoPlacement::GP_OnBoundsCenter ? SelectionBounds.GetBounds().GetCenter()
+		: SelectionBounds.GetCentroid();
+	return true;
+}
+
+
+bool ATransformerPawn::ShouldSpawnGizmo() const
+{
+	//Gizmos are only for whoever is looking through this Pawn. 
+	// Remote editors don't need one (nor does a Dedicated Server): transforms are pure math (see ApplyDeltaTransform)
+	const ENetMode netMode = GetNetMode();
+	if (netMode == NM_DedicatedServer) return false;
+	return netMode == NM_Standalone || IsLocallyControlled();
+}
+
+USceneComponent* ATransformerPawn::GetGizmoPlacementComponent() const
+{
+	if (SelectedComponents.Num() == 0) return nullptr;
+
+	switch (GizmoPlacement)
+	{
+	case EGizmoPlacement::GP_OnFirstSelection: 
+		return SelectedComponents[0];
+	case EGizmoPlacement::GP_OnLastSelection:
+		return SelectedComponents.Last();
+	}
+	return nullptr;
+}
+
+FVector ATransformerPawn::GetTransformPivot() const
+{
+	if (Gizmo.IsValid())
+		return Gizmo->GetActorLocation();
+
+	//the pivot doesn't move while rotating / scaling around it (neither would a Gizmo), so it's only worked out once per drag
+	if (DragPivot.IsSet())
+		return DragPivot.GetValue();
+
+	FVector pivot = FVector::ZeroVector; //a Gizmo would be left where it was spawned
+	FVector selectionCenter;
+	if (USceneComponent* placementComponent = GetGizmoPlacementComponent())
+		pivot = placementComponent->GetComponentLocation(); //a Gizmo would be snapped to this component
+	else if (GetSelectionCenter(selectionCenter))
+		pivot = selectionCenter; //or placed on the Selection Center
+
+	if (CurrentDomain != ETransformationDomain::TD_None)
+		DragPivot = pivot;
+	return pivot;
+}
+
+/*
+ * Primitives showing a Remote Selection Indicator: the Pawns showing it, and the Custom Depth state they had before
+ * (which could be the local user's own outline), put back once no Pawn shows it anymore.
+ */
+struct FRemoteSelectionIndicator
+{
+	TSet<TWeakObjectPtr<const ATransformerPawn>> Pawns;
+	bool bRenderedCustomDepth = false;
+	int32 StencilValue = 0;
+};
+static TMap<TWeakObjectPtr<UPrimitiveComponent>, FRemoteSelectionIndicator> RemoteSelectionIndicators;
+static int32 RemoteSelectionIndicatorsPruneSize = 1024;
+
+void ATransformerPawn::SetRemoteSelectionIndicator(USceneComponent* Component, bool bVisible) const
+{
+	if (!bShowRemoteSelectionIndicator || !Component || ShouldSpawnGizmo()
+		|| GetNetMode() == NM_DedicatedServer) 
+		return;
+
+	TArray<UPrimitiveComponent*> primitives;
+	if (bComponentBased)
+	{
+		if (UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(Component))
+			primitives.Add(primitive);
+	}
+	else if (AActor* owner = Component->GetOwner())
+		owner->GetComponents(primitives);
+
+	//forget the Primitives that are gone (or the Pawns that showed them), every time the map doubles
+	if (RemoteSelectionIndicators.Num() >= RemoteSelectionIndicatorsPruneSize)
+	{
+		for (auto it = RemoteSelectionIndicators.CreateIterator(); it; ++it)
+		{
+			if (!it->Key.IsValid())
+				it.RemoveCurrent();
+		}
+		RemoteSelectionIndicatorsPruneSize = FMath::Max(1024, RemoteSelectionIndicators.Num() * 2);
+	}
+
+	for (UPrimitiveComponent* primitive : primitives)
+	{
+		if (bVisible)
+		{
+			FRemoteSelectionIndicator* indicator = RemoteSelectionIndicators.Find(primitive);
+			if (!indicator)
+			{
+				indicator = &RemoteSelectionIndicators.Add(primitive);
+				indicator->bRenderedCustomDepth = primitive->bRenderCustomDepth;
+				indicator->StencilValue = primitive->CustomDepthStencilValue;
+			}
+			indicator->Pawns.Add(this);
+			primitive->SetRenderCustomDepth(true);
+			primitive->SetCustomDepthStencilValue(RemoteSelectionStencilValue);
+			continue;
+		}
+
+		FRemoteSelectionIndicator* indicator = RemoteSelectionIndicators.Find(primitive);
+		if (!indicator) continue;
+
+		//still selected by other remote Pawns (the ones destroyed since don't count)
+		indicator->Pawns.Remove(this);
+		for (auto it = indicator->Pawns.CreateIterator(); it; ++it)
+		{
+			if (!it->IsValid())
+				it.RemoveCurrent();
+		}
+		if (indicator->Pawns.Num() > 0) continue;
+
+		primitive->SetRenderCustomDepth(indicator->bRenderedCustomDepth);
+		primitive->SetCustomDepthStencilValue(indicator->StencilValue);
+		RemoteSelectionIndicators.Remove(primitive);
+	}
+}
+
+
+///////////////////////// NETWORKING ////////////////////////////////////////////////////////////////////////
+
+
+void ATransformerPawn::ReplicatedMouseTraceByObjectTypes(float TraceDistance
+	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels, bool bAppendToList)
+{
+	FVector start, end;
+	if (GetMouseStartEndPoints(TraceDistance, start, end))
+		ReplicatedTraceByObjectTypes(start, end, CollisionChannels, bAppendToList);
+}
+
+void ATransformerPawn::ReplicatedMouseTraceByChannel(float TraceDistance
+	, TEnumAsByte<ECollisionChannel> CollisionChannel, bool bAppendToList)
+{
+	FVector start, end;
+	if (GetMouseStartEndPoints(TraceDistance, start, end))
+		ReplicatedTraceByChannel(start, end, CollisionChannel, bAppendToList);
+}
+
+void ATransformerPawn::ReplicatedMouseTraceByProfile(float TraceDistance
+	, const FName& ProfileName, bool bAppendToList)
+{
+	FVector start, end;
+	if (GetMouseStartEndPoints(TraceDistance, start, end))
+		ReplicatedTraceByProfile(start, end, ProfileName, bAppendToList);
+}
+
+void ATransformerPawn::ReplicatedTraceByObjectTypes(const FVector& StartLocation
+	, const FVector& EndLocation
+	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels, bool bAppendToList)
+{
+	bool bTraceSuccessful = TraceByObjectTypes(StartLocation, EndLocation
+		, CollisionChannels
+		, TArray<AActor*>(), bAppendToList);
+
+	//Server
+	if (GetLocalRole() == ROLE_Authority)
+		ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
+	//Client
+	else
+	{
+		if (!bTraceSuccessful && !bAppendToList)
+		{
+			//Predict the Deselection. The Multicast will find nothing left to deselect
+			DeselectAll(false);
+			ServerDeselectAll(false);
+		}
+		else
+		{
+			// If a Local Trace was on a Gizmo, just tell the Server that we 
+			// have hit our Gizmo and just change the Domain there.
+			// Else, do the Server Trace
+			if (CurrentDomain == ETransformationDomain::TD_None)
+			{
+				ServerTraceByObjectTypes(StartLocation, EndLocation, CollisionChannels, bAppendToList
+					, BeginPredictedSelection());
+			}
+			else
+				ServerSetDomain(CurrentDomain);
+		}
+	}
+}
+
+void ATransformerPawn::ReplicatedTraceByChannel(const FVector& StartLocation
+	, const FVector& EndLocation
+	, TEnumAsByte<ECollisionChannel> CollisionChannel, bool bAppendToList)
+{
+	bool bTraceSuccessful = TraceByChannel(StartLocation, EndLocation
+		, CollisionChannel
+		, TArray<AActor*>(), bAppendToList);
+
+	//Server
+	if (GetLocalRole() == ROLE_Authority)
+		ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
+	//Client
+	else
+	{
+		if (!bTraceSuccessful && !bAppendToList)
+		{
+			//Predict the Deselection. The Multicast will find nothing left to deselect
+			DeselectAll(false);
+			ServerDeselectAll(false);
+		}
+
+		// If a Local Trace was on a Gizmo, just tell the Server that we 
+		// have hit our Gizmo and just change the Domain there.
+		// Else, do the Server Trace
+		if (CurrentDomain == ETransformationDomain::TD_None)
+		{
+			ServerTraceByChannel(StartLocation, EndLocation, CollisionChannel, bAppendToList
+				, BeginPredictedSelection());
+		}
+		else
+			ServerSetDomain(CurrentDomain);
+	}
+}
+
+void ATransformerPawn::ReplicatedTraceByProfile(const FVector& StartLocation
+	, const FVector& EndLocation
+	, const FName& ProfileName, bool bAppendToList)
+{
+	bool bTraceSuccessful = TraceByProfile(StartLocation, EndLocation
+		, ProfileName
+		, TArray<AActor*>(), bAppendToList);
+
+	//Server
+	if (GetLocalRole() == ROLE_Authority)
+		ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
+	//Client
+	else
+	{
+		if (!bTraceSuccessful && !bAppendToList)
+		{
+			//Predict the Deselection. The Multicast will find nothing left to deselect
+			DeselectAll(false);
+			ServerDeselectAll(false);
+		}
+
+		// If a Local Trace was on a Gizmo, just tell the Server that we 
+		// have hit our Gizmo and just change the Domain there.
+		// Else, do the Server Trace
+		if (CurrentDomain == ETransformationDomain::TD_None)
+		{
+			ServerTraceByProfile(StartLocation, EndLocation, ProfileName, bAppendToList
+				, BeginPredictedSelection());
+		}
+		else
+			ServerSetDomain(CurrentDomain);
+	}
+}
+
+
+
+TArray<AActor*> ATransformerPawn::GetIgnoredActorsForServerTrace() const
+{
+	//Remote Pawns have no Gizmo in the Server, so there's nothing of theirs to ignore.
+	// Gizmos of other Pawns are skipped in HandleTracedObjects
+	return TArray<AActor*>();
+}
+
+void ATransformerPawn::ReplicateServerTraceResults(bool bTraceSuccessful, bool bAppendToList)
+{
+	//Only perform this on Clients
+	if (!HasAuthority())
+	{
+		if (!bTraceSuccessful && !bAppendToList)
+			DeselectAll(false);
+		MulticastSetDomain(CurrentDomain);
+		MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+	}
+}
+
+int32 ATransformerPawn::BeginPredictedSelection()
+{
+	// The Local Trace has already been applied to the Selection (the prediction).
+	// The Server reply carrying this Id is reconciled against it in MulticastSetSelectedComponents
+	ServerRequestTime = FPlatformTime::Seconds();
+	return ++LatestSelectionRequestId;
+}
+
+bool ATransformerPawn::ReconcileSelection(const TArray<USceneComponent*>& Components)
+{
+	//The Selection we want to end up with (in the given order), without nulls, duplicates or unselectable components
+	TArray<USceneComponent*> targetComponents;
+	TSet<USceneComponent*> targetSet;
+	targetComponents.Reserve(Components.Num());
+	targetSet.Reserve(Components.Num());
+	for (auto& c : Components)
+	{
+		if (!c || targetSet.Contains(c)) continue;
+		if (!ShouldSelect(c->GetOwner(), c)) continue;
+		targetSet.Add(c);
+		targetComponents.Add(c);
+	}
+
+	bool bChanged = false;
+
+	//Deselect only what is not in the target list (backwards, as we're removing by index)
+	for (int32 i = SelectedComponents.Num() - 1; i >= 0; --i)
+	{
+		if (!targetSet.Contains(SelectedComponents[i]))
+		{
+			DeselectComponentAtIndex_Internal(SelectedComponents, i);
+			bChanged = true;
+		}
+	}
+
+	//Select only what is missing
+	TSet<USceneComponent*> currentSet(SelectedComponents);
+	for (auto& c : targetComponents)
+	{
+		if (!currentSet.Contains(c))
+		{
+			AddNewComponent_Internal(SelectedComponents, c);
+			bChanged = true;
+		}
+	}
+
+	//Same components at this point, but the order matters for the Gizmo Placement
+	if (SelectedComponents != targetComponents)
+	{
+		SelectedComponents = MoveTemp(targetComponents);
+		bEditStateSelectionDirty = true;
+		bUndoSelectionDirty = true;
+		bChanged = true;
+	}
+
+	if (bChanged)
+		UpdateGizmoPlacement();
+
+	return bChanged;
+}
+
+void ATransformerPawn::LogSelectedComponents()
+{
+
+	UE_LOG(LogRuntimeTransformer, Log, TEXT("******************** SELECTED COMPONENTS LOG START ********************"));
+    UE_LOG(LogRuntimeTransformer, Log, TEXT("   * Selected Component Count: %d"), SelectedComponents.Num());
+    UE_LOG(LogRuntimeTransformer, Log, TEXT("   * -------------------------------- "));
+	for (int32 i = 0; i < SelectedComponents.Num(); ++i)
+	{
+		USceneComponent* cmp = SelectedComponents[i];
+		FString message = "Component: ";
+		if (cmp)
+		{
+			message += cmp->GetName() + "\tOwner: ";
+			if (AActor* owner = cmp->GetOwner())
+				message += owner->GetName();
+			else
+				message += TEXT("[INVALID]");
+		}
+		else
+			message += TEXT("[INVALID]");
+
+        UE_LOG(LogRuntimeTransformer, Log, TEXT("   * [%d] %s"), i, *message);
+	}
+
+    UE_LOG(LogRuntimeTransformer, Log, TEXT("******************** SELECTED COMPONENTS LOG END   ********************"));
+}
+
+void ATransformerPawn::RecordReceivedRpc(const TCHAR* RpcName, int32 PayloadBytes
+	, bool bReceivedFromNetwork) const
+{
+#if RUNTIMETRANSFORMER_NET_STATS
+	// RPCs called locally (e.g. Server RPCs on a Listen Server) never touch the network
+	if (bReceivedFromNetwork)
+		FTransformerNetStats::Get().RecordRpc(RpcName, PayloadBytes);
+#endif
+}
+
+void ATransformerPawn::ScheduleServerEdit(const TCHAR* CommandName, bool bHeavy, TFunction<void()>&& Edit)
+{
+	UTransformerEditScheduler* scheduler = bScheduleServerEdits ? UTransformerEditScheduler::Get(this) : nullptr;
+
+	//Light edits run right away, unless they'd jump ahead of this Pawn's queued edits
+	if (!scheduler || (!bHeavy && !scheduler->HasPendingCommands(this)))
+	{
+		Edit();
+		return;
+	}
+
+	scheduler->Enqueue(this, CommandName, [Edit = MoveTemp(Edit)](double Deadline)
+		{
+			Edit();
+			return true;
+		});
+}
+
+void ATransformerPawn::ScheduleServerEditSteps(const TCHAR* CommandName, TFunction<bool(double)>&& Step)
+{
+	UTransformerEditScheduler* scheduler = bScheduleServerEdits ? UTransformerEditScheduler::Get(this) : nullptr;
+	if (!scheduler)
+	{
+		while (!Step(TNumericLimits<double>::Max()));
+		return;
+	}
+
+	scheduler->Enqueue(this, CommandName, MoveTemp(Step));
+}
+
+bool ATransformerPawn::ServerTraceByObjectTypes_Validate(
+	const FVector& StartLocation, const FVector& EndLocation
+	, const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
+	, bool bAppendToList, int32 RequestId) 
+{ 
+	return true; 
+}
+
+void ATransformerPawn::ServerTraceByObjectTypes_Implementation(
+	const FVector& StartLocation, const FVector& EndLocation
+	, const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
+	, bool bAppendToList, int32 RequestId)
+{
+	RecordReceivedRpc(TEXT("ServerTraceByObjectTypes"), FTransformerNetStats::EstimateVector() * 2 + CollisionChannels.Num() + 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerTraceByObjectTypes"), false, [this, StartLocation, EndLocation, CollisionChannels, bAppendToList, RequestId]()
+		{
+			bool bTraceSuccessful = TraceByObjectTypes(StartLocation, EndLocation, CollisionChannels
+				, GetIgnoredActorsForServerTrace(), bAppendToList);
+
+			if (!bTraceSuccessful && !bAppendToList)
+				//check whether trace was successful and we're not doing multi selection
+				DeselectAll(false);
+
+			//0 for calls that weren't predicted: the reply keeps the latest Id so the client doesn't discard it
+			if (RequestId != 0)
+				LatestSelectionRequestId = RequestId;
+			MulticastSetDomain(CurrentDomain);
+			MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+		});
+}
+
+
+
+bool ATransformerPawn::ServerTraceByChannel_Validate(
+	const FVector& StartLocation, const FVector& EndLocation
+	, ECollisionChannel TraceChannel, bool bAppendToList, int32 RequestId)
+{
+	return true;
+}
+
+void ATransformerPawn::ServerTraceByChannel_Implementation(
+	const FVector& StartLocation, const FVector& EndLocation
+	, ECollisionChannel TraceChannel, bool bAppendToList, int32 RequestId)
+{
+	RecordReceivedRpc(TEXT("ServerTraceByChannel"), FTransformerNetStats::EstimateVector() * 2 + 2, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerTraceByChannel"), false, [this, StartLocation, EndLocation, TraceChannel, bAppendToList, RequestId]()
+		{
+			bool bTraceSuccessful = TraceByChannel(StartLocation, EndLocation, TraceChannel
+				, GetIgnoredActorsForServerTrace(), bAppendToList);
+
+			if (!bTraceSuccessful && !bAppendToList)
+				//check whether trace was successful and we're not doing multi selection
+				DeselectAll(false);
+
+			//0 for calls that weren't predicted: the reply keeps the latest Id so the client doesn't discard it
+			if (RequestId != 0)
+				LatestSelectionRequestId = RequestId;
+			MulticastSetDomain(CurrentDomain);
+			MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+		});
+}
+
+
+
+bool ATransformerPawn::ServerTraceByProfile_Validate(const FVector& StartLocation
+	, const FVector& EndLocation, const FName& ProfileName, bool bAppendToList, int32 RequestId) 
+{ 
+	return true; 
+}
+
+
+void ATransformerPawn::ServerTraceByProfile_Implementation(
+	const FVector& StartLocation, const FVector& EndLocation
+	, const FName& ProfileName, bool bAppendToList, int32 RequestId)
+{
+	RecordReceivedRpc(TEXT("ServerTraceByProfile"), FTransformerNetStats::EstimateVector() * 2 + ProfileName.GetStringLength() + 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerTraceByProfile"), false, [this, StartLocation, EndLocation, ProfileName, bAppendToList, RequestId]()
+		{
+			bool bTraceSuccessful = TraceByProfile(StartLocation, EndLocation, ProfileName
+				, GetIgnoredActorsForServerTrace(), bAppendToList);
+
+			if (!bTraceSuccessful && !bAppendToList) 
+				//check whether trace was successful and we're not doing multi selection
+				DeselectAll(false); 
+
+			//0 for calls that weren't predicted: the reply keeps the latest Id so the client doesn't discard it
+			if (RequestId != 0)
+				LatestSelectionRequestId = RequestId;
+			MulticastSetDomain(CurrentDomain);
+			MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+		});
+}
+
+bool ATransformerPawn::ServerClearDomain_Validate() 
+{ 
+	return true; 
+}
+void ATransformerPawn::ServerClearDomain_Implementation()
+{
+	RecordReceivedRpc(TEXT("ServerClearDomain"), 0, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerClearDomain"), false, [this]()
+		{
+			MulticastClearDomain();
+		});
+}
+
+void ATransformerPawn::MulticastClearDomain_Implementation()
+{
+	RecordReceivedRpc(TEXT("MulticastClearDomain"), 0, GetLocalRole() < ROLE_Authority);
+	ClearDomain();
+}
+
+bool ATransformerPawn::ServerApplyTransform_Validate(const FTransform& DeltaTransform)
+{
+	return true;
+}
+void ATransformerPawn::ServerApplyTransform_Implementation(const FTransform& DeltaTransform)
+{
+	RecordReceivedRpc(TEXT("ServerApplyTransform"), FTransformerNetStats::EstimateTransform(), !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerApplyTransform"), true, [this, DeltaTransform]()
+		{
+			MulticastApplyTransform(DeltaTransform);
+		});
+}
+
+void ATransformerPawn::MulticastApplyTransform_Implementation(const FTransform& DeltaTransform)
+{
+	RecordReceivedRpc(TEXT("MulticastApplyTransform"), FTransformerNetStats::EstimateTransform(), GetLocalRole() < ROLE_Authority);
+	if (Controller && !Controller->IsLocalController()) //only apply to others
+	{
+		ApplyDeltaTransform(DeltaTransform);
+
+		//ClearDomain already ran (before the drag was applied here): commit what the drag moved to
+		if (HasAuthority())
+			CommitTransformEdit();
+	}
+}
+
+
+void ATransformerPawn::ReplicateFinishTransform()
+{
+	if (bDuplicateDragging)
+	{
+		//Clone in the Server (new clones become the Selection) and move the clones where the ghosts were dragged to
+		EndDuplicateDrag(false);
+		ServerClearDomain();
+		ServerCloneSelected(true, false);
+		ServerApplyTransform(NetworkDeltaTransform);
+		ResetDeltaTransform(NetworkDeltaTransform);
+		return;
+	}
+
+	if (IsPredictingDrag())
+	{
+		//Server has been applying the streamed input already. Just send the last of it (reliably)
+		ServerFinishDrag(++DragInputSequence, NetworkDeltaTransform);
+		ResetDeltaTransform(NetworkDeltaTransform);
+		DragPredictionHistory.Reset();
+		PredictedDragTransforms.Reset();
+		return;
+	}
+
+	ServerClearDomain();
+	ServerApplyTransform(NetworkDeltaTransform);
+	ResetDeltaTransform(NetworkDeltaTransform);
+}
+
+void ATransformerPawn::SetServerAuthoritativeDrag(bool bServerAuthoritative)
+{
+	bServerAuthoritativeDrag = bServerAuthoritative;
+	DragPredictionHistory.Reset();
+	PredictedDragTransforms.Reset();
+}
+
+bool ATransformerPawn::IsPredictingDrag() const
+{
+	//Ghosts of a Duplicate Drag are local only. The Server gets the whole drag on release
+	return bServerAuthoritativeDrag && GetLocalRole() < ROLE_Authority && IsLocallyControlled()
+		&& !bDuplicateDragging;
+}
+
+void ATransformerPawn::StreamDragInput()
+{
+	if (CurrentDomain == ETransformationDomain::TD_None) return;
+
+	//Keep track of what we predicted, so that Replicated Movement (which lags behind our input) does not overwrite it
+	for (auto& c : SelectedComponents)
+	{
+		if (c && !HasOwnMovementAuthority(c))
+			PredictedDragTransforms.Add(c, c->GetComponentTransform());
+	}
+
+	const double now = FPlatformTime::Seconds();
+	if (now - LastDragStreamTime < DragStreamInterval) return;
+	LastDragStreamTime = now;
+
+	FDragPrediction& prediction = DragPredictionHistory.AddDefaulted_GetRef();
+	prediction.Sequence = ++DragInputSequence;
+	prediction.Components = SelectedComponents;
+	prediction.Transforms.Reserve(SelectedComponents.Num());
+	for (auto& c : SelectedComponents)
+		prediction.Transforms.Add(c ? c->GetComponentTransform() : FTransform::Identity);
+
+	//Bound the history. Anything older than this will never be corrected against
+	const int32 maxHistory = 64;
+	if (DragPredictionHistory.Num() > maxHistory)
+		DragPredictionHistory.RemoveAt(0, DragPredictionHistory.Num() - maxHistory, false);
+
+	//The accumulated delta (rather than the per frame delta) is sent so that lost packets don't cause drift
+	ServerStreamDrag(prediction.Sequence, NetworkDeltaTransform
+		, HashComponentTransforms(SelectedComponents));
+}
+
+bool ATransformerPawn::ApplyServerDragInput(int32 Sequence, const FTransform& AccumulatedDelta)
+{
+	//Unreliable input can arrive out of order, and late input of a finished drag must not start a new one
+	if (Sequence <= DragInputSequence) return false;
+	DragInputSequence = Sequence;
+
+	//Increment from what we already applied. Same composition as the NetworkDeltaTransform
+	FTransform increment(
+		AccumulatedDelta.GetRotation() * ServerAppliedDragDelta.GetRotation().Inverse(),
+		AccumulatedDelta.GetLocation() - ServerAppliedDragDelta.GetLocation(),
+		AccumulatedDelta.GetScale3D() - ServerAppliedDragDelta.GetScale3D());
+
+	ServerAppliedDragDelta = AccumulatedDelta;
+
+	//Only the Server's Selection for this Pawn is affected, whatever the client thinks it has selected
+	TGuardValue<bool> applyingDragInput(bApplyingServerDragInput, true);
+	ApplyDeltaTransform(increment);
+	return true;
+}
+
+bool ATransformerPawn::HasOwnMovementAuthority(const USceneComponent* Component)
+{
+	const UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(Component);
+	if (primitive && primitive->IsSimulatingPhysics()) return true;
+
+	//Player State is replicated, so clients and Server agree on which Pawns are possessed by players
+	const APawn* pawn = Cast<APawn>(Component->GetOwner());
+	return pawn && pawn->GetPlayerState();
+}
+
+void ATransformerPawn::GetServerDragTransforms(TArray<USceneComponent*>& OutComponents, TArray<FTransform>& OutTransforms) const
+{
+	OutComponents.Reset(SelectedComponents.Num());
+	OutTransforms.Reset(SelectedComponents.Num());
+	for (auto& c : SelectedComponents)
+	{
+		if (!c || HasOwnMovementAuthority(c)) continue;
+		OutComponents.Add(c);
+		OutTransforms.Add(c->GetComponentTransform());
+	}
+}
+
+uint32 ATransformerPawn::HashComponentTransforms(const TArray<USceneComponent*>& Components)
+{
+	uint32 hash = 0;
+	for (auto& c : Components)
+	{
+		if (c && !HasOwnMovementAuthority(c))
+			hash = HashComponentTransform(c, hash);
+	}
+	return hash;
+}
+
+uint32 ATransformerPawn::HashComponentTransform(const USceneComponent* Component, uint32 Hash)
+{
+	//Quantized so that float noise between machines doesn't produce mismatches
+	const FTransform& t = Component->GetComponentTransform();
+	const FVector location = t.GetLocation() * 10.f;
+	const FQuat rotation = t.GetRotation();
+	const FVector scale = t.GetScale3D() * 1000.f;
+
+	const double values[] = { location.X, location.Y, location.Z
+		, rotation.X * 1000.f, rotation.Y * 1000.f, rotation.Z * 1000.f, rotation.W * 1000.f
+		, scale.X, scale.Y, scale.Z };
+	for (double value : values)
+		Hash = HashCombine(Hash, GetTypeHash(FMath::RoundToInt(value)));
+	return Hash;
+}
+
+uint32 ATransformerPawn::GetSelectionGroupChecksum(int32 GroupIndex) const
+{
+	UNetDriver* netDriver = GetNetDriver();
+	const FNetGUIDCache* guidCache = netDriver ? netDriver->GuidCache.Get() : nullptr;
+
+	const int32 first = GroupIndex * DesyncGroupSize;
+	const int32 last = FMath::Min(first + DesyncGroupSize, SelectedComponents.Num());
+
+	uint32 hash = GetTypeHash(GroupIndex);
+	for (int32 i = first; i < last; ++i)
+	{
+		const USceneComponent* c = SelectedComponents[i];
+		//Object pointers & names differ between machines. Network GUIDs don't
+		const FNetworkGUID guid = (c && guidCache) ? guidCache->GetNetGUID(c) : FNetworkGUID();
+		hash = HashCombine(hash, GetTypeHash(guid));
+		if (c)
+			hash = HashComponentTransform(c, hash);
+	}
+	return hash;
+}
+
+void ATransformerPawn::SendSelectionChecksums()
+{
+	LastDesyncCheckTime = FPlatformTime::Seconds();
+
+	//Only compare when nothing's in flight: no transform in progress and no selection request pending
+	if (CurrentDomain != ETransformationDomain::TD_None || ServerRequestTime > 0.0
+		|| DragCorrections.Num() > 0 || ResyncSelectionTimerHandle.IsValid())
+		return;
+
+	const int32 groupCount = FMath::DivideAndRoundUp(SelectedComponents.Num(), DesyncGroupSize);
+	TArray<uint32> checksums;
+	checksums.Reserve(groupCount);
+	for (int32 i = 0; i < groupCount; ++i)
+		checksums.Add(GetSelectionGroupChecksum(i));
+
+	ServerCheckSelectionChecksums(LatestSelectionRequestId, SelectedComponents.Num(), checksums);
+}
+
+bool ATransformerPawn::ServerCheckSelectionChecksums_Validate(int32 RequestId
+	, int32 SelectionCount, const TArray<uint32>& GroupChecksums)
+{
+	return SelectionCount >= 0 && GroupChecksums.Num() <= SelectionCount;
+}
+
+void ATransformerPawn::ServerCheckSelectionChecksums_Implementation(int32 RequestId
+	, int32 SelectionCount, const TArray<uint32>& GroupChecksums)
+{
+	RecordReceivedRpc(TEXT("ServerCheckSelectionChecksums")
+		, 8 + 2 + GroupChecksums.Num() * 4, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerCheckSelectionChecksums"), false, [this, RequestId, SelectionCount, GroupChecksums]()
+		{
+			//The client is waiting for a reply to a newer request, or a transform is in progress
+			if (RequestId != LatestSelectionRequestId || CurrentDomain != ETransformationDomain::TD_None)
+				return;
+
+			const int32 groupCount = FMath::DivideAndRoundUp(FMath::Max(SelectionCount, SelectedComponents.Num()), DesyncGroupSize);
+
+			TArray<int32> groupIndices;
+			TArray<USceneComponent*> components;
+			TArray<FTransform> transforms;
+			for (int32 g = 0; g < groupCount; ++g)
+			{
+				if (GroupChecksums.IsValidIndex(g) && GroupChecksums[g] == GetSelectionGroupChecksum(g))
+					continue;
+
+				groupIndices.Add(g);
+				const int32 last = FMath::Min((g + 1) * DesyncGroupSize, SelectedComponents.Num());
+				for (int32 i = g * DesyncGroupSize; i < last; ++i)
+				{
+					components.Add(SelectedComponents[i]);
+					transforms.Add(SelectedComponents[i] ? SelectedComponents[i]->GetComponentTransform() : FTransform::Identity);
+				}
+			}
+
+			if (groupIndices.Num() > 0)
+			{
+				UE_LOG(LogRuntimeTransformer, Log, TEXT("Selection Checksums: %d of %d groups mismatched")
+					, groupIndices.Num(), groupCount);
+				ClientResendSelectionGroups(SelectedComponents.Num(), groupIndices, components, transforms);
+			}
+		});
+}
+
+void ATransformerPawn::ClientResendSelectionGroups_Implementation(int32 SelectionCount
+	, const TArray<int32>& GroupIndices, const TArray<USceneComponent*>& Components
+	, const TArray<FTransform>& Transforms)
+{
+	RecordReceivedRpc(TEXT("ClientResendSelectionGroups")
+		, 4 + 2 + GroupIndices.Num() * 4 + FTransformerNetStats::EstimateObjectArray(Components.Num())
+			+ Transforms.Num() * FTransformerNetStats::EstimateTransform()
+		, GetLocalRole() < ROLE_Authority);
+
+#if RUNTIMETRANSFORMER_NET_STATS
+	FTransformerNetStats::Get().RecordDesyncGroups(GroupIndices.Num());
+#endif
+
+	if (Components.Num() != Transforms.Num()) return;
+
+	//Something changed since the checksums were sent. The next checksums will tell whether it's still off
+	if (CurrentDomain != ETransformationDomain::TD_None || ServerRequestTime > 0.0)
+		return;
+
+	//Keep the groups that matched, replace the ones that didn't
+	TArray<USceneComponent*> serverSelection = SelectedComponents;
+	serverSelection.SetNum(SelectionCount);
+
+	int32 next = 0;
+	for (int32 g : GroupIndices)
+	{
+		const int32 first = g * DesyncGroupSize;
+		const int32 last = FMath::Min(first + DesyncGroupSize, SelectionCount);
+		for (int32 i = first; i < last && next < Components.Num(); ++i, ++next)
+		{
+			USceneComponent* component = Components[next];
+			serverSelection[i] = component;
+			if (component && !component->GetComponentTransform().Equals(Transforms[next], KINDA_SMALL_NUMBER))
+				SetTransform(component, Transforms[next]);
+		}
+	}
+
+	//nulls (not yet replicated) are filtered out in here, and will mismatch again next time
+	ReconcileSelection(serverSelection);
+}
+
+void ATransformerPawn::RestorePredictedDragTransforms()
+{
+	for (auto& predicted : PredictedDragTransforms)
+	{
+		USceneComponent* component = predicted.Key.Get();
+		if (!component) continue;
+
+		AActor* owner = component->GetOwner();
+		if (!owner || !owner->IsReplicatingMovement()) continue;
+
+		// Replicated Movement is the Server applying our own (older) input, so it's behind our prediction.
+		// Real divergence is handled by the ClientDragCorrection instead
+		if (!component->GetComponentTransform().Equals(predicted.Value))
+			component->SetWorldTransform(predicted.Value);
+	}
+}
+
+void ATransformerPawn::AddDragCorrection(USceneComponent* Component
+	, const FTransform& Predicted, const FTransform& Authoritative)
+{
+	FTransform error(
+		Authoritative.GetRotation() * Predicted.GetRotation().Inverse(),
+		Authoritative.GetLocation() - Predicted.GetLocation(),
+		Authoritative.GetScale3D() - Predicted.GetScale3D());
+
+	if (error.GetLocation().Size() < DragCorrectionThreshold 
+		&& error.GetRotation().GetAngle() < FMath::DegreesToRadians(DragCorrectionThreshold)
+		&& error.GetScale3D().Size() < KINDA_SMALL_NUMBER * 100.f)
+		return;
+
+	//Blended in over the next frames rather than snapped. Accumulates with any correction still in progress
+	FTransform& correction = DragCorrections.FindOrAdd(Component, FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector));
+	correction = FTransform(
+		error.GetRotation() * correction.GetRotation(),
+		error.GetLocation() + correction.GetLocation(),
+		error.GetScale3D() + correction.GetScale3D());
+}
+
+void ATransformerPawn::BlendDragCorrections(float DeltaSeconds)
+{
+	const float alpha = 1.f - FMath::Exp(-DragCorrectionBlendSpeed * DeltaSeconds);
+
+	for (auto it = DragCorrections.CreateIterator(); it; ++it)
+	{
+		USceneComponent* component = it->Key.Get();
+		if (!component)
+		{
+			it.RemoveCurrent();
+			continue;
+		}
+
+		FTransform& remaining = it->Value;
+		const FQuat stepRotation = FQuat::Slerp(FQuat::Identity, remaining.GetRotation(), alpha);
+
+		const FTransform& current = component->GetComponentTransform();
+		FTransform corrected(
+			stepRotation * current.GetRotation(),
+			current.GetLocation() + remaining.GetLocation() * alpha,
+			current.GetScale3D() + remaining.GetScale3D() * alpha);
+
+		SetTransform(component, corrected);
+		if (FTransform* predicted = PredictedDragTransforms.Find(component))
+			*predicted = corrected;
+
+		remaining = FTransform(
+			stepRotation.Inverse() * remaining.GetRotation(),
+			remaining.GetLocation() * (1.f - alpha),
+			remaining.GetScale3D() * (1.f - alpha));
+
+		if (remaining.GetLocation().IsNearlyZero(0.01f) && remaining.GetScale3D().IsNearlyZero(0.0001f)
+			&& remaining.GetRotation().GetAngle() < KINDA_SMALL_NUMBER)
+			it.RemoveCurrent();
 	}
 }
 
-void ATransformerPawn::ReplicatedMouseTraceByChannel(float TraceDistance
-	, TEnumAsByte<ECollisionChannel> CollisionChannel, bool bAppendToList)
+bool ATransformerPawn::ServerStreamDrag_Validate(int32 Sequence
+	, const FTransform& AccumulatedDelta, uint32 PredictedHash)
+{
+	return true;
+}
+
+void ATransformerPawn::ServerStreamDrag_Implementation(int32 Sequence
+	, const FTransform& AccumulatedDelta, uint32 PredictedHash)
+{
+	RecordReceivedRpc(TEXT("ServerStreamDrag"), FTransformerNetStats::EstimateTransform() + 8, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerStreamDrag"), false, [this, Sequence, AccumulatedDelta, PredictedHash]()
+		{
+			if (!ApplyServerDragInput(Sequence, AccumulatedDelta)) return;
+
+			//Only correct the client if it actually diverged from us (and not more often than DragCorrectionInterval)
+			if (PredictedHash == HashComponentTransforms(SelectedComponents)) return;
+
+			const double now = FPlatformTime::Seconds();
+			if (now - LastDragCorrectionTime < DragCorrectionInterval) return;
+			LastDragCorrectionTime = now;
+
+			TArray<USceneComponent*> components;
+			TArray<FTransform> transforms;
+			GetServerDragTransforms(components, transforms);
+			ClientDragCorrection(Sequence, components, transforms);
+		});
+}
+
+bool ATransformerPawn::ServerFinishDrag_Validate(int32 Sequence, const FTransform& AccumulatedDelta)
+{
+	return true;
+}
+
+void ATransformerPawn::ServerFinishDrag_Implementation(int32 Sequence, const FTransform& AccumulatedDelta)
 {
-	FVector start, end;
-	if (GetMouseStartEndPoints(TraceDistance, start, end))
-	{
-		bool bTraceSuccessful = TraceByChannel(start, end
-			, CollisionChannel
-			, TArray<AActor*>(), bAppendToList);
+	RecordReceivedRpc(TEXT("ServerFinishDrag"), FTransformerNetStats::EstimateTransform() + 4, !IsLocallyControlled());
 
-		//Server
-		if (GetLocalRole() == ROLE_Authority)
-			ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
-		//Client
-		else
+	ScheduleServerEdit(TEXT("ServerFinishDrag"), false, [this, Sequence, AccumulatedDelta]()
 		{
-			if (!bTraceSuccessful && !bAppendToList)
-				ServerDeselectAll(false);
+			ApplyServerDragInput(Sequence, AccumulatedDelta);
+			ResetDeltaTransform(ServerAppliedDragDelta);
 
-			// If a Local Trace was on a Gizmo, just tell the Server that we 
-			// have hit our Gizmo and just change the Domain there.
-			// Else, do the Server Trace
-			if (CurrentDomain == ETransformationDomain::TD_None)
-				ServerTraceByChannel(start, end, CollisionChannel, bAppendToList);
-			else
-				ServerSetDomain(CurrentDomain);
-		}
-	}
+			TArray<USceneComponent*> components;
+			TArray<FTransform> transforms;
+			GetServerDragTransforms(components, transforms);
+
+			//Absolute, so every client ends up on the Server's result regardless of what it had
+			MulticastSetTransformsChunked(components, transforms);
+			MulticastClearDomain();
+		});
 }
 
-void ATransformerPawn::ReplicatedMouseTraceByProfile(float TraceDistance
-	, const FName& ProfileName, bool bAppendToList)
+void ATransformerPawn::ClientDragCorrection_Implementation(int32 Sequence
+	, const TArray<USceneComponent*>& Components, const TArray<FTransform>& Transforms)
 {
-	FVector start, end;
-	if (GetMouseStartEndPoints(TraceDistance, start, end))
-	{
-		bool bTraceSuccessful = TraceByProfile(start, end
-			, ProfileName
-			, TArray<AActor*>(), bAppendToList);
+	RecordReceivedRpc(TEXT("ClientDragCorrection")
+		, FTransformerNetStats::EstimateObjectArray(Components.Num()) + Transforms.Num() * FTransformerNetStats::EstimateTransform() + 4
+		, true);
 
-		//Server
-		if (GetLocalRole() == ROLE_Authority)
-			ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
-		//Client
-		else
-		{
-			if (!bTraceSuccessful && !bAppendToList)
-				ServerDeselectAll(false);
+	const int32 index = DragPredictionHistory.IndexOfByPredicate([Sequence](const FDragPrediction& prediction)
+		{ return prediction.Sequence == Sequence; });
+	if (INDEX_NONE == index) return; //too old, a newer correction will come if we're still off
 
-			// If a Local Trace was on a Gizmo, just tell the Server that we 
-			// have hit our Gizmo and just change the Domain there.
-			// Else, do the Server Trace
-			if (CurrentDomain == ETransformationDomain::TD_None)
-				ServerTraceByProfile(start, end, ProfileName, bAppendToList);
-			else
-				ServerSetDomain(CurrentDomain);
-		}		
+	const FDragPrediction& prediction = DragPredictionHistory[index];
+	for (int32 i = 0; i < Components.Num() && i < Transforms.Num(); ++i)
+	{
+		if (!Components[i]) continue;
+		const int32 predictedIndex = prediction.Components.Find(Components[i]);
+		if (prediction.Transforms.IsValidIndex(predictedIndex))
+			AddDragCorrection(Components[i], prediction.Transforms[predictedIndex], Transforms[i]);
 	}
-}
 
+	//Everything up to this input has now been corrected against
+	DragPredictionHistory.RemoveAt(0, index + 1, false);
+}
 
+//Components (and Transforms) per MulticastSetTransforms. Well under the default net.MaxRepArraySize (2048)
+static const int32 MaxTransformsPerMulticast = 1024;
 
-TArray<AActor*> ATransformerPawn::GetIgnoredActorsForServerTrace() const
+void ATransformerPawn::MulticastSetTransformsChunked(const TArray<USceneComponent*>& Components
+	, const TArray<FTransform>& Transforms)
 {
-	TArray<AActor*> ignoredActors;
-	//Ignore Gizmo in Server Trace Test if it's not Server controlling Pawn (since Gizmo is relative)
-	if (!IsLocallyControlled())
+	const int32 count = FMath::Min(Components.Num(), Transforms.Num());
+	if (count <= MaxTransformsPerMulticast)
 	{
-		if (Gizmo.IsValid())
-			ignoredActors.Add(Gizmo.Get());
+		MulticastSetTransforms(Components, Transforms);
+		return;
 	}
-	return ignoredActors;
-}
 
-void ATransformerPawn::ReplicateServerTraceResults(bool bTraceSuccessful, bool bAppendToList)
-{
-	//Only perform this on Clients
-	if (!HasAuthority())
+	TArray<USceneComponent*> chunkComponents;
+	TArray<FTransform> chunkTransforms;
+	for (int32 start = 0; start < count; start += MaxTransformsPerMulticast)
 	{
-		if (!bTraceSuccessful && !bAppendToList)
-			DeselectAll(false);
-		MulticastSetDomain(CurrentDomain);
-		MulticastSetSelectedComponents(SelectedComponents);
+		const int32 chunkSize = FMath::Min(MaxTransformsPerMulticast, count - start);
+		chunkComponents.Reset(chunkSize);
+		chunkTransforms.Reset(chunkSize);
+		chunkComponents.Append(Components.GetData() + start, chunkSize);
+		chunkTransforms.Append(Transforms.GetData() + start, chunkSize);
+		MulticastSetTransforms(chunkComponents, chunkTransforms);
 	}
 }
 
-void ATransformerPawn::LogSelectedComponents()
+void ATransformerPawn::MulticastSetTransforms_Implementation(const TArray<USceneComponent*>& Components
+	, const TArray<FTransform>& Transforms)
 {
+	RecordReceivedRpc(TEXT("MulticastSetTransforms")
+		, FTransformerNetStats::EstimateObjectArray(Components.Num()) + Transforms.Num() * FTransformerNetStats::EstimateTransform()
+		, GetLocalRole() < ROLE_Authority);
 
-	UE_LOG(LogRuntimeTransformer, Log, TEXT("******************** SELECTED COMPONENTS LOG START ********************"));
-    UE_LOG(LogRuntimeTransformer, Log, TEXT("   * Selected Component Count: %d"), SelectedComponents.Num());
-    UE_LOG(LogRuntimeTransformer, Log, TEXT("   * -------------------------------- "));
-	for (int32 i = 0; i < SelectedComponents.Num(); ++i)
+	if (HasAuthority()) return; //Server is where these come from
+
+	const bool bPredictingDrag = IsPredictingDrag();
+	for (int32 i = 0; i < Components.Num() && i < Transforms.Num(); ++i)
 	{
-		USceneComponent* cmp = SelectedComponents[i];
-		FString message = "Component: ";
-		if (cmp)
+		USceneComponent* component = Components[i];
+		if (!component) continue;
+
+		//A component we're still predicting a drag for blends into the Server's result to avoid snapping. The rest just take it
+		if (bPredictingDrag && PredictedDragTransforms.Contains(component))
 		{
-			message += cmp->GetName() + "\tOwner: ";
-			if (AActor* owner = cmp->GetOwner())
-				message += owner->GetName();
-			else
-				message += TEXT("[INVALID]");
+			AddDragCorrection(component, component->GetComponentTransform(), Transforms[i]);
+			continue;
 		}
-		else
-			message += TEXT("[INVALID]");
 
-        UE_LOG(LogRuntimeTransformer, Log, TEXT("   * [%d] %s"), i, *message);
+		//a correction still blending in would move it off the Server's result
+		DragCorrections.Remove(component);
+		SetTransform(component, Transforms[i]);
 	}
-
-    UE_LOG(LogRuntimeTransformer, Log, TEXT("******************** SELECTED COMPONENTS LOG END   ********************"));
 }
 
-bool ATransformerPawn::ServerTraceByObjectTypes_Validate(
-	const FVector& StartLocation, const FVector& EndLocation
-	, const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
-	, bool bAppendToList) 
+bool ATransformerPawn::ServerDeselectAll_Validate(bool bDestroySelected) 
 { 
 	return true; 
 }
-
-void ATransformerPawn::ServerTraceByObjectTypes_Implementation(
-	const FVector& StartLocation, const FVector& EndLocation
-	, const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
-	, bool bAppendToList)
+void ATransformerPawn::ServerDeselectAll_Implementation(bool bDestroySelected)
 {
-	bool bTraceSuccessful = TraceByObjectTypes(StartLocation, EndLocation, CollisionChannels
-		, GetIgnoredActorsForServerTrace(), bAppendToList);
-
-	if (!bTraceSuccessful && !bAppendToList)
-		//check whether trace was successful and we're not doing multi selection
-		DeselectAll(false);
+	RecordReceivedRpc(TEXT("ServerDeselectAll"), 1, !IsLocallyControlled());
 
-	MulticastSetDomain(CurrentDomain);
-	MulticastSetSelectedComponents(SelectedComponents);
+	ScheduleServerEdit(TEXT("ServerDeselectAll"), bDestroySelected, [this, bDestroySelected]()
+		{
+			MulticastDeselectAll(bDestroySelected);
+		});
 }
 
+void ATransformerPawn::MulticastDeselectAll_Implementation(bool bDestroySelected)
+{
+	RecordReceivedRpc(TEXT("MulticastDeselectAll"), 1, GetLocalRole() < ROLE_Authority);
+	DeselectAll(bDestroySelected);
+}
 
-
-bool ATransformerPawn::ServerTraceByChannel_Validate(
-	const FVector& StartLocation, const FVector& EndLocation
-	, ECollisionChannel TraceChannel, bool bAppendToList)
+bool ATransformerPawn::ServerUndo_Validate()
 {
 	return true;
 }
 
-void ATransformerPawn::ServerTraceByChannel_Implementation(
-	const FVector& StartLocation, const FVector& EndLocation
-	, ECollisionChannel TraceChannel, bool bAppendToList)
+void ATransformerPawn::ServerUndo_Implementation()
 {
-	bool bTraceSuccessful = TraceByChannel(StartLocation, EndLocation, TraceChannel
-		, GetIgnoredActorsForServerTrace(), bAppendToList);
+	RecordReceivedRpc(TEXT("ServerUndo"), 0, !IsLocallyControlled());
 
-	if (!bTraceSuccessful && !bAppendToList)
-		//check whether trace was successful and we're not doing multi selection
-		DeselectAll(false);
-
-	MulticastSetDomain(CurrentDomain);
-	MulticastSetSelectedComponents(SelectedComponents);
+	ScheduleServerEdit(TEXT("ServerUndo"), true, [this]()
+		{
+			ApplyUndoEntry(true);
+		});
 }
 
-
-
-bool ATransformerPawn::ServerTraceByProfile_Validate(const FVector& StartLocation
-	, const FVector& EndLocation, const FName& ProfileName, bool bAppendToList) 
-{ 
-	return true; 
+bool ATransformerPawn::ServerRedo_Validate()
+{
+	return true;
 }
 
-
-void ATransformerPawn::ServerTraceByProfile_Implementation(
-	const FVector& StartLocation, const FVector& EndLocation
-	, const FName& ProfileName, bool bAppendToList)
+void ATransformerPawn::ServerRedo_Implementation()
 {
-	bool bTraceSuccessful = TraceByProfile(StartLocation, EndLocation, ProfileName
-		, GetIgnoredActorsForServerTrace(), bAppendToList);
-
-	if (!bTraceSuccessful && !bAppendToList) 
-		//check whether trace was successful and we're not doing multi selection
-		DeselectAll(false); 
+	RecordReceivedRpc(TEXT("ServerRedo"), 0, !IsLocallyControlled());
 
-	MulticastSetDomain(CurrentDomain);
-	MulticastSetSelectedComponents(SelectedComponents);
+	ScheduleServerEdit(TEXT("ServerRedo"), true, [this]()
+		{
+			ApplyUndoEntry(false);
+		});
 }
 
-bool ATransformerPawn::ServerClearDomain_Validate() 
-{ 
-	return true; 
-}
-void ATransformerPawn::ServerClearDomain_Implementation()
+bool ATransformerPawn::ServerDropSelectionToGround_Validate(bool bAlignToNormal)
 {
-	MulticastClearDomain();
+	return true;
 }
 
-void ATransformerPawn::MulticastClearDomain_Implementation()
+void ATransformerPawn::ServerDropSelectionToGround_Implementation(bool bAlignToNormal)
 {
-	ClearDomain();
+	RecordReceivedRpc(TEXT("ServerDropSelectionToGround"), 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerDropSelectionToGround"), true, [this, bAlignToNormal]()
+		{
+			BeginDropToGround(bAlignToNormal);
+		});
 }
 
-bool ATransformerPawn::ServerApplyTransform_Validate(const FTransform& DeltaTransform)
+bool ATransformerPawn::ServerAlignSelection_Validate(ETransformationDomain Axes, ESelectionAlignment Alignment, bool bUseBounds)
 {
 	return true;
 }
-void ATransformerPawn::ServerApplyTransform_Implementation(const FTransform& DeltaTransform)
+
+void ATransformerPawn::ServerAlignSelection_Implementation(ETransformationDomain Axes, ESelectionAlignment Alignment, bool bUseBounds)
 {
-	MulticastApplyTransform(DeltaTransform);
+	RecordReceivedRpc(TEXT("ServerAlignSelection"), 3, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerAlignSelection"), true, [this, Axes, Alignment, bUseBounds]()
+		{
+			AlignSelection(Axes, Alignment, bUseBounds);
+		});
 }
 
-void ATransformerPawn::MulticastApplyTransform_Implementation(const FTransform& DeltaTransform)
+bool ATransformerPawn::ServerDistributeSelection_Validate(ETransformationDomain Axes, bool bUseBounds)
 {
-	if (Controller && !Controller->IsLocalController()) //only apply to others
-		ApplyDeltaTransform(DeltaTransform);
+	return true;
 }
 
-
-void ATransformerPawn::ReplicateFinishTransform()
+void ATransformerPawn::ServerDistributeSelection_Implementation(ETransformationDomain Axes, bool bUseBounds)
 {
-	ServerClearDomain();
-	ServerApplyTransform(NetworkDeltaTransform);
-	ResetDeltaTransform(NetworkDeltaTransform);
-}
+	RecordReceivedRpc(TEXT("ServerDistributeSelection"), 2, !IsLocallyControlled());
 
-bool ATransformerPawn::ServerDeselectAll_Validate(bool bDestroySelected) 
-{ 
-	return true; 
+	ScheduleServerEdit(TEXT("ServerDistributeSelection"), true, [this, Axes, bUseBounds]()
+		{
+			DistributeSelection(Axes, bUseBounds);
+		});
 }
-void ATransformerPawn::ServerDeselectAll_Implementation(bool bDestroySelected)
+
+bool ATransformerPawn::ServerRandomizeSelection_Validate(FRotator RotationJitter, float ScaleJitter, int32 Seed)
 {
-	MulticastDeselectAll(bDestroySelected);
+	return true;
 }
 
-void ATransformerPawn::MulticastDeselectAll_Implementation(bool bDestroySelected)
+void ATransformerPawn::ServerRandomizeSelection_Implementation(FRotator RotationJitter, float ScaleJitter, int32 Seed)
 {
-	DeselectAll(bDestroySelected);
+	RecordReceivedRpc(TEXT("ServerRandomizeSelection"), FTransformerNetStats::EstimateTransform(), !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerRandomizeSelection"), true, [this, RotationJitter, ScaleJitter, Seed]()
+		{
+			RandomizeSelection(RotationJitter, ScaleJitter, Seed);
+		});
 }
 
 bool ATransformerPawn::ServerSetSpaceType_Validate(ESpaceType Space) 
@@ -1235,11 +3957,17 @@ bool ATransformerPawn::ServerSetSpaceType_Validate(ESpaceType Space)
 }
 void ATransformerPawn::ServerSetSpaceType_Implementation(ESpaceType Space)
 {
-	MulticastSetSpaceType(Space);
+	RecordReceivedRpc(TEXT("ServerSetSpaceType"), 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerSetSpaceType"), false, [this, Space]()
+		{
+			MulticastSetSpaceType(Space);
+		});
 }
 
 void ATransformerPawn::MulticastSetSpaceType_Implementation(ESpaceType Space)
 {
+	RecordReceivedRpc(TEXT("MulticastSetSpaceType"), 1, GetLocalRole() < ROLE_Authority);
 	SetSpaceType(Space);
 }
 
@@ -1250,11 +3978,17 @@ bool ATransformerPawn::ServerSetTransformationType_Validate(ETransformationType
 }
 void ATransformerPawn::ServerSetTransformationType_Implementation(ETransformationType Transformation)
 {
-	MulticastSetTransformationType(Transformation);
+	RecordReceivedRpc(TEXT("ServerSetTransformationType"), 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerSetTransformationType"), false, [this, Transformation]()
+		{
+			MulticastSetTransformationType(Transformation);
+		});
 }
 
 void ATransformerPawn::MulticastSetTransformationType_Implementation(ETransformationType Transformation)
 {
+	RecordReceivedRpc(TEXT("MulticastSetTransformationType"), 1, GetLocalRole() < ROLE_Authority);
 	SetTransformationType(Transformation);
 }
 
@@ -1264,11 +3998,17 @@ bool ATransformerPawn::ServerSetComponentBased_Validate(bool bIsComponentBased)
 }
 void ATransformerPawn::ServerSetComponentBased_Implementation(bool bIsComponentBased)
 {
-	MulticastSetComponentBased(bIsComponentBased);
+	RecordReceivedRpc(TEXT("ServerSetComponentBased"), 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerSetComponentBased"), false, [this, bIsComponentBased]()
+		{
+			MulticastSetComponentBased(bIsComponentBased);
+		});
 }
 
 void ATransformerPawn::MulticastSetComponentBased_Implementation(bool bIsComponentBased)
 {
+	RecordReceivedRpc(TEXT("MulticastSetComponentBased"), 1, GetLocalRole() < ROLE_Authority);
 	SetComponentBased(bIsComponentBased);
 }
 
@@ -1278,82 +4018,282 @@ bool ATransformerPawn::ServerSetRotateOnLocalAxis_Validate(bool bRotateLocalAxis
 }
 void ATransformerPawn::ServerSetRotateOnLocalAxis_Implementation(bool bRotateLocalAxis)
 {
-	MulticastSetRotateOnLocalAxis(bRotateLocalAxis);
+	RecordReceivedRpc(TEXT("ServerSetRotateOnLocalAxis"), 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerSetRotateOnLocalAxis"), false, [this, bRotateLocalAxis]()
+		{
+			MulticastSetRotateOnLocalAxis(bRotateLocalAxis);
+		});
 }
 
 void ATransformerPawn::MulticastSetRotateOnLocalAxis_Implementation(bool bRotateLocalAxis)
 {
+	RecordReceivedRpc(TEXT("MulticastSetRotateOnLocalAxis"), 1, GetLocalRole() < ROLE_Authority);
 	SetRotateOnLocalAxis(bRotateLocalAxis);
 }
 
-#include "TimerManager.h"
 bool ATransformerPawn::ServerCloneSelected_Validate(bool bSelectNewClones, bool bAppendToList)
 {
 	return true;
 }
+//Id for a Clone made through ServerCloneSelected. Unique in the Server's World
+static int32 MakeCloneId(const UObject* WorldContextObject)
+{
+	UTransformerCloneIds* cloneIds = UTransformerCloneIds::Get(WorldContextObject);
+	return cloneIds ? cloneIds->MakeCloneId() : INDEX_NONE;
+}
+
+//Name given to Component Clones, so that the Server and the Clients name them the same
+static FName GetNetworkCloneName(const USceneComponent* TemplateComponent, int32 CloneId)
+{
+	return FName(*FString::Printf(TEXT("%s_RTClone_%d")
+		, *TemplateComponent->GetClass()->GetName(), CloneId));
+}
+
 void ATransformerPawn::ServerCloneSelected_Implementation(bool bSelectNewClones
 	, bool bAppendToList)
 {
+	RecordReceivedRpc(TEXT("ServerCloneSelected"), 1, !IsLocallyControlled());
+
+	//What gets cloned is decided when the command runs, since previously queued commands can change the Selection
+	TSharedRef<FServerCloneJob> job = MakeShared<FServerCloneJob>();
+	job->bSelectNewClones = bSelectNewClones;
+	job->bAppendToList = bAppendToList;
+
+	ScheduleServerEditSteps(TEXT("ServerCloneSelected"), [this, job](double Deadline)
+		{
+			return ServerCloneStep(*job, Deadline);
+		});
+}
+
+bool ATransformerPawn::ServerCloneStep(FServerCloneJob& Job, double Deadline)
+{
+	FTransformerCloneCommand command;
+	command.bComponentBased = bComponentBased;
+	command.bSelectNewClones = Job.bSelectNewClones;
+	command.bAppendToList = Job.bAppendToList;
+	command.RequestId = LatestSelectionRequestId;
+
+	TArray<USceneComponent*> CloneList;
+	bool bFinished = true;
 	if (bComponentBased)
 	{
-		UE_LOG(LogRuntimeTransformer, Warning, TEXT("** Component Cloning is currently not supported in a Network Environment :( **"));
-		// see PluginLimitations.txt for a reason why Component Cloning is not supported
-		return;
+		//Components are cloned all at once, as the reparenting needs every clone of the hierarchy
+		TArray<FName> cloneNames;
+		for (auto& c : SelectedComponents)
+		{
+			if (!c || !c->GetOwner()) continue;
+			const int32 cloneId = MakeCloneId(this);
+			command.TemplateComponents.Add(c);
+			command.CloneIds.Add(cloneId);
+			cloneNames.Add(GetNetworkCloneName(c, cloneId));
+		}
+
+		CloneList = CloneComponents(command.TemplateComponents, &cloneNames);
+		if (CloneList.Num() != command.Num())
+		{
+			//Entries would not line up anymore. Clients will get the clones through a Selection Resync
+			UE_LOG(LogRuntimeTransformer, Warning, TEXT("Only %d of %d Components were cloned. No Clone Command sent")
+				, CloneList.Num(), command.Num());
+			command = FTransformerCloneCommand();
+		}
+		else
+		{
+			for (auto& clone : CloneList)
+				command.Transforms.Add(clone->GetComponentTransform());
+		}
 	}
+	else
+	{
+		if (!Job.bStarted)
+		{
+			TSet<AActor*> actorsProcessed;
+			for (auto& c : SelectedComponents)
+			{
+				AActor* templateActor = c ? c->GetOwner() : nullptr;
+				if (!templateActor) continue;
+				bool bAlreadyProcessed;
+				actorsProcessed.Add(templateActor, &bAlreadyProcessed);
+				if (!bAlreadyProcessed)
+					Job.TemplateActors.Add(templateActor);
+			}
+		}
 
-	auto ComponentListCopy = GetSelectedComponents();
+		//As many Actors as the budget allows (at least one). The rest are cloned in the next steps
+		while (Job.NextTemplate < Job.TemplateActors.Num())
+		{
+			AActor* templateActor = Job.TemplateActors[Job.NextTemplate++].Get();
+			AActor* clone = CloneActor(templateActor);
+			if (clone && clone->GetRootComponent())
+			{
+				const int32 cloneId = MakeCloneId(this);
+				command.TemplateActors.Add(templateActor);
+				command.Transforms.Add(clone->GetActorTransform());
+				command.CloneIds.Add(cloneId);
 
-	//just create 'em, not select 'em (we select 'em later)
-	auto CloneList = CloneFromList(ComponentListCopy);
+				//Lets the clients swap their local clone for this one once it's replicated
+				if (clone->GetIsReplicated())
+					UTransformerCloneIdComponent::AddTo(clone, cloneId);
 
-	//if we have to select the new clones, multicast for these new objects
-	if (bSelectNewClones)
-	{
-		SelectMultipleComponents(CloneList, bAppendToList);
-		UnreplicatedComponentClones = CloneList;
+				CloneList.Add(clone->GetRootComponent());
+			}
 
-		//Timer to loop until all Unreplicated Actors have finished replicating!
-		if (UWorld* world = GetWorld())
-		{
-			if (!CheckUnrepTimerHandle.IsValid())
-				world->GetTimerManager().SetTimer(CheckUnrepTimerHandle, this
-					, &ATransformerPawn::CheckUnreplicatedActors
-					, CloneReplicationCheckFrequency, true, 0.0f);
+			if (FPlatformTime::Seconds() >= Deadline)
+				break;
 		}
+		bFinished = (Job.NextTemplate >= Job.TemplateActors.Num());
+	}
+	Job.bStarted = true;
+
+	if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
+		Gizmo->SetTransformProgressState(true, CurrentDomain);
+
+	if (Job.bSelectNewClones)
+		SelectMultipleComponents(CloneList, Job.bAppendToList);
+
+	if (command.Num() > 0)
+		MulticastCloneCommand(command);
+	else if (Job.bSelectNewClones)
+		MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+
+	//the clones of the next steps are added to the ones of this step
+	Job.bAppendToList = true;
+	return bFinished;
+}
+
+void ATransformerPawn::MulticastCloneCommand_Implementation(const FTransformerCloneCommand& Command)
+{
+	RecordReceivedRpc(TEXT("MulticastCloneCommand")
+		, FTransformerNetStats::EstimateObjectArray(Command.Num())
+			+ Command.Num() * (FTransformerNetStats::EstimateTransform() + 4) + 7
+		, GetLocalRole() < ROLE_Authority);
+
+	//The Server has already made (and selected) its clones
+	if (GetLocalRole() == ROLE_Authority) return;
+
+	TArray<USceneComponent*> clones = ExecuteCloneCommand(Command);
+
+	if (Command.bSelectNewClones)
+	{
+		//The owning client has predicted a newer selection than the one the clones were made in
+		const bool bOwningClient = IsLocallyControlled();
+		if (!bOwningClient || Command.RequestId >= LatestSelectionRequestId)
+			SelectMultipleComponents(clones, Command.bAppendToList);
+
+		//Some template could not be resolved here (e.g. it's a clone that has not arrived yet)
+		bResyncSelection = (clones.Num() != Command.Num());
+		if (bResyncSelection)
+			StartSelectionResync();
 	}
 }
 
-void ATransformerPawn::CheckUnreplicatedActors()
+TArray<USceneComponent*> ATransformerPawn::ExecuteCloneCommand(const FTransformerCloneCommand& Command)
 {
+	TArray<USceneComponent*> outClones;
+	if (Command.Transforms.Num() != Command.Num()) return outClones;
+
+	if (Command.bComponentBased)
+	{
+		if (Command.TemplateComponents.Num() != Command.Num()) return outClones;
+
+		TArray<USceneComponent*> templates;
+		TArray<FName> cloneNames;
+		TArray<FTransform> transforms;
+		for (int32 i = 0; i < Command.Num(); ++i)
+		{
+			USceneComponent* templateComponent = Command.TemplateComponents[i];
+			if (!templateComponent || !templateComponent->GetOwner()) continue;
+			templates.Add(templateComponent);
+			cloneNames.Add(GetNetworkCloneName(templateComponent, Command.CloneIds[i]));
+			transforms.Add(Command.Transforms[i]);
+		}
 
-	int32 RemoveCount = 0;
-	float timeElapsed = GetWorldTimerManager().GetTimerElapsed(CheckUnrepTimerHandle);
-	for (auto& c : UnreplicatedComponentClones)
+		outClones = CloneComponents(templates, &cloneNames);
+		for (int32 i = 0; i < outClones.Num() && i < transforms.Num(); ++i)
+			outClones[i]->SetWorldTransform(transforms[i]);
+	}
+	else
 	{
-		// rather than calling "IsSupportedForNetworking" (which returns true all the time)
-		// call HasActorBegunPlay (which means we are sure the BeginPlay for AActor has finished completely.
-		// and so we can safely send this reference over the network.
-		if (c && c->HasBegunPlay() && c->IsSupportedForNetworking() &&
-			timeElapsed > MinimumCloneReplicationTime) // Make sure there's a minimum time...
-			++RemoveCount;
+		if (Command.TemplateActors.Num() != Command.Num()) return outClones;
+
+		for (int32 i = 0; i < Command.Num(); ++i)
+		{
+			AActor* templateActor = Command.TemplateActors[i];
+			const int32 cloneId = Command.CloneIds[i];
+
+			//The Server's clone might have been replicated before this Command arrived
+			AActor* clone = UTransformerCloneIdComponent::ConsumeArrivedClone(this, cloneId);
+			if (!clone && templateActor)
+			{
+				clone = CloneActor(templateActor);
+				if (clone)
+				{
+					clone->SetActorTransform(Command.Transforms[i]);
+					//Non Replicated templates make Non Replicated clones: the local clone is the only one there will be
+					if (templateActor->GetIsReplicated())
+						LocalCloneProxies.Add(cloneId, clone);
+				}
+			}
+
+			if (clone && clone->GetRootComponent())
+				outClones.Add(clone->GetRootComponent());
+		}
 	}
 
-	// Remove with performance (Swapping). We don't care about the order in this case
-	// since the role of this is to check that all unreplicated components have been replicated.
-	UnreplicatedComponentClones.RemoveAtSwap(0, RemoveCount);
+	if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
+		Gizmo->SetTransformProgressState(true, CurrentDomain);
+
+	return outClones;
+}
+
+bool ATransformerPawn::BindCloneProxy(int32 CloneId, AActor* Clone)
+{
+	TWeakObjectPtr<AActor> proxy;
+	if (!LocalCloneProxies.RemoveAndCopyValue(CloneId, proxy))
+		return false;
+
+	AActor* proxyActor = proxy.Get();
+	if (!proxyActor) return true; //local clone was already destroyed (e.g. DeselectAll(true))
+
+	USceneComponent* proxyRoot = proxyActor->GetRootComponent();
+	USceneComponent* cloneRoot = Clone ? Clone->GetRootComponent() : nullptr;
 
-	// check if all clones have been replicated
-	if (UnreplicatedComponentClones.Num() == 0)
+	const int32 index = SelectedComponents.Find(proxyRoot);
+	if (index != INDEX_NONE)
 	{
-		//stop calling this if no more unreplicated actors
-		GetWorldTimerManager().ClearTimer(CheckUnrepTimerHandle);
+		//Swap in place so that the Selection order (and Gizmo Placement) stays the same
+		bool bImplementsInterface;
+		Deselect(proxyRoot, &bImplementsInterface);
+		OnComponentSelectionChange(proxyRoot, false, bImplementsInterface);
+		SelectionBounds.Remove(proxyRoot);
+
+		if (cloneRoot && !SelectedComponents.Contains(cloneRoot))
+		{
+			SelectedComponents[index] = cloneRoot;
+			if (IsGizmoOnSelectionCenter())
+				SelectionBounds.Add(cloneRoot);
+			Select(cloneRoot, &bImplementsInterface);
+			OnComponentSelectionChange(cloneRoot, true, bImplementsInterface);
+		}
+		else
+			SelectedComponents.RemoveAt(index);
 
-		UE_LOG(LogRuntimeTransformer, Log, TEXT("[SERVER] Time Elapsed for %d Replicated Actors to replicate: %f")
-			, SelectedComponents.Num(), timeElapsed);
+		UpdateGizmoPlacement();
+	}
 
-		//send all the selected replicated actors!
-		MulticastSetSelectedComponents(SelectedComponents);
+	proxyActor->Destroy();
+	return true;
+}
 
+void ATransformerPawn::StartSelectionResync()
+{
+	//Timer to loop until all Unreplicated Actors have finished replicating!
+	if (UWorld* world = GetWorld())
+	{
+		if (!ResyncSelectionTimerHandle.IsValid())
+			world->GetTimerManager().SetTimer(ResyncSelectionTimerHandle, this
+				, &ATransformerPawn::ResyncSelection
+				, 0.1f, true, 0.0f);
 	}
 }
 
@@ -1363,11 +4303,17 @@ bool ATransformerPawn::ServerSetDomain_Validate(ETransformationDomain Domain)
 }
 void ATransformerPawn::ServerSetDomain_Implementation(ETransformationDomain Domain)
 {
-	MulticastSetDomain(Domain);
+	RecordReceivedRpc(TEXT("ServerSetDomain"), 1, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerSetDomain"), false, [this, Domain]()
+		{
+			MulticastSetDomain(Domain);
+		});
 }
 
 void ATransformerPawn::MulticastSetDomain_Implementation(ETransformationDomain Domain)
 {
+	RecordReceivedRpc(TEXT("MulticastSetDomain"), 1, GetLocalRole() < ROLE_Authority);
 	SetDomain(Domain);
 }
 
@@ -1377,43 +4323,63 @@ bool ATransformerPawn::ServerSyncSelectedComponents_Validate()
 }
 void ATransformerPawn::ServerSyncSelectedComponents_Implementation()
 {
-	MulticastSetSelectedComponents(SelectedComponents);
+	RecordReceivedRpc(TEXT("ServerSyncSelectedComponents"), 0, !IsLocallyControlled());
+
+	ScheduleServerEdit(TEXT("ServerSyncSelectedComponents"), false, [this]()
+		{
+			MulticastSetSelectedComponents(SelectedComponents, LatestSelectionRequestId);
+		});
 }
 
 void ATransformerPawn::MulticastSetSelectedComponents_Implementation(
-	const TArray<USceneComponent*>& Components)
+	const TArray<USceneComponent*>& Components, int32 RequestId)
 {
+	RecordReceivedRpc(TEXT("MulticastSetSelectedComponents")
+		, FTransformerNetStats::EstimateObjectArray(Components.Num()) + 4, GetLocalRole() < ROLE_Authority);
+
 	if (GetLocalRole() < ROLE_Authority)
     {
         UE_LOG(LogRuntimeTransformer, Log, TEXT("MulticastSelect ComponentCount: %d"), Components.Num());
     }
-		
 
-	DeselectAll(); //calling here because Selecting MultipleComponents empty is not going to call Deselect all
-	SelectMultipleComponents(Components, true);
+	//The owning client has predicted a newer selection than the one this reply is for.
+	// A newer reply is on its way, so reconciling against this one would only cause a rollback & redo
+	const bool bOwningClient = IsLocallyControlled() && GetLocalRole() < ROLE_Authority;
+	if (bOwningClient && RequestId < LatestSelectionRequestId)
+		return;
+
+	//Only what differs from the Server is deselected / selected (no full DeselectAll / Reselect cycle)
+	const bool bMispredicted = ReconcileSelection(Components);
 
-	//Tells whether we have Selected the exact number of components that came in 
+	if (bOwningClient && bMispredicted)
+	{
+		UE_LOG(LogRuntimeTransformer, Log, TEXT("Selection Request [%d] mispredicted. Rolled back to the Server Selection"), RequestId);
+#if RUNTIMETRANSFORMER_NET_STATS
+		FTransformerNetStats::Get().RecordSelectionRollback();
+#endif
+	}
+
+	//Tells whether we have Selected the exact number of components that came in
 	// or there was a nullptr in Components and therefore there is a difference.
 	// if there is a difference we will need to resync
 	bResyncSelection = (Components.Num() != SelectedComponents.Num());
 	if (bResyncSelection)
-	{
-		//Timer to loop until all Unreplicated Actors have finished replicating!
-		if (UWorld* world = GetWorld())
-		{
-			if (!ResyncSelectionTimerHandle.IsValid())
-				world->GetTimerManager().SetTimer(ResyncSelectionTimerHandle, this
-					, &ATransformerPawn::ResyncSelection
-					, 0.1f, true, 0.0f);
-		}
-	}
-	
+		StartSelectionResync();
+
 
 	if (GetLocalRole() < ROLE_Authority)
     {
         UE_LOG(LogRuntimeTransformer, Log, TEXT("Selected ComponentCount: %d"), SelectedComponents.Num());
     }
-		
+
+	//Time taken for a Server Trace requested by this client to come back
+	if (ServerRequestTime > 0.0 && bOwningClient)
+	{
+#if RUNTIMETRANSFORMER_NET_STATS
+		FTransformerNetStats::Get().RecordConvergence(FPlatformTime::Seconds() - ServerRequestTime);
+#endif
+		ServerRequestTime = 0.0;
+	}
 }
 
 void ATransformerPawn::ResyncSelection()
@@ -1421,6 +4387,9 @@ void ATransformerPawn::ResyncSelection()
 	if (bResyncSelection)
 	{
         UE_LOG(LogRuntimeTransformer,Warning, TEXT("Resyncing Selection"));
+#if RUNTIMETRANSFORMER_NET_STATS
+		FTransformerNetStats::Get().RecordResync();
+#endif
 		ServerSyncSelectedComponents();
 	}
 	else
@@ -1431,4 +4400,10 @@ void ATransformerPawn::ResyncSelection()
 	}
 }
 
+void ATransformerPawn::ApplyReplicatedSelection(const TArray<USceneComponent*>& Components)
+{
+	if (GetLocalRole() == ROLE_Authority) return;
+	ReconcileSelection(Components);
+}
+
 #undef RTT_LOG
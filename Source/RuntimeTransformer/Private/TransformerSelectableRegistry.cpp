@@ -0,0 +1,399 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerSelectableRegistry.h"
+#include "TransformerActorPool.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "EngineUtils.h"
+#include "Math/VectorRegister.h"
+
+//32 bit words in a 128 bit vector
+static const int32 WordsPerVector = 4;
+
+//Number of words (a multiple of WordsPerVector) needed for the id
+static int32 GetWordCount(int32 Id)
+{
+	return Align(Id / 32 + 1, WordsPerVector);
+}
+
+void FTransformerSelectionSet::Add(int32 Id)
+{
+	if (Id < 0) return;
+	const int32 wordCount = GetWordCount(Id);
+	if (Words.Num() < wordCount)
+		Words.SetNumZeroed(wordCount);
+	Words[Id / 32] |= 1u << (Id % 32);
+}
+
+void FTransformerSelectionSet::Remove(int32 Id)
+{
+	if (Id >= 0 && Id / 32 < Words.Num())
+		Words[Id / 32] &= ~(1u << (Id % 32));
+}
+
+bool FTransformerSelectionSet::Contains(int32 Id) const
+{
+	return Id >= 0 && Id / 32 < Words.Num() && (Words[Id / 32] & (1u << (Id % 32))) != 0;
+}
+
+int32 FTransformerSelectionSet::Num() const
+{
+	int32 count = 0;
+	for (uint32 word : Words)
+		count += (int32)FMath::CountBits(word);
+	return count;
+}
+
+bool FTransformerSelectionSet::IsEmpty() const
+{
+	for (uint32 word : Words)
+	{
+		if (word != 0) return false;
+	}
+	return true;
+}
+
+void FTransformerSelectionSet::Union(const FTransformerSelectionSet& Other)
+{
+	if (Words.Num() < Other.Words.Num())
+		Words.SetNumZeroed(Other.Words.Num());
+
+	uint32* words = Words.GetData();
+	const uint32* otherWords = Other.Words.GetData();
+	for (int32 i = 0; i < Other.Words.Num(); i += WordsPerVector)
+	{
+		const VectorRegister4Int result = VectorIntOr(VectorIntLoadAligned(words + i), VectorIntLoadAligned(otherWords + i));
+		VectorIntStoreAligned(result, words + i);
+	}
+}
+
+void FTransformerSelectionSet::Intersect(const FTransformerSelectionSet& Other)
+{
+	//nothing past the end of Other is left
+	if (Words.Num() > Other.Words.Num())
+		Words.SetNum(Other.Words.Num());
+
+	uint32* words = Words.GetData();
+	const uint32* otherWords = Other.Words.GetData();
+	for (int32 i = 0; i < Words.Num(); i += WordsPerVector)
+	{
+		const VectorRegister4Int result = VectorIntAnd(VectorIntLoadAligned(words + i), VectorIntLoadAligned(otherWords + i));
+		VectorIntStoreAligned(result, words + i);
+	}
+}
+
+void FTransformerSelectionSet::Subtract(const FTransformerSelectionSet& Other)
+{
+	uint32* words = Words.GetData();
+	const uint32* otherWords = Other.Words.GetData();
+	const int32 count = FMath::Min(Words.Num(), Other.Words.Num());
+	for (int32 i = 0; i < count; i += WordsPerVector)
+	{
+		//VectorIntAndNot(A, B) is ~A & B
+		const VectorRegister4Int result = VectorIntAndNot(VectorIntLoadAligned(otherWords + i), VectorIntLoadAligned(words + i));
+		VectorIntStoreAligned(result, words + i);
+	}
+}
+
+UTransformerSelectableRegistry* UTransformerSelectableRegistry::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerSelectableRegistry>() : nullptr;
+}
+
+bool UTransformerSelectableRegistry::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerSelectableRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	if (UWorld* world = GetWorld())
+	{
+		ActorSpawnedHandle = world->AddOnActorSpawnedHandler(
+			FOnActorSpawned::FDelegate::CreateUObject(this, &UTransformerSelectableRegistry::OnActorSpawned));
+		ActorDestroyedHandle = world->AddOnActorDestroyedHandler(
+			FOnActorDestroyed::FDelegate::CreateUObject(this, &UTransformerSelectableRegistry::OnActorDestroyed));
+	}
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UTransformerSelectableRegistry::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UTransformerSelectableRegistry::OnLevelRemoved);
+}
+
+void UTransformerSelectableRegistry::Deinitialize()
+{
+	if (UWorld* world = GetWorld())
+	{
+		world->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		world->RemoveOnActorDestroyedHandler(ActorDestroyedHandle);
+	}
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Components.Reset();
+	Ids.Reset();
+	FreeIds.Reset();
+	PruneSize = 1024;
+	NamedSets.Reset();
+	Super::Deinitialize();
+}
+
+void UTransformerSelectableRegistry::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	for (TActorIterator<AActor> it(&InWorld); it; ++it)
+		RegisterActor(*it);
+}
+
+void UTransformerSelectableRegistry::OnActorSpawned(AActor* Actor)
+{
+	RegisterActor(Actor);
+}
+
+void UTransformerSelectableRegistry::OnActorDestroyed(AActor* Actor)
+{
+	UnregisterActor(Actor);
+}
+
+void UTransformerSelectableRegistry::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	//streamed in Sublevels and World Partition cells (their Actors aren't spawned, so OnActorSpawned misses them)
+	if (!Level || World != GetWorld()) return;
+	for (AActor* actor : Level->Actors)
+		RegisterActor(actor);
+}
+
+void UTransformerSelectableRegistry::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	//streamed out Actors aren't destroyed through the World, so their ids would never be freed otherwise
+	if (!Level || World != GetWorld()) return;
+	for (AActor* actor : Level->Actors)
+		UnregisterActor(actor);
+}
+
+void UTransformerSelectableRegistry::RegisterActor(AActor* Actor)
+{
+	if (!Actor) return;
+	Actor->ForEachComponent<USceneComponent>(false, [this](USceneComponent* Component)
+		{
+			Register(Component);
+		});
+}
+
+void UTransformerSelectableRegistry::UnregisterActor(AActor* Actor)
+{
+	if (!Actor) return;
+	Actor->ForEachComponent<USceneComponent>(false, [this](USceneComponent* Component)
+		{
+			Unregister(Component);
+		});
+}
+
+int32 UTransformerSelectableRegistry::Register(USceneComponent* Component)
+{
+	if (!Component) return INDEX_NONE;
+
+	const FObjectKey key(Component);
+	if (const int32* id = Ids.Find(key))
+		return *id;
+
+	//free the ids of the Components destroyed on their own, every time the list doubles
+	if (FreeIds.Num() == 0 && Components.Num() >= PruneSize)
+	{
+		for (auto it = Ids.CreateIterator(); it; ++it)
+		{
+			if (Components[it->Value].IsValid()) continue;
+			FreeId(it->Value);
+			it.RemoveCurrent();
+		}
+		PruneSize = FMath::Max(1024, (Components.Num() - FreeIds.Num()) * 2);
+	}
+
+	int32 id;
+	if (FreeIds.Num() > 0)
+	{
+		id = FreeIds.Pop(false);
+		Components[id] = Component;
+	}
+	else
+		id = Components.Add(Component);
+
+	Ids.Add(key, id);
+	return id;
+}
+
+void UTransformerSelectableRegistry::Unregister(USceneComponent* Component)
+{
+	int32 id;
+	if (Ids.RemoveAndCopyValue(FObjectKey(Component), id))
+		FreeId(id);
+}
+
+void UTransformerSelectableRegistry::FreeId(int32 Id)
+{
+	//so that the next Component given this id isn't in them
+	for (auto& it : NamedSets)
+		it.Value.Remove(Id);
+
+	Components[Id].Reset();
+	FreeIds.Add(Id);
+}
+
+int32 UTransformerSelectableRegistry::GetId(const USceneComponent* Component) const
+{
+	const int32* id = Component ? Ids.Find(FObjectKey(Component)) : nullptr;
+	return id ? *id : INDEX_NONE;
+}
+
+USceneComponent* UTransformerSelectableRegistry::GetComponent(int32 Id) const
+{
+	return Components.IsValidIndex(Id) ? Components[Id].Get() : nullptr;
+}
+
+FTransformerSelectionSet UTransformerSelectableRegistry::MakeSet(const TArray<USceneComponent*>& InComponents)
+{
+	FTransformerSelectionSet set;
+	for (USceneComponent* component : InComponents)
+		set.Add(Register(component));
+	return set;
+}
+
+void UTransformerSelectableRegistry::GetSetComponents(const FTransformerSelectionSet& Set
+	, TArray<USceneComponent*>& OutComponents) const
+{
+	Set.ForEach([this, &OutComponents](int32 Id)
+		{
+			if (USceneComponent* component = GetComponent(Id))
+				OutComponents.Add(component);
+		});
+}
+
+void UTransformerSelectableRegistry::SaveSelectionSet(FName Name, const FTransformerSelectionSet& Set)
+{
+	NamedSets.Add(Name, Set);
+}
+
+void UTransformerSelectableRegistry::SaveComponentsAsSelectionSet(FName Name, const TArray<USceneComponent*>& InComponents)
+{
+	NamedSets.Add(Name, MakeSet(InComponents));
+}
+
+void UTransformerSelectableRegistry::RunQuery(const FTransformerSelectionQuery& Query
+	, TFunction<void(TArray<TWeakObjectPtr<USceneComponent>>&&)>&& OnFinished) const
+{
+	//the snapshot the workers match against. Candidates whose Classes don't match are left out of it
+	TArray<FTransformerSelectionQueryCandidate> candidates;
+	candidates.Reserve(Ids.Num());
+	TMap<TPair<const UClass*, const UClass*>, bool> classMatches;
+	const UTransformerActorPool* actorPool = UTransformerActorPool::Get(this);
+	for (const TWeakObjectPtr<USceneComponent>& componentPtr : Components)
+	{
+		USceneComponent* component = componentPtr.Get();
+		if (!component || !component->IsRegistered()) continue;
+
+		//soft deleted (hidden, waiting to be destroyed or restored by an Undo)
+		const AActor* owner = component->GetOwner();
+		if (owner && actorPool && actorPool->IsParked(owner)) continue;
+
+		//left out here rather than in the workers so that no snapshot is taken of them
+		const bool bIsRoot = owner && owner->GetRootComponent() == component;
+		if (Query.bRootComponentsOnly && !bIsRoot) continue;
+
+		const TPair<const UClass*, const UClass*> classes(owner ? owner->GetClass() : nullptr, component->GetClass());
+		const bool* bClassesMatch = classMatches.Find(classes);
+		if (!bClassesMatch)
+			bClassesMatch = &classMatches.Add(classes, Query.MatchesClasses(classes.Key, classes.Value));
+		if (!*bClassesMatch) continue;
+
+		FTransformerSelectionQueryCandidate& candidate = candidates.AddDefaulted_GetRef();
+		candidate.Component = component;
+		candidate.ActorClass = classes.Key;
+		candidate.ComponentClass = classes.Value;
+		candidate.Location = component->GetComponentLocation();
+		candidate.Bounds = component->Bounds.GetBox();
+		candidate.bIsRoot = bIsRoot;
+		if (owner)
+			candidate.Tags.Append(owner->Tags);
+		candidate.Tags.Append(component->ComponentTags);
+	}
+
+	Async(EAsyncExecution::ThreadPool, [Query, candidates = MoveTemp(candidates), OnFinished = MoveTemp(OnFinished)]() mutable
+		{
+			TArray<uint8> bMatches;
+			bMatches.SetNumZeroed(candidates.Num());
+			ParallelFor(candidates.Num(), [&Query, &candidates, &bMatches](int32 i)
+				{
+					bMatches[i] = Query.Matches(candidates[i]);
+				});
+
+			TArray<TWeakObjectPtr<USceneComponent>> matches;
+			for (int32 i = 0; i < candidates.Num(); ++i)
+			{
+				if (bMatches[i])
+					matches.Add(candidates[i].Component);
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [matches = MoveTemp(matches), OnFinished = MoveTemp(OnFinished)]() mutable
+				{
+					OnFinished(MoveTemp(matches));
+				});
+		});
+}
+
+bool UTransformerSelectableRegistry::GetSelectionSetComponents(FName Name, TArray<USceneComponent*>& OutComponents) const
+{
+	OutComponents.Reset();
+	const FTransformerSelectionSet* set = NamedSets.Find(Name);
+	if (!set) return false;
+
+	OutComponents.Reserve(set->Num());
+	GetSetComponents(*set, OutComponents);
+	return true;
+}
+
+void UTransformerSelectableRegistry::CombineSelectionSets(FName Result, FName A, FName B, ESelectionSetOperation Operation)
+{
+	const FTransformerSelectionSet* a = NamedSets.Find(A);
+	const FTransformerSelectionSet* b = NamedSets.Find(B);
+
+	FTransformerSelectionSet result = a ? *a : FTransformerSelectionSet();
+	const FTransformerSelectionSet empty;
+	switch (Operation)
+	{
+	case ESelectionSetOperation::SSO_Union:
+		result.Union(b ? *b : empty);
+		break;
+	case ESelectionSetOperation::SSO_Intersection:
+		result.Intersect(b ? *b : empty);
+		break;
+	case ESelectionSetOperation::SSO_Difference:
+		result.Subtract(b ? *b : empty);
+		break;
+	}
+
+	//a and b may point into NamedSets, which adding can reallocate
+	NamedSets.Add(Result, MoveTemp(result));
+}
+
+bool UTransformerSelectableRegistry::RemoveSelectionSet(FName Name)
+{
+	return NamedSets.Remove(Name) > 0;
+}
+
+int32 UTransformerSelectableRegistry::GetSelectionSetNum(FName Name) const
+{
+	const FTransformerSelectionSet* set = NamedSets.Find(Name);
+	return set ? set->Num() : 0;
+}
+
+TArray<FName> UTransformerSelectableRegistry::GetSelectionSetNames() const
+{
+	TArray<FName> names;
+	NamedSets.GetKeys(names);
+	return names;
+}
@@ -0,0 +1,195 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerSelectionBounds.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SceneComponent.h"
+
+//Components per range of the parallel rebuild
+static const int32 SelectionBoundsRangeSize = 4096;
+
+FTransformerSelectionBounds::FTransformerSelectionBounds()
+	: LocationSum(FVector::ZeroVector)
+	, Bounds(ForceInit)
+	, bBoundsDirty(false)
+{
+}
+
+FBox FTransformerSelectionBounds::GetHierarchyBounds(const USceneComponent* Root, bool bQueryOnly)
+{
+	TArray<USceneComponent*> children;
+	Root->GetChildrenComponents(true, children);
+
+	FBox bounds(ForceInit);
+	auto addBounds = [&bounds, bQueryOnly](const USceneComponent* Component)
+		{
+			const UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(Component);
+			if (primitive && (!bQueryOnly || primitive->IsQueryCollisionEnabled()))
+				bounds += primitive->Bounds.GetBox();
+		};
+
+	addBounds(Root);
+	for (const USceneComponent* child : children)
+		addBounds(child);
+	return bounds;
+}
+
+void FTransformerSelectionBounds::Add(USceneComponent* Component)
+{
+	if (!Component || Indices.Contains(Component)) return;
+
+	const FVector location = Component->GetComponentLocation();
+	FBox bounds = GetHierarchyBounds(Component, false);
+	if (!bounds.IsValid)
+		bounds = FBox(location, location);
+
+	Indices.Add(Component, Components.Num());
+	Components.Add(Component);
+	Locations.Add(location);
+	ComponentBounds.Add(bounds);
+
+	LocationSum += location;
+	if (!bBoundsDirty)
+		Bounds += bounds;
+}
+
+void FTransformerSelectionBounds::Remove(USceneComponent* Component)
+{
+	int32 index;
+	if (!Indices.RemoveAndCopyValue(Component, index)) return;
+
+	Moved.Remove(Component);
+	LocationSum -= Locations[index];
+	if (!bBoundsDirty && IsOnEdge(ComponentBounds[index]))
+		bBoundsDirty = true;
+
+	//the last one takes its place
+	Components.RemoveAtSwap(index, 1, false);
+	Locations.RemoveAtSwap(index, 1, false);
+	ComponentBounds.RemoveAtSwap(index, 1, false);
+	if (Components.IsValidIndex(index))
+		Indices[Components[index]] = index;
+
+	if (Components.Num() == 0)
+		Reset();
+}
+
+void FTransformerSelectionBounds::MarkMoved(USceneComponent* Component)
+{
+	if (Component && Indices.Contains(Component))
+		Moved.Add(Component);
+}
+
+void FTransformerSelectionBounds::Reset()
+{
+	Components.Reset();
+	Locations.Reset();
+	ComponentBounds.Reset();
+	Indices.Reset();
+	Moved.Reset();
+	LocationSum = FVector::ZeroVector;
+	Bounds = FBox(ForceInit);
+	bBoundsDirty = false;
+}
+
+void FTransformerSelectionBounds::Reset(const TArray<USceneComponent*>& InComponents)
+{
+	Reset();
+
+	Indices.Reserve(InComponents.Num());
+	Components.Reserve(InComponents.Num());
+	for (USceneComponent* component : InComponents)
+	{
+		if (!component || Indices.Contains(component)) continue;
+		Indices.Add(component, Components.Num());
+		Components.Add(component);
+	}
+
+	//only read while the Game Thread waits
+	Locations.SetNumUninitialized(Components.Num());
+	ComponentBounds.SetNumUninitialized(Components.Num());
+	ParallelFor(Components.Num(), [this](int32 i)
+		{
+			Locations[i] = Components[i]->GetComponentLocation();
+			ComponentBounds[i] = GetHierarchyBounds(Components[i], false);
+			if (!ComponentBounds[i].IsValid)
+				ComponentBounds[i] = FBox(Locations[i], Locations[i]);
+		});
+
+	Rebuild();
+}
+
+bool FTransformerSelectionBounds::IsOnEdge(const FBox& Box) const
+{
+	return Box.Min.X <= Bounds.Min.X || Box.Min.Y <= Bounds.Min.Y || Box.Min.Z <= Bounds.Min.Z
+		|| Box.Max.X >= Bounds.Max.X || Box.Max.Y >= Bounds.Max.Y || Box.Max.Z >= Bounds.Max.Z;
+}
+
+void FTransformerSelectionBounds::UpdateMoved()
+{
+	for (USceneComponent* component : Moved)
+	{
+		const int32 index = Indices.FindChecked(component);
+		const FVector location = component->GetComponentLocation();
+		FBox bounds = GetHierarchyBounds(component, false);
+		if (!bounds.IsValid)
+			bounds = FBox(location, location);
+
+		LocationSum += location - Locations[index];
+		if (!bBoundsDirty)
+		{
+			if (IsOnEdge(ComponentBounds[index]))
+				bBoundsDirty = true;
+			else
+				Bounds += bounds;
+		}
+
+		Locations[index] = location;
+		ComponentBounds[index] = bounds;
+	}
+	Moved.Reset();
+}
+
+void FTransformerSelectionBounds::Rebuild()
+{
+	const int32 rangeCount = FMath::DivideAndRoundUp(Components.Num(), SelectionBoundsRangeSize);
+	TArray<FBox> rangeBounds;
+	TArray<FVector> rangeSums;
+	rangeBounds.Init(FBox(ForceInit), rangeCount);
+	rangeSums.Init(FVector::ZeroVector, rangeCount);
+
+	ParallelFor(rangeCount, [this, &rangeBounds, &rangeSums](int32 range)
+		{
+			const int32 start = range * SelectionBoundsRangeSize;
+			const int32 end = FMath::Min(start + SelectionBoundsRangeSize, Components.Num());
+			for (int32 i = start; i < end; ++i)
+			{
+				rangeBounds[range] += ComponentBounds[i];
+				rangeSums[range] += Locations[i];
+			}
+		});
+
+	Bounds = FBox(ForceInit);
+	LocationSum = FVector::ZeroVector;
+	for (int32 range = 0; range < rangeCount; ++range)
+	{
+		Bounds += rangeBounds[range];
+		LocationSum += rangeSums[range];
+	}
+	bBoundsDirty = false;
+}
+
+FBox FTransformerSelectionBounds::GetBounds()
+{
+	UpdateMoved();
+	if (bBoundsDirty)
+		Rebuild();
+	return Bounds;
+}
+
+FVector FTransformerSelectionBounds::GetCentroid()
+{
+	UpdateMoved();
+	return Components.Num() > 0 ? LocationSum / Components.Num() : FVector::ZeroVector;
+}
@@ -0,0 +1,28 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerSelectionQuery.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+
+bool FTransformerSelectionQuery::MatchesClasses(const UClass* InActorClass, const UClass* InComponentClass) const
+{
+	if (ActorClass && !(InActorClass && InActorClass->IsChildOf(ActorClass))) return false;
+	if (ComponentClass && !(InComponentClass && InComponentClass->IsChildOf(ComponentClass))) return false;
+	if (Interface)
+	{
+		const bool bImplements = (InComponentClass && InComponentClass->ImplementsInterface(Interface))
+			|| (InActorClass && InActorClass->ImplementsInterface(Interface));
+		if (!bImplements) return false;
+	}
+	return true;
+}
+
+bool FTransformerSelectionQuery::Matches(const FTransformerSelectionQueryCandidate& Candidate) const
+{
+	if (bRootComponentsOnly && !Candidate.bIsRoot) return false;
+	if (!Tag.IsNone() && !Candidate.Tags.Contains(Tag)) return false;
+	if (Radius > 0.f && FVector::DistSquared(Candidate.Location, Center) > FMath::Square((double)Radius)) return false;
+	if (Box.IsValid && !Box.Intersect(Candidate.Bounds)) return false;
+	return !Predicate || Predicate(Candidate);
+}
@@ -0,0 +1,60 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerSelectionQueryAsyncAction.h"
+
+UTransformerSelectionQueryAsyncAction* UTransformerSelectionQueryAsyncAction::SelectByQuery(ATransformerPawn* TransformerPawn
+	, const FTransformerSelectionQuery& Query, bool bAppendToList)
+{
+	UTransformerSelectionQueryAsyncAction* action = NewObject<UTransformerSelectionQueryAsyncAction>();
+	action->Pawn = TransformerPawn;
+	action->Query = Query;
+	action->bAppendToList = bAppendToList;
+	action->RegisterWithGameInstance(TransformerPawn);
+	return action;
+}
+
+void UTransformerSelectionQueryAsyncAction::Activate()
+{
+	ATransformerPawn* pawn = Pawn.Get();
+	if (!pawn)
+	{
+		Finish(TArray<USceneComponent*>(), true);
+		return;
+	}
+
+	pawn->OnSelectionQueryApplied.AddDynamic(this, &UTransformerSelectionQueryAsyncAction::HandleSelectionQueryApplied);
+	pawn->OnDestroyed.AddDynamic(this, &UTransformerSelectionQueryAsyncAction::HandlePawnDestroyed);
+
+	QueryId = pawn->SelectByQuery(Query, bAppendToList);
+	if (QueryId == INDEX_NONE)
+		Finish(TArray<USceneComponent*>(), true);
+}
+
+void UTransformerSelectionQueryAsyncAction::HandleSelectionQueryApplied(int32 InQueryId, const TArray<USceneComponent*>& Selected)
+{
+	//other Queries of the same Pawn
+	if (InQueryId == QueryId)
+		Finish(Selected, false);
+}
+
+void UTransformerSelectionQueryAsyncAction::HandlePawnDestroyed(AActor* DestroyedActor)
+{
+	Finish(TArray<USceneComponent*>(), true);
+}
+
+void UTransformerSelectionQueryAsyncAction::Finish(const TArray<USceneComponent*>& Selected, bool bFailed)
+{
+	if (ATransformerPawn* pawn = Pawn.Get())
+	{
+		pawn->OnSelectionQueryApplied.RemoveDynamic(this, &UTransformerSelectionQueryAsyncAction::HandleSelectionQueryApplied);
+		pawn->OnDestroyed.RemoveDynamic(this, &UTransformerSelectionQueryAsyncAction::HandlePawnDestroyed);
+	}
+
+	if (bFailed)
+		OnFailed.Broadcast(Selected);
+	else
+		OnApplied.Broadcast(Selected);
+
+	SetReadyToDestroy();
+}
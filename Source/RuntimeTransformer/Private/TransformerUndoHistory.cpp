@@ -0,0 +1,128 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerUndoHistory.h"
+#include "TransformerClipboard.h"
+
+SIZE_T FTransformerUndoEntry::GetAllocatedSize() const
+{
+	SIZE_T size = sizeof(FTransformerUndoEntry)
+		+ Components.GetAllocatedSize()
+		+ Before.GetAllocatedSize()
+		+ After.GetAllocatedSize()
+		+ Deselected.GetAllocatedSize()
+		+ Restored.GetAllocatedSize();
+
+	if (Deleted.IsValid())
+		size += Deleted->GetSize();
+	return size;
+}
+
+FTransformerUndoHistory::FTransformerUndoHistory()
+	: Head(0)
+	, Count(0)
+	, Cursor(0)
+	, MaxEntries(256)
+	, MaxBytes(4 * 1024 * 1024)
+	, TotalBytes(0)
+{
+}
+
+void FTransformerUndoHistory::SetLimits(int32 InMaxEntries, SIZE_T InMaxBytes)
+{
+	InMaxEntries = FMath::Max(InMaxEntries, 1);
+	if (InMaxEntries == MaxEntries && InMaxBytes == MaxBytes) return;
+
+	MaxBytes = InMaxBytes;
+	while (Count > 0 && (Count > InMaxEntries || TotalBytes > MaxBytes))
+		PopOldest();
+
+	//Re-lay the entries in use from index 0 in the new storage
+	if (InMaxEntries != MaxEntries && Entries.Num() > 0)
+	{
+		TArray<FTransformerUndoEntry> entries;
+		TArray<SIZE_T> entryBytes;
+		entries.SetNum(InMaxEntries);
+		entryBytes.SetNumZeroed(InMaxEntries);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const int32 index = (Head + i) % Entries.Num();
+			entries[i] = MoveTemp(Entries[index]);
+			entryBytes[i] = EntryBytes[index];
+		}
+		Entries = MoveTemp(entries);
+		EntryBytes = MoveTemp(entryBytes);
+		Head = 0;
+	}
+	MaxEntries = InMaxEntries;
+}
+
+void FTransformerUndoHistory::Push(FTransformerUndoEntry&& Entry)
+{
+	if (Entries.Num() == 0)
+	{
+		Entries.SetNum(MaxEntries);
+		EntryBytes.SetNumZeroed(MaxEntries);
+	}
+
+	//whatever could be redone is gone
+	while (Count > Cursor)
+	{
+		const int32 index = (Head + Count - 1) % Entries.Num();
+		TotalBytes -= EntryBytes[index];
+		Entries[index] = FTransformerUndoEntry();
+		EntryBytes[index] = 0;
+		--Count;
+	}
+
+	const SIZE_T bytes = Entry.GetAllocatedSize();
+	while (Count > 0 && (Count >= MaxEntries || TotalBytes + bytes > MaxBytes))
+		PopOldest();
+
+	const int32 index = (Head + Count) % Entries.Num();
+	Entries[index] = MoveTemp(Entry);
+	EntryBytes[index] = bytes;
+	TotalBytes += bytes;
+	++Count;
+	Cursor = Count;
+}
+
+FTransformerUndoEntry* FTransformerUndoHistory::PeekUndo()
+{
+	return CanUndo() ? &At(Cursor - 1) : nullptr;
+}
+
+FTransformerUndoEntry* FTransformerUndoHistory::PeekRedo()
+{
+	return CanRedo() ? &At(Cursor) : nullptr;
+}
+
+void FTransformerUndoHistory::MoveBack()
+{
+	if (Cursor > 0) --Cursor;
+}
+
+void FTransformerUndoHistory::MoveForward()
+{
+	if (Cursor < Count) ++Cursor;
+}
+
+void FTransformerUndoHistory::PopOldest()
+{
+	if (Count == 0) return;
+
+	TotalBytes -= EntryBytes[Head];
+	Entries[Head] = FTransformerUndoEntry();
+	EntryBytes[Head] = 0;
+	Head = (Head + 1) % Entries.Num();
+	--Count;
+	Cursor = FMath::Max(Cursor - 1, 0);
+}
+
+void FTransformerUndoHistory::Empty()
+{
+	Entries.Empty();
+	EntryBytes.Empty();
+	Head = Count = Cursor = 0;
+	TotalBytes = 0;
+}
@@ -0,0 +1,413 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerVertexSnapping.h"
+#include "Async/Async.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Rendering/PositionVertexBuffer.h"
+#include "StaticMeshResources.h"
+#include <algorithm>
+
+//Ranges of up to this many vertices are not split any further
+static const int32 VertexTreeLeafSize = 8;
+
+static void BuildVertexTree(TArray<FVector3f>& Points, int32 Start, int32 End, int32 Depth)
+{
+	if (End - Start <= VertexTreeLeafSize) return;
+
+	const int32 axis = Depth % 3;
+	const int32 mid = (Start + End) / 2;
+	std::nth_element(Points.GetData() + Start, Points.GetData() + mid, Points.GetData() + End
+		, [axis](const FVector3f& a, const FVector3f& b) { return a[axis] < b[axis]; });
+
+	BuildVertexTree(Points, Start, mid, Depth + 1);
+	BuildVertexTree(Points, mid + 1, End, Depth + 1);
+}
+
+//Whether a sphere might have a point within the cone around the ray (RayDirection normalized)
+static bool ConeMightContain(const FVector& RayOrigin, const FVector& RayDirection, double TanAngle
+	, const FVector& Center, double Radius)
+{
+	const FVector toCenter = Center - RayOrigin;
+	const double t = FVector::DotProduct(toCenter, RayDirection);
+	if (t + Radius <= 0.0) return false;
+	const double d = (toCenter - t * RayDirection).Size();
+	return d - Radius <= (t + Radius) * TanAngle;
+}
+
+/**
+ * Search of a tree with a ray in mesh space. Vertices are pre-filtered in mesh space (TanAngle is widened by how
+ * non-uniform the scale is) and measured in world space
+ */
+struct FVertexTreeQuery
+{
+	const TArray<FVector3f>& Points;
+	FVector3f LocalOrigin;
+	FVector3f LocalDirection;
+	float LocalTanAngle;
+
+	const FTransform& ComponentTransform;
+	const FVector& RayOrigin;
+	const FVector& RayDirection;
+
+	//best so far (shared between components)
+	float& BestTanAngle;
+	FVector& BestVertex;
+	float NonUniformity;
+
+	//Whether the box might have a point within the (local) cone
+	bool MightContain(const FBox3f& Box) const
+	{
+		const FVector3f center = Box.GetCenter();
+		const float halfDiagonal = Box.GetExtent().Size();
+		const FVector3f toCenter = center - LocalOrigin;
+		const float t = FVector3f::DotProduct(toCenter, LocalDirection);
+		if (t + halfDiagonal <= 0.f) return false;
+		const float d = (toCenter - t * LocalDirection).Size();
+		return d - halfDiagonal <= (t + halfDiagonal) * LocalTanAngle;
+	}
+
+	void Test(const FVector3f& Point)
+	{
+		const FVector3f toPoint = Point - LocalOrigin;
+		const float t = FVector3f::DotProduct(toPoint, LocalDirection);
+		if (t <= 0.f || (toPoint - t * LocalDirection).Size() > t * LocalTanAngle) return;
+
+		const FVector vertex = ComponentTransform.TransformPosition(FVector(Point));
+		const FVector toVertex = vertex - RayOrigin;
+		const double worldT = FVector::DotProduct(toVertex, RayDirection);
+		if (worldT <= KINDA_SMALL_NUMBER) return;
+
+		const float tanAngle = (toVertex - worldT * RayDirection).Size() / worldT;
+		if (tanAngle < BestTanAngle)
+		{
+			BestTanAngle = tanAngle;
+			BestVertex = vertex;
+			LocalTanAngle = tanAngle * NonUniformity; //nothing wider can win anymore
+		}
+	}
+
+	void Search(int32 Start, int32 End, int32 Depth, const FBox3f& Box)
+	{
+		if (Start >= End || !MightContain(Box)) return;
+
+		if (End - Start <= VertexTreeLeafSize)
+		{
+			for (int32 i = Start; i < End; ++i)
+				Test(Points[i]);
+			return;
+		}
+
+		const int32 axis = Depth % 3;
+		const int32 mid = (Start + End) / 2;
+		const FVector3f& point = Points[mid];
+		Test(point);
+
+		FBox3f lower = Box;
+		lower.Max[axis] = point[axis];
+		FBox3f upper = Box;
+		upper.Min[axis] = point[axis];
+
+		//the half the ray starts in first, so the best gets close sooner
+		if (LocalOrigin[axis] < point[axis])
+		{
+			Search(Start, mid, Depth + 1, lower);
+			Search(mid + 1, End, Depth + 1, upper);
+		}
+		else
+		{
+			Search(mid + 1, End, Depth + 1, upper);
+			Search(Start, mid, Depth + 1, lower);
+		}
+	}
+};
+
+UTransformerVertexSnapping* UTransformerVertexSnapping::Get(const UObject* WorldContextObject)
+{
+	UWorld* world = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UTransformerVertexSnapping>() : nullptr;
+}
+
+bool UTransformerVertexSnapping::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTransformerVertexSnapping::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	if (UWorld* world = GetWorld())
+	{
+		ActorSpawnedHandle = world->AddOnActorSpawnedHandler(
+			FOnActorSpawned::FDelegate::CreateUObject(this, &UTransformerVertexSnapping::OnActorSpawned));
+		ActorDestroyedHandle = world->AddOnActorDestroyedHandler(
+			FOnActorDestroyed::FDelegate::CreateUObject(this, &UTransformerVertexSnapping::OnActorDestroyed));
+	}
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UTransformerVertexSnapping::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UTransformerVertexSnapping::OnLevelRemoved);
+}
+
+void UTransformerVertexSnapping::Deinitialize()
+{
+	if (UWorld* world = GetWorld())
+	{
+		world->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		world->RemoveOnActorDestroyedHandler(ActorDestroyedHandle);
+	}
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	//trees still building hold on to their own reference
+	EmptyCache();
+	for (auto& it : ComponentIds)
+	{
+		if (UStaticMeshComponent* component = it.Key.Get())
+			component->TransformUpdated.RemoveAll(this);
+	}
+	ComponentIds.Reset();
+	MovedComponents.Reset();
+	ComponentOctree.Reset();
+	Super::Deinitialize();
+}
+
+void UTransformerVertexSnapping::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	GatherComponents();
+}
+
+void UTransformerVertexSnapping::EmptyCache()
+{
+	Trees.Reset();
+}
+
+int32 UTransformerVertexSnapping::GetCachedVertexCount() const
+{
+	int32 count = 0;
+	for (auto& it : Trees)
+	{
+		if (it.Value->bReady)
+			count += it.Value->Points.Num();
+	}
+	return count;
+}
+
+const UTransformerVertexSnapping::FVertexTree* UTransformerVertexSnapping::GetTree(UStaticMesh* Mesh)
+{
+	if (FVertexTreePtr* tree = Trees.Find(Mesh))
+		return (*tree)->bReady ? tree->Get() : nullptr;
+
+	FVertexTreePtr tree = MakeShared<FVertexTree, ESPMode::ThreadSafe>();
+	Trees.Add(Mesh, tree);
+
+	//the positions are copied here, the rest is done in the background
+	TArray<FVector3f> positions;
+	FStaticMeshRenderData* renderData = Mesh->GetRenderData();
+	if (renderData && renderData->LODResources.Num() > 0)
+	{
+		FPositionVertexBuffer& positionBuffer = renderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
+		if (positionBuffer.GetVertexData() && positionBuffer.GetNumVertices() > 0)
+		{
+			positions.SetNumUninitialized(positionBuffer.GetNumVertices());
+			for (uint32 i = 0; i < positionBuffer.GetNumVertices(); ++i)
+				positions[i] = positionBuffer.VertexPosition(i);
+		}
+	}
+
+	Async(EAsyncExecution::ThreadPool, [tree, positions = MoveTemp(positions)]() mutable
+		{
+			//vertices are split at UV / normal seams, the position is all that matters here
+			TSet<FVector3f> unique;
+			unique.Reserve(positions.Num());
+			for (const FVector3f& position : positions)
+				unique.Add(position);
+
+			tree->Points = unique.Array();
+			tree->Bounds = FBox3f(tree->Points);
+			BuildVertexTree(tree->Points, 0, tree->Points.Num(), 0);
+			tree->bReady = true;
+		});
+
+	return nullptr;
+}
+
+void UTransformerVertexSnapping::GatherComponents()
+{
+	for (auto& it : ComponentIds)
+	{
+		if (UStaticMeshComponent* component = it.Key.Get())
+			component->TransformUpdated.RemoveAll(this);
+	}
+	ComponentIds.Reset();
+	MovedComponents.Reset();
+	ComponentOctree = MakeUnique<FComponentOctree>(FVector::ZeroVector, HALF_WORLD_MAX);
+
+	for (TActorIterator<AActor> it(GetWorld()); it; ++it)
+		AddComponents(*it);
+	bComponentsDirty = false;
+}
+
+void UTransformerVertexSnapping::AddComponents(AActor* Actor)
+{
+	if (!Actor) return;
+	Actor->ForEachComponent<UStaticMeshComponent>(false, [this](UStaticMeshComponent* Component)
+		{
+			AddStaticMeshComponent(Component);
+		});
+}
+
+void UTransformerVertexSnapping::RemoveComponents(AActor* Actor)
+{
+	if (!Actor) return;
+	Actor->ForEachComponent<UStaticMeshComponent>(false, [this](UStaticMeshComponent* Component)
+		{
+			RemoveStaticMeshComponent(Component);
+		});
+}
+
+void UTransformerVertexSnapping::AddComponent(USceneComponent* Component)
+{
+	if (UStaticMeshComponent* staticMeshComponent = Cast<UStaticMeshComponent>(Component))
+		AddStaticMeshComponent(staticMeshComponent);
+}
+
+void UTransformerVertexSnapping::AddStaticMeshComponent(UStaticMeshComponent* Component)
+{
+	//a gather still to come picks it up anyway
+	if (bComponentsDirty || !ComponentOctree.IsValid()) return;
+
+	if (!Component->IsRegistered() || !Component->GetStaticMesh() || Component->IsA<UInstancedStaticMeshComponent>()) return;
+	if (ComponentIds.Contains(Component)) return;
+
+	ComponentOctree->AddElement({ Component, FBoxCenterAndExtent(Component->Bounds), &ComponentIds });
+	Component->TransformUpdated.AddUObject(this, &UTransformerVertexSnapping::OnComponentMoved);
+}
+
+void UTransformerVertexSnapping::RemoveStaticMeshComponent(const TWeakObjectPtr<UStaticMeshComponent>& Component)
+{
+	FOctreeElementId2 id;
+	if (!ComponentIds.RemoveAndCopyValue(Component, id)) return;
+
+	ComponentOctree->RemoveElement(id);
+	MovedComponents.Remove(Component);
+	if (UStaticMeshComponent* component = Component.Get())
+		component->TransformUpdated.RemoveAll(this);
+}
+
+void UTransformerVertexSnapping::UpdateMovedComponents()
+{
+	for (auto& componentPtr : MovedComponents)
+	{
+		const FOctreeElementId2* id = ComponentIds.Find(componentPtr);
+		UStaticMeshComponent* component = componentPtr.Get();
+		if (!id || !component) continue;
+
+		FComponentElement element = ComponentOctree->GetElementById(*id);
+		ComponentOctree->RemoveElement(*id);
+		element.Bounds = FBoxCenterAndExtent(component->Bounds);
+		ComponentOctree->AddElement(element);
+	}
+	MovedComponents.Reset();
+}
+
+void UTransformerVertexSnapping::OnActorSpawned(AActor* Actor)
+{
+	AddComponents(Actor);
+}
+
+void UTransformerVertexSnapping::OnActorDestroyed(AActor* Actor)
+{
+	RemoveComponents(Actor);
+}
+
+void UTransformerVertexSnapping::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	//streamed in Sublevels and World Partition cells (their Actors aren't spawned, so OnActorSpawned misses them)
+	if (!Level || World != GetWorld()) return;
+	for (AActor* actor : Level->Actors)
+		AddComponents(actor);
+}
+
+void UTransformerVertexSnapping::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (!Level || World != GetWorld()) return;
+	for (AActor* actor : Level->Actors)
+		RemoveComponents(actor);
+}
+
+void UTransformerVertexSnapping::OnComponentMoved(USceneComponent* Component
+	, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	//its bounds in the octree are updated once, on the next query (it might move many times until then)
+	MovedComponents.Add(Cast<UStaticMeshComponent>(Component));
+}
+
+bool UTransformerVertexSnapping::FindVertex(const FVector& RayOrigin, const FVector& RayDirection, float MaxTanAngle
+	, const TSet<const AActor*>& IgnoredActors, FVector& OutVertex)
+{
+	if (bComponentsDirty || !ComponentOctree.IsValid())
+		GatherComponents();
+	else if (MovedComponents.Num() > 0)
+		UpdateMovedComponents();
+
+	const FVector direction = RayDirection.GetSafeNormal();
+	if (direction.IsNearlyZero() || MaxTanAngle <= 0.f) return false;
+
+	float bestTanAngle = MaxTanAngle;
+	FVector bestVertex;
+	bool bFound = false;
+
+	//components destroyed on their own (their Actor is still around) are removed after the query
+	TArray<TWeakObjectPtr<UStaticMeshComponent>> destroyedComponents;
+
+	//only the nodes and components whose bounds are within the cone of the best so far are gone through
+	ComponentOctree->FindElementsWithPredicate(
+		[&](FComponentOctree::FNodeIndex ParentNodeIndex, FComponentOctree::FNodeIndex NodeIndex, const FBoxCenterAndExtent& NodeBounds)
+		{
+			return ConeMightContain(RayOrigin, direction, bestTanAngle, FVector(NodeBounds.Center), FVector(NodeBounds.Extent).Size());
+		},
+		[&](FComponentOctree::FNodeIndex ParentNodeIndex, const FComponentElement& Element)
+		{
+			UStaticMeshComponent* component = Element.Component.Get();
+			if (!component)
+			{
+				destroyedComponents.Add(Element.Component);
+				return;
+			}
+			if (!component->IsVisible() || IgnoredActors.Contains(component->GetOwner())) return;
+
+			//current bounds against the cone of the best so far
+			const FBoxSphereBounds& bounds = component->Bounds;
+			if (!ConeMightContain(RayOrigin, direction, bestTanAngle, bounds.Origin, bounds.SphereRadius)) return;
+
+			const FVertexTree* tree = GetTree(component->GetStaticMesh());
+			if (!tree || tree->Points.Num() == 0) return;
+
+			const FTransform& transform = component->GetComponentTransform();
+			const FVector scale = transform.GetScale3D().GetAbs();
+			const double minScale = scale.GetMin();
+			if (minScale <= KINDA_SMALL_NUMBER) return;
+			const float nonUniformity = scale.GetMax() / minScale;
+
+			const FVector3f localOrigin(transform.InverseTransformPosition(RayOrigin));
+			const FVector3f localDirection = FVector3f(transform.InverseTransformVector(direction)).GetSafeNormal();
+
+			const float previousBest = bestTanAngle;
+			FVertexTreeQuery query{ tree->Points, localOrigin, localDirection, bestTanAngle * nonUniformity
+				, transform, RayOrigin, direction, bestTanAngle, bestVertex, nonUniformity };
+			query.Search(0, tree->Points.Num(), 0, tree->Bounds);
+			bFound |= bestTanAngle < previousBest;
+		});
+
+	for (auto& component : destroyedComponents)
+		RemoveStaticMeshComponent(component);
+
+	if (bFound)
+		OutVertex = bestVertex;
+	return bFound;
+}
@@ -30,6 +30,21 @@ public:
 		, ETransformationDomain Domain
 		, float SnappingValue) const override;
 
+	/*
+	 * Vertex Snapping: the Delta Transform that takes the Gizmo to the Static Mesh vertex nearest to the ray,
+	 * if there's one within ScreenRadius pixels of it (Axis / Plane Domains only move along their Axis / Plane).
+	 * @param PixelTanAngle - tangent of the angle a pixel covers at the center of the screen
+	 * @param IgnoredActors - Actors not to snap to (e.g. the ones being moved)
+	 * @return false if there's no vertex near enough
+	 */
+	bool GetVertexSnappedTransform(const FVector& RayStartPoint
+		, const FVector& RayDirection
+		, float ScreenRadius
+		, float PixelTanAngle
+		, ETransformationDomain Domain
+		, const TSet<const AActor*>& IgnoredActors
+		, FTransform& outDeltaTransform) const;
+
 protected:
 
 	// The Hit Box for the XY-Plane Translation
@@ -0,0 +1,97 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TransformerActorPool.generated.h"
+
+/**
+ * Per-World pool of soft deleted Actors (ATransformerPawn with Soft Delete).
+ * A parked Actor is hidden, and its collision, ticking and physics are disabled, but it's not destroyed:
+ * Undo brings it back as it was (Unpark) and cloning its Template again can reuse it (ReuseClone).
+ *
+ * Parked Actors are actually destroyed once they've been parked for RuntimeTransformer.ActorPool.Lifetime seconds
+ * (or there are more than RuntimeTransformer.ActorPool.MaxParked), oldest first and
+ * under a per-frame budget (RuntimeTransformer.ActorPool.DestroyBudgetMs) so mass deletes don't hitch.
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerActorPool : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UTransformerActorPool* Get(const UObject* WorldContextObject);
+
+	//Soft deletes the Actor
+	void Park(AActor* Actor);
+
+	//Brings back a parked Actor as it was. Returns false if it's not parked (e.g. it has been destroyed already)
+	bool Unpark(AActor* Actor);
+
+	bool IsParked(const AActor* Actor) const { return Parked.Contains(Actor); }
+
+	//Remembers the Template a Clone was made from, so that it can be reused for that Template once parked
+	void RegisterClone(AActor* Clone, AActor* Template);
+
+	//Unparks a Clone of the Template (placed where the Template is). nullptr if none is parked
+	AActor* ReuseClone(AActor* Template);
+
+	//Destroys all the parked Actors now
+	void DestroyAll();
+
+	int32 GetParkedCount() const { return Parked.Num(); }
+
+	void GetParkedActors(TArray<AActor*>& OutActors) const;
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	//Destroys a parked Actor, recording the delete in the Layout (and Edit State) first
+	void DestroyParked(AActor* Actor);
+
+	struct FParkedActor
+	{
+		double ParkTime = 0.0;
+
+		//Which Park this is (an Actor unparked and parked again gets a new one)
+		uint64 Sequence = 0;
+
+		TWeakObjectPtr<AActor> Template;
+		bool bWasHidden = false;
+		bool bHadCollision = true;
+		bool bWasTicking = false;
+
+		//Components whose tick / physics simulation was disabled when parked
+		TArray<TWeakObjectPtr<class UActorComponent>> TickingComponents;
+		TArray<TWeakObjectPtr<class UPrimitiveComponent>> SimulatingComponents;
+	};
+
+	TMap<TWeakObjectPtr<AActor>, FParkedActor> Parked;
+
+	struct FParkOrderEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		uint64 Sequence = 0;
+	};
+
+	/**
+	 * Parked Actors, oldest first (entries from ParkOrderHead on).
+	 * Entries whose Sequence isn't the one in Parked (unparked, or unparked and parked again since) are skipped.
+	 */
+	TArray<FParkOrderEntry> ParkOrder;
+	int32 ParkOrderHead = 0;
+	uint64 NextParkSequence = 1;
+
+	//Template of each Clone (Clone - Template)
+	TMap<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>> CloneTemplates;
+	int32 CloneTemplatesPruneSize = 1024;
+
+	//Parked Clones of each Template
+	TMultiMap<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>> ParkedClones;
+};
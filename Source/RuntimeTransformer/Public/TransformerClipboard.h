@@ -0,0 +1,63 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Copy / Paste buffer for the Transformer Pawns.
+ * Copy serializes the given Actors once into a single memory buffer: Class, Transform relative to a Pivot
+ * and the properties (and those of their components) that differ from the Class defaults.
+ * Paste spawns new Actors from that buffer, so the copied Actors don't need to exist anymore (nor be in the same level).
+ *
+ * References to objects outside of the copied Actor are kept as paths (e.g. assets),
+ * references to objects within it (e.g. its own components) are left as the new Actor has them.
+ * Components that are not part of the Class (added at runtime) are not copied.
+ *
+ * Copy / Paste use one clipboard per process (Get), which survives level changes. It can also be saved to / loaded from a file.
+ * Game Thread only.
+ */
+class RUNTIMETRANSFORMER_API FTransformerClipboard
+{
+public:
+
+	FTransformerClipboard();
+
+	//The Clipboard of the Copy / Paste of the Transformer Pawns
+	static FTransformerClipboard& Get();
+
+	/*
+	 * Replaces the contents of the clipboard with the given Actors.
+	 * Their transforms are kept relative to the Pivot, which is what the Paste Targets replace.
+	 * @return the number of Actors copied
+	 */
+	int32 Copy(const TArray<AActor*>& Actors, const FTransform& Pivot);
+
+	/*
+	 * Spawns a copy of the clipboard contents at each of the Targets.
+	 * @return the Actors spawned (all the copies of the first Target, then all of the second, etc.)
+	 */
+	TArray<AActor*> Paste(UWorld* World, const TArray<FTransform>& Targets) const;
+
+	bool IsEmpty() const { return ActorCount == 0; }
+
+	int32 GetActorCount() const { return ActorCount; }
+
+	//Size in bytes of the serialized clipboard
+	int32 GetSize() const { return Data.Num(); }
+
+	void Empty();
+
+	//Writes the clipboard into the given file. Returns true on success
+	bool ExportToFile(const FString& FilePath) const;
+
+	//Replaces the clipboard with the contents of the given file (written by ExportToFile). Returns true on success
+	bool ImportFromFile(const FString& FilePath);
+
+private:
+
+	//Header, followed by the entry of each Actor
+	TArray<uint8> Data;
+
+	int32 ActorCount;
+};
@@ -0,0 +1,61 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "TransformerPawn.h"
+#include "TransformerCloneAsyncAction.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FTransformerCloneAsyncActionDelegate, const TArray<class USceneComponent*>&, Clones, float, Progress);
+
+/**
+ * Latent Blueprint Node for ATransformerPawn::CloneSelectedTimeSliced.
+ * OnProgress fires every frame clones are spawned, with the clones spawned so far (Progress goes from 0 to 1),
+ * then either OnCompleted or OnCancelled fire with all the clones spawned.
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerCloneAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	/*
+	 * Clones the Selection of the Pawn over several frames.
+	 * @see ATransformerPawn::CloneSelectedTimeSliced
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer"
+		, meta = (BlueprintInternalUseOnly = "true", DisplayName = "Clone Selected (Time Sliced)"))
+	static UTransformerCloneAsyncAction* CloneSelectedTimeSliced(ATransformerPawn* TransformerPawn
+		, bool bSelectNewClones = true, bool bAppendToList = false
+		, ECloneSelectionUpdate SelectionUpdate = ECloneSelectionUpdate::CSU_OnFinish);
+
+	UPROPERTY(BlueprintAssignable)
+	FTransformerCloneAsyncActionDelegate OnProgress;
+
+	UPROPERTY(BlueprintAssignable)
+	FTransformerCloneAsyncActionDelegate OnCompleted;
+
+	UPROPERTY(BlueprintAssignable)
+	FTransformerCloneAsyncActionDelegate OnCancelled;
+
+	virtual void Activate() override;
+
+private:
+
+	UFUNCTION()
+	void HandleCloneProgress(int32 ClonesDone, int32 ClonesTotal);
+
+	UFUNCTION()
+	void HandleCloneFinished(const TArray<class USceneComponent*>& Clones, bool bCancelled);
+
+	void Finish(const TArray<class USceneComponent*>& Clones, bool bCancelled);
+
+	UPROPERTY()
+	TWeakObjectPtr<ATransformerPawn> Pawn;
+
+	bool bSelectNewClones = true;
+	bool bAppendToList = false;
+	ECloneSelectionUpdate SelectionUpdate = ECloneSelectionUpdate::CSU_OnFinish;
+};
@@ -0,0 +1,74 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TransformerCloneIdComponent.generated.h"
+
+/**
+ * Added by the Server to the Actor Clones made through ATransformerPawn::ServerCloneSelected.
+ * Replicates the Clone Id of the Clone Command, so that when the Clone arrives to a client
+ * it can replace the local clone that client spawned when it received the Clone Command.
+ */
+UCLASS(ClassGroup = (RuntimeTransformer))
+class RUNTIMETRANSFORMER_API UTransformerCloneIdComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UTransformerCloneIdComponent();
+
+	virtual void GetLifetimeReplicatedProps(
+		TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Server: adds the Component to a freshly spawned clone
+	static UTransformerCloneIdComponent* AddTo(AActor* Clone, int32 CloneId);
+
+	//Client: returns (and forgets) the Replicated Clone with the given Id if it arrived before its Clone Command (in the World of the Context)
+	static AActor* ConsumeArrivedClone(const UObject* WorldContextObject, int32 CloneId);
+
+	int32 GetCloneId() const { return CloneId; }
+
+private:
+
+	UFUNCTION()
+	void OnRep_CloneId();
+
+	UPROPERTY(ReplicatedUsing = OnRep_CloneId)
+	int32 CloneId;
+};
+
+/**
+ * Per-World Clone Ids: the Server gives them out (so they're unique per Server World, not per process)
+ * and the Clients keep the Clones that were replicated before the Clone Command that made them.
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerCloneIds : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UTransformerCloneIds* Get(const UObject* WorldContextObject);
+
+	//Server: a new Clone Id
+	int32 MakeCloneId() { return ++LastCloneId; }
+
+	//Client: keeps a Clone that arrived before its Clone Command
+	void AddArrivedClone(int32 CloneId, AActor* Clone);
+
+	//Client: returns (and forgets) the Clone with the given Id if it arrived before its Clone Command
+	AActor* ConsumeArrivedClone(int32 CloneId);
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+private:
+
+	int32 LastCloneId = 0;
+
+	TMap<int32, TWeakObjectPtr<AActor>> ArrivedClones;
+};
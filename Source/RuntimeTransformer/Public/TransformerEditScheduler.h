@@ -0,0 +1,78 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TransformerEditScheduler.generated.h"
+
+class ATransformerPawn;
+
+/**
+ * Server-side queue for the edits requested through the Server RPCs of the Transformer Pawns.
+ * Instead of running inside the RPC dispatch, heavy edits (Apply Transform, Clone, Delete) are queued
+ * and run under a per-frame time budget (RuntimeTransformer.EditScheduler.BudgetMs),
+ * going round-robin between the Pawns (i.e. clients) so that one client's big edit doesn't starve the others.
+ *
+ * Once a Pawn has something queued, all its following commands are queued too,
+ * so every Pawn's commands still run in the order they were received.
+ *
+ * A Step returns true once the command is done. Steps that return false are resumed the next time
+ * it's that Pawn's turn (Deadline is the FPlatformTime::Seconds the step should try to finish by).
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerEditScheduler : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	typedef TFunction<bool(double Deadline)> FEditStep;
+
+	static UTransformerEditScheduler* Get(const UObject* WorldContextObject);
+
+	//Queues a command for the given Pawn. It will run after every command of the Pawn that was queued before
+	void Enqueue(ATransformerPawn* Pawn, const FName& CommandName, FEditStep&& Step);
+
+	//Whether the Pawn has any command waiting or in progress
+	bool HasPendingCommands(const ATransformerPawn* Pawn) const;
+
+	//Total number of commands queued (all pawns)
+	int32 GetQueueDepth() const { return QueueDepth; }
+
+	//Peak Queue Depth and Wait Times (seconds from Enqueue until the command started running)
+	int32 GetPeakQueueDepth() const { return PeakQueueDepth; }
+	double GetAverageWaitTime() const { return StartedCommands > 0 ? TotalWaitTime / StartedCommands : 0.0; }
+	double GetMaxWaitTime() const { return MaxWaitTime; }
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	struct FEditCommand
+	{
+		FName Name;
+		FEditStep Step;
+		double EnqueueTime = 0.0;
+		bool bStarted = false;
+	};
+
+	struct FPawnQueue
+	{
+		TWeakObjectPtr<ATransformerPawn> Pawn;
+		TArray<FEditCommand> Commands;
+	};
+
+	TArray<FPawnQueue> Queues;
+
+	//Queue whose turn it is
+	int32 NextQueue = 0;
+
+	int32 QueueDepth = 0;
+	int32 PeakQueueDepth = 0;
+	int32 StartedCommands = 0;
+	double TotalWaitTime = 0.0;
+	double MaxWaitTime = 0.0;
+};
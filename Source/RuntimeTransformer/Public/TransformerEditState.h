@@ -0,0 +1,203 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "TransformerEditState.generated.h"
+
+class ATransformerPawn;
+
+//The committed World Transform of an object whose transform does not replicate by itself
+USTRUCT()
+struct FTransformerTransformOverride : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class USceneComponent* Component = nullptr;
+
+	UPROPERTY()
+	FTransform Transform;
+
+	void PostReplicatedAdd(const struct FTransformerTransformOverrideArray& InArraySerializer);
+	void PostReplicatedChange(const struct FTransformerTransformOverrideArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FTransformerTransformOverrideArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FTransformerTransformOverride> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FTransformerTransformOverride
+			, FTransformerTransformOverrideArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerTransformOverrideArray> : public TStructOpsTypeTraitsBase2<FTransformerTransformOverrideArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/**
+ * An object destroyed in the Server whose destruction does not replicate by itself (e.g. non replicated level actors).
+ * Destroyed objects can't be referenced, so the path is kept instead (without PIE prefix)
+ */
+USTRUCT()
+struct FTransformerDestroyedObject : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString Path;
+
+	void PostReplicatedAdd(const struct FTransformerDestroyedObjectArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FTransformerDestroyedObjectArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FTransformerDestroyedObject> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FTransformerDestroyedObject
+			, FTransformerDestroyedObjectArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerDestroyedObjectArray> : public TStructOpsTypeTraitsBase2<FTransformerDestroyedObjectArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/**
+ * A Component in the current Selection of a Transformer Pawn.
+ * One item per (Pawn, Component), so a Selection change only sends the items added or removed
+ */
+USTRUCT()
+struct FTransformerPawnSelection : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	ATransformerPawn* Pawn = nullptr;
+
+	UPROPERTY()
+	class USceneComponent* Component = nullptr;
+
+	//Items of a Pawn sorted by Order give its Selection in the right order (it matters for the Gizmo Placement)
+	UPROPERTY()
+	int32 Order = 0;
+};
+
+USTRUCT()
+struct FTransformerPawnSelectionArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FTransformerPawnSelection> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FTransformerPawnSelection
+			, FTransformerPawnSelectionArray>(Items, DeltaParms, *this);
+	}
+
+	//Client: the Pawns with changed items are applied once the whole update is received
+	void PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize);
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+	void PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize);
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	//Server: the next Order to give to an item
+	int32 NextOrder = 0;
+
+private:
+
+	void MarkPawnChanged(const TArrayView<int32>& Indices);
+
+	//Client: Pawns whose items changed in the update being received
+	TSet<TWeakObjectPtr<ATransformerPawn>> ChangedPawns;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerPawnSelectionArray> : public TStructOpsTypeTraitsBase2<FTransformerPawnSelectionArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/**
+ * Replicated, always relevant table of the edits made through the Transformer Pawns in the Server:
+ * the committed transforms of objects that don't replicate their movement, the objects destroyed
+ * and the current Selection of each Pawn.
+ *
+ * Multicasts are not persisted, so this is what gets a late joining client up to date
+ * (all of it comes in the initial bunch of this actor).
+ * Spawned by the Server the first time something is recorded.
+ */
+UCLASS(NotBlueprintable, NotPlaceable)
+class RUNTIMETRANSFORMER_API ATransformerEditState : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	ATransformerEditState();
+
+	virtual void GetLifetimeReplicatedProps(
+		TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/*
+	 * Returns the Edit State of the World of the given Object.
+	 * If bCreate is true and there is none, the Server spawns it (never in Standalone)
+	 */
+	static ATransformerEditState* Get(const UObject* WorldContextObject, bool bCreate);
+
+	//Whether the Transform of the given Component needs to be kept in the table (i.e. it doesn't replicate by itself)
+	static bool NeedsTransformOverride(const class USceneComponent* Component);
+
+	//Server: records the current World Transform of the Component (if it needs an override)
+	void RecordTransform(class USceneComponent* Component);
+
+	//Server: records that the Object is about to be destroyed (if its destruction does not replicate)
+	void RecordDestroyed(UObject* Object);
+
+	//Server: records the current Selection of the Pawn
+	void RecordSelection(ATransformerPawn* Pawn, const TArray<class USceneComponent*>& Components);
+
+	//Server: removes the Pawn's Selection (e.g. the Pawn is gone)
+	void RemoveSelection(ATransformerPawn* Pawn);
+
+	//Client: applies a replicated transform override
+	static void ApplyTransformOverride(const FTransformerTransformOverride& Override);
+
+	//Client: destroys the local counterpart of a destroyed object
+	static void ApplyDestroyed(const FTransformerDestroyedObject& Destroyed);
+
+private:
+
+	UPROPERTY(Replicated)
+	FTransformerTransformOverrideArray TransformOverrides;
+
+	UPROPERTY(Replicated)
+	FTransformerDestroyedObjectArray DestroyedObjects;
+
+	UPROPERTY(Replicated)
+	FTransformerPawnSelectionArray Selections;
+
+	//Server: index in TransformOverrides.Items for each Component
+	TMap<TWeakObjectPtr<class USceneComponent>, int32> TransformOverrideIndices;
+};
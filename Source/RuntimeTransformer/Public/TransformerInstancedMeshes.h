@@ -0,0 +1,68 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TransformerInstancedMeshes.generated.h"
+
+class UStaticMeshComponent;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Holds the Instanced Static Mesh Components that the Transformer Pawns clone (or bake) Static Mesh Actors into.
+ * There is one Instanced Component per unique Mesh + Materials, so memory and draw calls grow
+ * with the number of unique meshes rather than with the number of copies.
+ *
+ * Instances are local to the machine that made them (they are not replicated).
+ * Spawned the first time something is instanced in the World.
+ */
+UCLASS(NotBlueprintable, NotPlaceable)
+class RUNTIMETRANSFORMER_API ATransformerInstancedMeshes : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	ATransformerInstancedMeshes();
+
+	//Returns the Instanced Meshes Actor of the World of the given Object. If bCreate is true and there is none, it is spawned
+	static ATransformerInstancedMeshes* Get(const UObject* WorldContextObject, bool bCreate);
+
+	/*
+	 * Whether the Actor can be replaced by an instance: a Static Mesh Actor with a Mesh.
+	 * @return OutMeshComponent - the Static Mesh Component whose Mesh, Materials and World Transform make the instance
+	 */
+	static bool CanInstance(const AActor* Actor, UStaticMeshComponent*& OutMeshComponent);
+
+	/*
+	 * Adds instances of the Template's Mesh (and Materials) at the given World Transforms.
+	 * @param bHierarchical - whether the instances go in a Hierarchical Instanced Static Mesh Component (culled and LODed per cluster)
+	 * @return the Instanced Component the instances were added to
+	 */
+	UInstancedStaticMeshComponent* AddInstances(const UStaticMeshComponent* Template
+		, const TArray<FTransform>& WorldTransforms, bool bHierarchical);
+
+	/*
+	 * Adds an instance for each of the Actors that CanInstance, at the World Transform of its Mesh.
+	 * Instances are added in bulk (one AddInstances per Instanced Component). The Actors themselves are not touched.
+	 * @param OutNotInstanced - optional, gets the Actors that could not be instanced
+	 * @return the number of instances added
+	 */
+	int32 InstanceActors(const TArray<AActor*>& Actors, bool bHierarchical
+		, TArray<AActor*>* OutNotInstanced = nullptr);
+
+	//Number of Instanced Components (i.e. unique meshes)
+	int32 GetInstancerCount() const { return Instancers.Num(); }
+
+	//Number of instances in all the Instanced Components
+	int32 GetInstanceCount() const;
+
+private:
+
+	//Finds (or creates) the Instanced Component for the Template's Mesh and Materials
+	UInstancedStaticMeshComponent* FindOrAddInstancer(const UStaticMeshComponent* Template, bool bHierarchical);
+
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> Instancers;
+};
@@ -0,0 +1,103 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UTransformerLayout;
+
+enum class ETransformerJournalOp : uint8
+{
+	Define = 1,	//Id, Outer Id (INDEX_NONE: Name is a full path), Name
+	Clone,		//Id, Template Id, Attach Parent Id, Transform
+	Transform,	//Id, World Transform
+	Delete,		//Id
+	Selection,	//Count, Ids
+	SoftDelete,	//Id (Actor parked in the UTransformerActorPool)
+	Restore,	//Id (soft deleted Actor brought back)
+};
+
+/**
+ * Append-only journal of the edits tracked by a UTransformerLayout, so that a session can be replayed
+ * after a crash (UTransformerLayout::ReplayJournal) instead of being lost.
+ *
+ * The Game Thread only encodes records into a buffer, which is handed once per frame to a worker thread that
+ * appends it to the file. Moves are coalesced: a moved component is only marked dirty, and its latest transform
+ * is journaled on Commit (e.g. at the end of a drag) or every RuntimeTransformer.Journal.FlushInterval seconds.
+ *
+ * A journal builds on a Layout snapshot (its base, named in the header).
+ * Reset starts a new, empty journal on a new base, which is how the journal is compacted.
+ *
+ * File: header, base snapshot file name (UTF-8), then the records: ETransformerJournalOp + its data (native endianness).
+ * Objects are referenced by Id: the index of their record in the base snapshot, or the Id given by a Define / Clone record.
+ */
+class RUNTIMETRANSFORMER_API FTransformerJournal
+{
+public:
+
+	//PreviousBase: snapshot the file at FilePath was based on, which is deleted once the file is replaced by Reset
+	FTransformerJournal(const UTransformerLayout& InLayout, const FString& InFilePath, bool bInRecordSelection
+		, const FString& PreviousBase = FString());
+
+	//Waits until everything journaled is written
+	~FTransformerJournal();
+
+	/*
+	 * Replaces the file with a new, empty journal based on the given snapshot (already written)
+	 * @param BaseIds - Id (record index) of each object in the snapshot
+	 */
+	void Reset(const FString& BasePath, TMap<FObjectKey, int32>&& BaseIds, int32 BaseCount);
+
+	void MarkDirty(class USceneComponent* Component);
+	void AppendClone(UObject* Clone, UObject* Template);
+	void AppendDelete(UObject* Object);
+
+	//SoftDelete or Restore record of the Actor
+	void AppendSoftDelete(class AActor* Actor, bool bRestored);
+	void AppendSelection(const TArray<class USceneComponent*>& Components);
+
+	//Journals the latest transform of the dirty components
+	void Commit();
+
+	//Commits if the Flush Interval has elapsed and hands the records of the frame to the worker thread
+	void Tick();
+
+	const FString& GetFilePath() const { return FilePath; }
+
+	//Whether the file could not be (re)started, so that nothing journaled since is being written
+	bool HasFailed() const;
+
+	bool IsRecordingSelection() const { return bRecordSelection; }
+
+	/*
+	 * Reads the header of a journal.
+	 * @param OutBasePath - full path of the snapshot the journal is based on
+	 * @param OutRecordsOffset - where the records start
+	 */
+	static bool ReadHeader(const TArray<uint8>& Data, const FString& JournalPath, FString& OutBasePath, int64& OutRecordsOffset);
+
+private:
+
+	//Id of the Object, defining it first if it wasn't. INDEX_NONE if it can't be referenced
+	int32 GetId(UObject* Object);
+
+	void Write(const void* Data, int32 Size) { Pending.Append((const uint8*)Data, Size); }
+	void WriteTransform(const FTransform& Transform);
+
+	const UTransformerLayout& Layout;
+	FString FilePath;
+	FString BasePath;
+	bool bRecordSelection;
+
+	TMap<FObjectKey, int32> Ids;
+	int32 NextId;
+
+	TSet<TWeakObjectPtr<class USceneComponent>> Dirty;
+	double LastCommitTime;
+
+	//records not handed to the worker yet
+	TArray<uint8> Pending;
+
+	TUniquePtr<class FTransformerJournalWriter> Writer;
+};
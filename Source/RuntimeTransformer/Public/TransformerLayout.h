@@ -0,0 +1,161 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "TransformerLayout.generated.h"
+
+/**
+ * Keeps track of what the Transformer Pawns (with authority) edited in a World: the components moved,
+ * the clones made (and what they were cloned from) and the objects deleted,
+ * so that the layout can be saved into a binary snapshot and restored later on (e.g. in a new session of the same level).
+ *
+ * Objects are identified by their path (without PIE prefix), which is stable for anything loaded with the level.
+ * Clones are not: they're saved as "a clone of record N", and spawned again when loading.
+ * Components of cloned Actors are saved by name, relative to the record of their Actor.
+ * Instances (Clone As Instances) and Pasted Actors are not part of the layout, nor are Clones of Clones that have been destroyed since.
+ *
+ * Snapshot (native endianness):
+ *	FLayoutHeader | FLayoutRecord[RecordCount] | names (UTF-8)
+ * Records are fixed size, so loading maps the file and reads them in place. Every record only references records before it.
+ *
+ * The edits can also be journaled as they happen (StartJournal, @see FTransformerJournal),
+ * so that a session that crashed can be replayed (ReplayJournal).
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerLayout : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UTransformerLayout();
+	virtual ~UTransformerLayout();
+
+	static UTransformerLayout* Get(const UObject* WorldContextObject);
+
+	//Records that the Component has been moved
+	void RecordTransform(class USceneComponent* Component);
+
+	//Records that the Clone (Actor or Scene Component) was cloned from the Template
+	void RecordClone(UObject* Clone, UObject* Template);
+
+	//Records that the Object (Actor or Component) is about to be destroyed
+	void RecordDestroyed(UObject* Object);
+
+	/*
+	 * Records that the Actor was soft deleted (parked in the UTransformerActorPool) or brought back from it.
+	 * Only journaled: snapshots get what is parked from the pool itself.
+	 */
+	void RecordSoftDeleted(class AActor* Actor, bool bRestored = false);
+
+	//Records the Selection of a Pawn (only journaled, if the journal records selections)
+	void RecordSelection(const TArray<class USceneComponent*>& Components);
+
+	//Whether the Object was cloned (and tracked as such)
+	bool IsClone(const UObject* Object) const { return CloneTemplates.Contains(Object); }
+
+	/*
+	 * Writes everything edited so far into a snapshot file.
+	 * @return true if the file was written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool ExportLayout(const FString& FilePath) const;
+
+	/*
+	 * Applies a snapshot written by ExportLayout: spawns the clones, moves the edited components (in bulk, one
+	 * scoped movement update per Actor) and destroys the deleted objects. What is applied is tracked as edited.
+	 * Records whose object can't be found (e.g. snapshot of another level) are skipped.
+	 * @return false if the file could not be read or is not a valid snapshot
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool ImportLayout(const FString& FilePath);
+
+	//Forgets everything edited so far (the World is left as is)
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void ResetLayout();
+
+	/*
+	 * Starts journaling every edit into the given file, on top of a snapshot of everything edited so far
+	 * (written next to it). A journal already at that path is replaced, so replay it first if it's needed.
+	 * @param bRecordSelection - whether Selection changes are journaled too
+	 * @return false if the snapshot could not be written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool StartJournal(const FString& FilePath, bool bRecordSelection = false);
+
+	//Stops journaling, once everything journaled is written
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void StopJournal();
+
+	//Writes a new snapshot with everything edited so far and starts the journal over on it
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool CompactJournal();
+
+	//Journals the transforms moved since the last commit now (e.g. a drag has ended)
+	void CommitJournal();
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsJournaling() const { return Journal.IsValid(); }
+
+	/*
+	 * Imports the snapshot a journal is based on, and then applies the edits journaled (up to the last whole record).
+	 * @param SelectionPawn - Pawn that gets the last journaled Selection (if any)
+	 * @return false if the journal or its snapshot could not be read
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool ReplayJournal(const FString& FilePath, class ATransformerPawn* SelectionPawn = nullptr);
+
+	//Number of components moved, clones made and objects deleted tracked so far
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	int32 GetEditedObjectCount() const { return EditedComponents.Num() + Clones.Num() + DeletedObjects.Num(); }
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	/*
+	 * @param OutRecordIndices - record index of each object written
+	 * @param OutRecordCount - number of records written
+	 */
+	bool ExportLayoutFile(const FString& FilePath, TMap<FObjectKey, int32>* OutRecordIndices, int32* OutRecordCount) const;
+
+	//@param OutObjects - object of each record (nullptr if it couldn't be found or spawned)
+	bool ImportLayoutFile(const FString& FilePath, TArray<UObject*>* OutObjects);
+
+	//Finds the object by Name within Outer, or by path if there's no Outer
+	static UObject* ResolveObject(UObject* Outer, const FString& Name);
+
+	//Clones the Template (Actor or Scene Component) and records it. Component Clones go under AttachParent (or where the Template is)
+	UObject* SpawnClone(UObject* Template, class USceneComponent* AttachParent, const FTransform& Transform);
+
+	//Destroys a Component deleted by a Layout or Journal (freeing its id in the Selectable Registry)
+	void DestroyComponent(class UActorComponent* Component);
+
+	struct FDeletedObject
+	{
+		//Cloned Actor the object was in (Name relative to it). Null if Name is a full path
+		TWeakObjectPtr<AActor> CloneOwner;
+		FString Name;
+	};
+
+	TSet<TWeakObjectPtr<class USceneComponent>> EditedComponents;
+
+	//Clone - Template
+	TMap<TWeakObjectPtr<UObject>, TWeakObjectPtr<UObject>> CloneTemplates;
+
+	//Clones in the order they were made (a Template is always before its Clones)
+	TArray<TWeakObjectPtr<UObject>> Clones;
+	int32 ClonesPruneSize = 1024;
+
+	TArray<FDeletedObject> DeletedObjects;
+
+	TUniquePtr<class FTransformerJournal> Journal;
+
+	friend struct FLayoutWriter;
+};
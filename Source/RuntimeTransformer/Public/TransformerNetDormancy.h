@@ -0,0 +1,65 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "TransformerNetDormancy.generated.h"
+
+/**
+ * Server: per-World Net Dormancy of the Actors being edited (ATransformerPawn with Manage Net Dormancy).
+ * An Actor is woken up (DORM_Awake) when a first editor starts editing it, and each editor releases it with its own timeout.
+ * Once no editor is left, the Actor goes back to the Net Dormancy it had before it was woken up
+ * (DORM_Initial goes back as DORM_DormantAll, as it can't be set at runtime).
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerNetDormancy : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UTransformerNetDormancy* Get(const UObject* WorldContextObject);
+
+	//Keeps the Actor awake until the Editor releases it
+	void Wake(AActor* Actor, const UObject* Editor);
+
+	//The Editor is done with the Actor: it stops keeping it awake Timeout seconds from now. Does nothing if it wasn't editing it
+	void Release(AActor* Actor, const UObject* Editor, float Timeout);
+
+	//Release for all the Actors the Editor is editing
+	void ReleaseAll(const UObject* Editor, float Timeout);
+
+	//The Editor stops keeping any Actor awake right away (e.g. it's gone)
+	void RemoveEditor(const UObject* Editor);
+
+	bool IsAwake(const AActor* Actor) const { return AwakeActors.Contains(Actor); }
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	struct FAwakeActor
+	{
+		//what it goes back to once no editor is left
+		TEnumAsByte<ENetDormancy> OriginalDormancy = DORM_Awake;
+
+		//time (FPlatformTime::Seconds) each editor stops keeping it awake. 0 while editing
+		TMap<TWeakObjectPtr<const UObject>, double> Editors;
+	};
+
+	//Removes the editors whose release time has passed (up to Now), restoring the Actors left without any
+	void ExpireEditors(double Now);
+
+	//Puts the Actor back to the Net Dormancy it had
+	static void Restore(AActor* Actor, const FAwakeActor& Awake);
+
+	TMap<TWeakObjectPtr<AActor>, FAwakeActor> AwakeActors;
+
+	//earliest release time of all the editors (0 if none is released)
+	double NextExpireTime = 0.0;
+};
@@ -0,0 +1,97 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Net Stats are compiled out of Shipping builds. They are only meant for load testing / profiling
+#ifndef RUNTIMETRANSFORMER_NET_STATS
+#define RUNTIMETRANSFORMER_NET_STATS !UE_BUILD_SHIPPING
+#endif
+
+/**
+ * Per-Process counters for the Replicated Runtime Transformer path.
+ * Every RPC that actually crosses the wire is recorded on the receiving end (with an estimate of its payload),
+ * together with reliable buffer usage, selection convergence times and resync counts.
+ *
+ * Game Thread only. Use ToJson / DumpToFile (or the RuntimeTransformer.NetStats.Dump console command) to get a report.
+ */
+class RUNTIMETRANSFORMER_API FTransformerNetStats
+{
+public:
+
+	static FTransformerNetStats& Get();
+
+	struct FRpcStats
+	{
+		int32 Calls = 0;
+		int64 EstimatedBytes = 0;
+	};
+
+	//Records an RPC received from the network. PayloadBytes is an estimate of the serialized parameters
+	void RecordRpc(const FName& RpcName, int32 PayloadBytes);
+
+	//Records the time (seconds) it took for a client request to be answered by the Server
+	void RecordConvergence(double Seconds);
+
+	//Records a call to ATransformerPawn::ResyncSelection that actually re-requested the selection
+	void RecordResync();
+
+	//Records a Predicted Selection that did not match the Server's and had to be rolled back
+	void RecordSelectionRollback();
+
+	//Records a Selection Checksum mismatch and how many groups had to be resent
+	void RecordDesyncGroups(int32 GroupCount);
+
+	//Records how long (seconds) a queued Server Edit waited before it started running
+	void RecordEditWait(double Seconds);
+
+	//Samples the number of Server Edits queued in the UTransformerEditScheduler
+	void SampleEditQueueDepth(int32 Depth);
+
+	//Samples the number of unacknowledged reliable bunches for a channel (UChannel::NumOutRec)
+	void SampleReliableBuffer(int32 NumOutRec);
+
+	//Resets all counters and restarts the session clock
+	void Reset();
+
+	//Returns a JSON report of all the counters. Role is written as-is (e.g. "Server", "Client")
+	FString ToJson(const FString& Role) const;
+
+	//Writes ToJson into the given file. Returns true on success
+	bool DumpToFile(const FString& FilePath, const FString& Role) const;
+
+	/* Payload Estimates (bytes) for the parameter types used by the ATransformerPawn RPCs */
+	static int32 EstimateObjectArray(int32 Num) { return 2 + Num * 4; }
+	static int32 EstimateTransform() { return 10 * sizeof(float); }
+	static int32 EstimateVector() { return 3 * sizeof(float); }
+
+private:
+
+	FTransformerNetStats();
+
+	TMap<FName, FRpcStats> Rpcs;
+
+	int32	ResyncCount;
+	int32	SelectionRollbackCount;
+	int32	DesyncCount;
+	int32	DesyncGroupCount;
+
+	int32	ConvergenceSamples;
+	double	ConvergenceTotal;
+	double	ConvergenceMax;
+
+	int32	EditWaitSamples;
+	double	EditWaitTotal;
+	double	EditWaitMax;
+
+	int32	EditQueueSamples;
+	int64	EditQueueTotal;
+	int32	EditQueuePeak;
+
+	int32	ReliableBufferSamples;
+	int64	ReliableBufferTotal;
+	int32	ReliableBufferPeak;
+
+	double	SessionStartTime;
+};
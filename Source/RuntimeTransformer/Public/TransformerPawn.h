@@ -4,7 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "WorldCollision.h"
 #include "RuntimeTransformer.h"
+#include "TransformerUndoHistory.h"
+#include "TransformerSelectionBounds.h"
+#include "TransformerSelectionQuery.h"
 #include "TransformerPawn.generated.h"
 
 UENUM(BlueprintType)
@@ -13,6 +17,96 @@ enum class EGizmoPlacement : uint8
 	GP_None					UMETA(DisplayName = "None"),
 	GP_OnFirstSelection		UMETA(DisplayName = "On First Selection"),
 	GP_OnLastSelection		UMETA(DisplayName = "On Last Selection"),
+	GP_OnBoundsCenter		UMETA(DisplayName = "On Bounds Center"),
+	GP_OnCentroid			UMETA(DisplayName = "On Centroid"),
+};
+
+//What of the Selection Align Selection lines up
+UENUM(BlueprintType)
+enum class ESelectionAlignment : uint8
+{
+	SA_Min					UMETA(DisplayName = "Min"),
+	SA_Center				UMETA(DisplayName = "Center"),
+	SA_Max					UMETA(DisplayName = "Max"),
+};
+
+//When the clones of a Time Sliced Clone get Selected
+UENUM(BlueprintType)
+enum class ECloneSelectionUpdate : uint8
+{
+	CSU_Incremental			UMETA(DisplayName = "Incremental"),
+	CSU_OnFinish			UMETA(DisplayName = "On Finish"),
+};
+
+//Frame Time spent by a Time Sliced Clone
+USTRUCT(BlueprintType)
+struct FTransformerCloneStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	int32 ClonesSpawned = 0;
+
+	//Frames in which clones were spawned
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	int32 Frames = 0;
+
+	//Milliseconds spent cloning in the worst frame
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	float MaxFrameMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	float AverageFrameMs = 0.f;
+
+	//Seconds from the start of the Clone until it finished (or was cancelled)
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	float TotalSeconds = 0.f;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FTransformerCloneProgressDelegate, int32, ClonesDone, int32, ClonesTotal);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FTransformerCloneFinishedDelegate, const TArray<class USceneComponent*>&, Clones, bool, bCancelled);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FTransformerSelectionQueryDelegate, int32, QueryId, const TArray<class USceneComponent*>&, Selected);
+
+/**
+ * What the Server multicasts when it clones (ServerCloneSelected), so that every client
+ * spawns the same clones locally instead of waiting for them to be replicated.
+ * Entries are parallel: Template[i] was cloned into a clone with Transforms[i] and CloneIds[i].
+ */
+USTRUCT()
+struct FTransformerCloneCommand
+{
+	GENERATED_BODY()
+
+	//Actor Cloning: the Actors that were cloned
+	UPROPERTY()
+	TArray<AActor*> TemplateActors;
+
+	//Component Cloning: the Components that were cloned
+	UPROPERTY()
+	TArray<class USceneComponent*> TemplateComponents;
+
+	//World Transform of each clone (root component for actors)
+	UPROPERTY()
+	TArray<FTransform> Transforms;
+
+	//Server assigned Id of each clone. Used to bind the client clones to the Server ones
+	UPROPERTY()
+	TArray<int32> CloneIds;
+
+	UPROPERTY()
+	bool bComponentBased = false;
+
+	UPROPERTY()
+	bool bSelectNewClones = true;
+
+	UPROPERTY()
+	bool bAppendToList = false;
+
+	//The Selection Request Id of the Server when cloning
+	UPROPERTY()
+	int32 RequestId = 0;
+
+	int32 Num() const { return CloneIds.Num(); }
 };
 
 UCLASS()
@@ -26,6 +120,8 @@ public:
 	virtual void GetLifetimeReplicatedProps(
 		TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 
 	//Gets the UFocusable Object. If ComponentBased, returns the UFocusable Component or nullptr (if it doesn't implement)
@@ -47,6 +143,25 @@ private:
 	//Used to Filter unwanted things from a list of OutHits.
 	void FilterHits(TArray<FHitResult>& outHits);
 
+	/*
+	 * Server: Wakes the Owner of the Component from Net Dormancy while it's being edited (selected / moved).
+	 * Does nothing if bManageNetDormancy is false.
+	 */
+	void WakeForEditing(class USceneComponent* Component);
+
+	//Server: the actors edited by this Pawn go back to their Net Dormancy NetDormancyTimeout seconds from now (unless other Pawns edit them)
+	void ScheduleEditedActorsDormancy();
+
+	//Server: records the committed transforms of the Selection in the Edit State (for late joiners)
+	void RecordCommittedTransforms();
+
+	/*
+	 * The Transform of the Selection has been committed: edited actors can go Dormant again, the committed transforms are recorded
+	 * and the Undo Transform / Journal are closed. Done by ClearDomain, and by the Server after applying a remote drag
+	 * (ServerApplyTransform arrives after ServerClearDomain)
+	 */
+	void CommitTransformEdit();
+
 public:
 
 	/*
@@ -86,6 +201,115 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void ClearDomain();
 
+	/*
+	 * Duplicate Drag (e.g. while Alt is held): dragging the Gizmo drags render-only ghosts of the Selection
+	 * (copies of its Static Meshes, without collision, ticking or replication) while the Selection stays in place.
+	 * On release, the clones are made in one batch at the final transforms and become the Selection:
+	 * ClearDomain does it in Standalone, ReplicateFinishTransform (Server Clone + Apply Transform) in a networked game.
+	 * CancelDuplicateDrag discards the ghosts, so nothing is ever spawned for an aborted duplication.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetDuplicateDrag(bool bDuplicate);
+
+	//Whether a Duplicate Drag is in progress (i.e. ghosts are being dragged)
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsDuplicateDragging() const { return bDuplicateDragging; }
+
+	/*
+	 * Collision Aware Drag: a Translation stops at the first blocking hit instead of moving things into walls.
+	 * The move of each frame is resolved with async box sweeps of the bounds of the roots being moved
+	 * (i.e. moved Components not attached to another moved Component), all issued at once,
+	 * and is applied the next frame, clamped at the nearest blocking hit of any root.
+	 * Things already overlapping where the drag starts don't block it, and the Selection doesn't block itself.
+	 * @param bCombinedShape - sweep a single box around all the roots instead of one box per root (cheaper, coarser)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetCollisionAwareDrag(bool bEnabled, bool bCombinedShape = false);
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsCollisionAwareDragEnabled() const { return bCollisionAwareDrag; }
+
+	//Discards the ghosts of the Duplicate Drag in progress without cloning anything, and ends the drag
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void CancelDuplicateDrag();
+
+	/*
+	 * Reverts the last edit of the Undo History: a Transform (a whole drag is one edit), a Selection change or a Delete.
+	 * The History is kept where the edits are authoritative (Standalone / Server), so Clients ask the Server (ServerUndo)
+	 * and the result replicates like any other edit.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void Undo();
+
+	//Applies again the last edit that was undone. @see Undo
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void Redo();
+
+	//Whether there is something to Undo in this machine's History (always false for Clients, the History is in the Server)
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool CanUndo() const { return UndoHistory.CanUndo(); }
+
+	//Whether there is something to Redo in this machine's History (always false for Clients, the History is in the Server)
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool CanRedo() const { return UndoHistory.CanRedo(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void ClearUndoHistory();
+
+	/*
+	 * Turns the recording of the Undo History on / off (it's off by default).
+	 * Deletes keep a serialized copy of the deleted Actors (unless soft deleted) while it's on. Turning it off clears the History
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetRecordUndoHistory(bool bRecord);
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsRecordingUndoHistory() const { return bRecordUndoHistory; }
+
+	/*
+	 * Drops each root of the Selection (i.e. Selected Components not attached to another Selected Component)
+	 * straight down until the bottom of its bounds rests on the first thing below that blocks GroundTraceChannel.
+	 * All the roots are traced at once (async) and the results are applied the next frame as a single edit
+	 * (one Undo entry, one Multicast). Over a Landscape, the ground is sampled from its heightfield instead of tracing
+	 * down to it (the trace only looks for things on top of it). Roots with nothing below are left as they are.
+	 * Done in the Server for Clients.
+	 * @param bAlignToNormal - whether the up axis of each root is also rotated to the normal of the ground under it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void DropSelectionToGround(bool bAlignToNormal = false);
+
+	//Whether a Drop Selection To Ground is waiting for its traces
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsDroppingToGround() const { return DropToGround.IsValid(); }
+
+	/*
+	 * Lines up the roots of the Selection (i.e. Selected Components not attached to another Selected Component)
+	 * on the min, center or max of the Selection along the axes of the Domain (e.g. XY Plane aligns on X and Y).
+	 * Like the rest of the layout operations (Distribute, Randomize), it's a single edit: one Undo entry,
+	 * one Multicast, and every Component goes through the same notifications as a Gizmo transform.
+	 * Done in the Server for Clients.
+	 * @param bUseBounds - whether the bounds of the roots are lined up rather than their locations
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void AlignSelection(ETransformationDomain Axes, ESelectionAlignment Alignment, bool bUseBounds = true);
+
+	/*
+	 * Spaces the roots of the Selection evenly along the axes of the Domain, between the first and the last on each axis
+	 * (which stay where they are).
+	 * @param bUseBounds - whether the gaps between the bounds of the roots are made equal rather than the distances between their locations
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void DistributeSelection(ETransformationDomain Axes, bool bUseBounds = true);
+
+	/*
+	 * Rotates and scales each root of the Selection by a random amount.
+	 * @param RotationJitter - max rotation (each way) about each local axis
+	 * @param ScaleJitter - max fraction by which the scale grows or shrinks (uniformly)
+	 * @param Seed - the same Seed on the same Selection gives the same result. 0 for a random Seed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void RandomizeSelection(FRotator RotationJitter, float ScaleJitter, int32 Seed = 0);
+
 	//Gets the Start and End Points of the Mouse based on the Player Controller possessing this pawn
 	// returns true if outStartPoint and outEndPoint were given a successful value
 	bool GetMouseStartEndPoints(float TraceDistance, FVector& outStartPoint, FVector& outEndPoint);
@@ -311,6 +535,18 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void SetTransformationType(ETransformationType TransformationType);
+
+	/*
+	 * Sets where the Gizmo is placed when multiple objects are selected (and the pivot the Selection rotates / scales around).
+	 * On Bounds Center / On Centroid, the Gizmo is on the center of the bounds / the mean location of the Selection:
+	 * these are kept up to date as Components are selected, deselected and transformed (@see FTransformerSelectionBounds),
+	 * and the Gizmo follows them when the Selection moves.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetGizmoPlacement(EGizmoPlacement Placement);
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	EGizmoPlacement GetGizmoPlacement() const { return GizmoPlacement; }
 	
 	/*
 	 * Enables/Disables Snapping for a given Transformation
@@ -330,6 +566,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void SetSnappingValue(ETransformationType TransformationType, float SnappingValue);
 
+	/*
+	 * Enables/Disables Vertex Snapping for Translation: while dragging, the Gizmo jumps to the vertex
+	 * of the Static Meshes around that is nearest to the cursor, if there's one within ScreenRadius pixels of it
+	 * (otherwise it moves as usual, with grid Snapping if enabled). The Selection is not snapped to itself.
+	 * @see UTransformerVertexSnapping
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetVertexSnapping(bool bEnabled, float ScreenRadius = 16.f);
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsVertexSnappingEnabled() const { return bVertexSnapping; }
+
 	/*
 	 * Gets the list of Selected Components.
 
@@ -353,6 +601,91 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void CloneSelected(bool bSelectNewClones = true, bool bAppendToList = false);
 
+	/*
+	* Same as CloneSelected, but the Actors are spawned over several frames (at most CloneBudgetMs per frame,
+	* at least one Actor per frame) so that cloning many or complex Actors does not hitch.
+	* Component Based cloning still happens all in one frame, since the reparenting needs every clone of the hierarchy.
+	* Progress is reported through OnCloneProgress and the end through OnCloneFinished.
+	* Only one Time Sliced Clone can be in progress at a time.
+
+	* @param bSelectNewClones - whether to add the new clones to the Selection
+	* @param bAppendToList - If the New Clones are selected, whether to Append them to the List or Clear the previous Selections
+	* @param SelectionUpdate - If the New Clones are selected, whether they are selected as they spawn or all at once at the end
+	* @return whether the Clone started (false if there is another one in progress)
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool CloneSelectedTimeSliced(bool bSelectNewClones = true, bool bAppendToList = false
+		, ECloneSelectionUpdate SelectionUpdate = ECloneSelectionUpdate::CSU_OnFinish);
+
+	/*
+	* Stops the Time Sliced Clone in progress (if any). OnCloneFinished is called with bCancelled set.
+	* @param bDestroyClones - whether to destroy the clones spawned so far
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void CancelTimeSlicedClone(bool bDestroyClones = true);
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool IsTimeSlicedCloneInProgress() const;
+
+	//Clones spawned so far by the Time Sliced Clone in progress (empty if there's none)
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	TArray<class USceneComponent*> GetTimeSlicedClones() const;
+
+	/*
+	* Replaces the Selected Static Mesh Actors with instances in the ATransformerInstancedMeshes of the World
+	* (one Instanced Component per unique Mesh and Materials). The Actors are deselected and destroyed.
+	* Selected Actors that can't be instanced are left as they are.
+	* Instances are not replicated, so this is meant for Standalone.
+
+	* @return the number of Actors baked into instances
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int32 BakeSelectedToInstances();
+
+	/*
+	* Copies the Actors of the Selection into the Clipboard (FTransformerClipboard), replacing what it had.
+	* Their transforms are kept relative to the current Transform Pivot (where the Gizmo is).
+	* @return the number of Actors copied
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int32 CopySelected();
+
+	/*
+	* Spawns the contents of the Clipboard at the Target (the Transform Pivot at the time of the Copy is placed at the Target).
+	* The copied Actors don't need to exist anymore.
+
+	* @param bSelectNewClones - whether to add the pasted Actors to the Selection
+	* @param bAppendToList - If the pasted Actors are selected, whether to Append them to the List or Clear the previous Selections
+	* @return the Root Components of the pasted Actors
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	TArray<class USceneComponent*> Paste(const FTransform& Target, bool bSelectNewClones = true, bool bAppendToList = false);
+
+	//Same as Paste, but spawns a copy of the Clipboard at each of the Targets in one call
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	TArray<class USceneComponent*> PasteAtTransforms(const TArray<FTransform>& Targets
+		, bool bSelectNewClones = true, bool bAppendToList = false);
+
+	//Writes the Clipboard to a file, so that it can be pasted in another level or session. Returns true on success
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	static bool ExportClipboard(const FString& FilePath);
+
+	//Replaces the Clipboard with the contents of a file written by ExportClipboard. Returns true on success
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	static bool ImportClipboard(const FString& FilePath);
+
+	//Frame Time stats of the Time Sliced Clone in progress, or of the last one if none is
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	FTransformerCloneStats GetTimeSlicedCloneStats() const { return TimeSlicedCloneStats; }
+
+	//Called every frame a Time Sliced Clone spawns clones
+	UPROPERTY(BlueprintAssignable, Category = "Runtime Transformer")
+	FTransformerCloneProgressDelegate OnCloneProgress;
+
+	//Called when a Time Sliced Clone is done or cancelled, with all the clones it spawned (that still exist)
+	UPROPERTY(BlueprintAssignable, Category = "Runtime Transformer")
+	FTransformerCloneFinishedDelegate OnCloneFinished;
+
 protected:
 
 	TArray<class USceneComponent*> CloneFromList(
@@ -363,8 +696,141 @@ private:
 	TArray<class USceneComponent*> CloneActors(
 		const TArray<AActor*>& Actors);
 
+	//Spawns a single clone of the Template Actor (or reuses a soft deleted one). Returns nullptr if it could not be spawned
+	AActor* CloneActor(AActor* TemplateActor);
+
+	//Adds an instance for each Template that is a Static Mesh Actor. Returns the Templates that could not be instanced
+	TArray<AActor*> CloneActorsAsInstances(const TArray<AActor*>& TemplateActors);
+
+	//Vertex Snapping Delta Transform for the current drag. False if there's no vertex near the cursor
+	bool GetVertexSnappedTransform(const FVector& RayOrigin, const FVector& RayDirection, FTransform& outDeltaTransform) const;
+
+	//Layout where the edits of this machine are tracked (nullptr if this machine doesn't have authority)
+	class UTransformerLayout* GetEditLayout() const;
+
+	//Whether Actor deletes only park the Actors (bSoftDelete, Standalone)
+	bool ShouldSoftDelete() const;
+
+	//Whether edits are recorded in the Undo History in this machine
+	bool ShouldRecordUndo() const;
+
+	void PushUndoEntry(FTransformerUndoEntry&& Entry);
+
+	//Starts tracking the Component for the open Transform entry (if it wasn't already)
+	void RecordUndoTransform(class USceneComponent* Component);
+
+	//Pushes the open Transform entry (the components that actually moved) into the Undo History
+	void CloseUndoTransform();
+
+	//Pushes the Selection change since the last one recorded (if any) into the Undo History
+	void FlushUndoSelection();
+
+	//The Selection as it is now is the one the next Selection entry is recorded against
+	void ResetUndoSelection();
+
+	//Applies the Undo (or Redo) entry. Authority only
+	void ApplyUndoEntry(bool bUndo);
+
+	//Spawns the ghosts of the Selection and moves the Gizmo onto them
+	void BeginDuplicateDrag();
+
+	//Destroys the ghosts. If bMaterialize, clones the Selection at the transforms of the ghosts and selects the clones
+	void EndDuplicateDrag(bool bMaterialize);
+
+	//Spawns a render-only copy of the Static Meshes of the Template (and its children). Returns the root of the ghost
+	class USceneComponent* SpawnDragGhost(class USceneComponent* Template) const;
+
+	//Applies (clamped) what was swept last frame. Returns the Translation applied
+	FVector ResolveDragSweeps();
+
+	//Sweeps the roots of what is being moved by Delta. Resolved next frame
+	void QueueDragSweeps(const FVector& Delta);
+
+	//Drops the sweeps of the drag and what was cached for them
+	void ResetDragSweeps();
+
+	struct FDragSweepRoot
+	{
+		TWeakObjectPtr<class USceneComponent> Root;
+		//Bounds of the Root (and what is attached to it) relative to the location of the Root
+		FBox Bounds;
+	};
+
+	//Components of the list not attached (directly or not) to another Component of the list
+	static void GetRootComponents(const TArray<class USceneComponent*>& Components, TArray<class USceneComponent*>& outRoots);
+
+	struct FDropToGround
+	{
+		struct FRoot
+		{
+			TWeakObjectPtr<class USceneComponent> Component;
+			FTraceHandle TraceHandle;
+			//from the bottom of the bounds to the location of the Component
+			double PivotHeight = 0.0;
+			//ground sampled from a Landscape heightfield (unset if there's no Landscape under the Component)
+			TOptional<double> LandscapeHeight;
+			FVector LandscapeNormal = FVector::UpVector;
+		};
+
+		TArray<FRoot> Roots;
+		TSet<const AActor*> IgnoredActors;
+		bool bAlignToNormal = false;
+		//the traces are done by the next frame
+		uint64 Frame = 0;
+	};
+
+	//Traces down from each root of the Selection
+	void BeginDropToGround(bool bAlignToNormal);
+
+	//Moves the roots onto what the traces found. Called in Tick, the frame after BeginDropToGround
+	void FinishDropToGround();
+
+	//Roots of the Selection as they are, for the layout operations to compute their transforms from
+	struct FSelectionLayoutItem
+	{
+		class USceneComponent* Component = nullptr;
+		FTransform Transform;
+		FBox Bounds = FBox(ForceInit);
+	};
+
+	//Movable roots of the Selection. Their bounds are read in parallel
+	void GatherSelectionLayout(TArray<FSelectionLayoutItem>& outItems) const;
+
+	/*
+	 * Sets the World Transforms of the Components as a single edit: through SetTransform (one Scoped Movement Update per Actor),
+	 * one Undo entry, and recorded / multicast for the Clients by the Server
+	 */
+	void CommitTransforms(const TArray<class USceneComponent*>& Components, const TArray<FTransform>& Transforms);
+
+	/*
+	 * Clones the given Components. If CloneNames is given (one per Component), the clones get these names,
+	 * are not replicated and are made Net Addressable, so that clones made with the same names
+	 * in the Server and in the Clients are the same object in the network.
+	 */
 	TArray<class USceneComponent*> CloneComponents(
-		const TArray<class USceneComponent*>& Components);
+		const TArray<class USceneComponent*>& Components
+		, const TArray<FName>* CloneNames = nullptr);
+
+	struct FTimeSlicedClone
+	{
+		//Actor Cloning clones the Template Actors a few per frame. Component Cloning clones all the Template Components at once
+		bool bComponentBased = false;
+		bool bCloneAsInstances = false;
+		TArray<TWeakObjectPtr<AActor>> TemplateActors;
+		TArray<TWeakObjectPtr<class USceneComponent>> TemplateComponents;
+		int32 NextTemplate = 0;
+		TArray<TWeakObjectPtr<class USceneComponent>> Clones;
+		bool bSelectNewClones = true;
+		bool bAppendToList = false;
+		ECloneSelectionUpdate SelectionUpdate = ECloneSelectionUpdate::CSU_OnFinish;
+		double StartTime = 0.0;
+		double TotalFrameMs = 0.0;
+	};
+
+	//Spawns the clones of the Time Sliced Clone for this frame. Called in Tick
+	void UpdateTimeSlicedClone();
+
+	void FinishTimeSlicedClone(bool bCancelled);
 
 public:
 
@@ -425,6 +891,39 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	TArray<class USceneComponent*> DeselectAll(bool bDestroyDeselected = false);
 
+	/**
+	 * Saves the current Selection as a named Selection Set of the UTransformerSelectableRegistry,
+	 * replacing the Set with that Name if there was one.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SaveSelectionSet(FName Name);
+
+	/**
+	 * Selects the Components of a named Selection Set (only the ones that Should Select).
+	 * Like Select Multiple Components, this only changes the Selection in this machine.
+	 * @param bAppendToList - whether to keep the currently Selected Components as well
+	 * @return false if there's no Set with that Name
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool SelectSelectionSet(FName Name, bool bAppendToList = false);
+
+	//Selects the Components of the Set (only the ones that Should Select). @see SelectSelectionSet
+	void SelectSet(const struct FTransformerSelectionSet& Set, bool bAppendToList = false);
+
+	/**
+	 * Selects the registered Components that match the Query (@see UTransformerSelectableRegistry::RunQuery).
+	 * They're matched in worker threads and Selected in one batch (only the ones that Should Select) a frame or more later,
+	 * when OnSelectionQueryApplied is called. Like Select Multiple Components, this only changes the Selection in this machine.
+	 * @param bAppendToList - whether to keep the currently Selected Components as well
+	 * @return the id OnSelectionQueryApplied is called with for this Query. INDEX_NONE if it couldn't be run
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int32 SelectByQuery(const FTransformerSelectionQuery& Query, bool bAppendToList = false);
+
+	//Called when the matches of a Select By Query are Selected, with the ones that got Selected
+	UPROPERTY(BlueprintAssignable, Category = "Runtime Transformer")
+	FTransformerSelectionQueryDelegate OnSelectionQueryApplied;
+
 private:
 
 	/*
@@ -434,6 +933,13 @@ private:
 	void AddComponent_Internal(TArray<class USceneComponent*>& OutComponentList
 		, class USceneComponent* Component);
 
+	//Selects the matches of a Select By Query in one batch
+	void ApplySelectionQuery(int32 QueryId, const TArray<TWeakObjectPtr<class USceneComponent>>& Matches, bool bAppendToList);
+
+	//AddComponent_Internal for a Component known not to be in the list (skips looking for it)
+	void AddNewComponent_Internal(TArray<class USceneComponent*>& OutComponentList
+		, class USceneComponent* Component);
+
 	/*
 	The core functionality, but can be called by Selection of Multiple objects
 	so as to not call UpdateGizmo every time
@@ -446,9 +952,31 @@ private:
 	/**
 	 * Creates / Replaces Gizmo with the Current Transformation.
 	 * It destroys any current active gizmo to replace it.
+	 * Gizmos are only created for Pawns controlled in this machine (never for remote editors or in a Dedicated Server)
 	*/
 	void SetGizmo();
 
+	//Whether this Pawn gets a Gizmo Actor in this machine
+	bool ShouldSpawnGizmo() const;
+
+	//The Selected Component the Gizmo is (or would be) placed on. nullptr if none (GP_None, or placed on the Selection Center)
+	class USceneComponent* GetGizmoPlacementComponent() const;
+
+	//Whether the Gizmo is placed on the bounds center / centroid of the Selection rather than on a Component
+	bool IsGizmoOnSelectionCenter() const;
+
+	//Bounds center / centroid of the Selection, depending on the Gizmo Placement. False if not placed on either
+	bool GetSelectionCenter(FVector& outCenter) const;
+
+	//The point the Selection rotates / scales around. Same as the Gizmo Location, but doesn't need a Gizmo
+	FVector GetTransformPivot() const;
+
+	/*
+	 * Shows / Hides the Remote Selection Indicator on the given Selected Component.
+	 * Hiding it puts back the Custom Depth the Component had, once no other remote Pawn shows it
+	 */
+	void SetRemoteSelectionIndicator(class USceneComponent* Component, bool bVisible) const;
+
 	/**
 	 * Updates the Gizmo Placement (Position)
 	 * Called when an object was selected, deselected
@@ -507,8 +1035,44 @@ public:
 		, const FName& ProfileName
 		, bool bAppendToList = false);
 
-	//Gets the List of Actors that will be ignored in the Server Trace(for now its only the current Gizmo of Actor)
-	//Since the Gizmo trace is handled locally (Gizmo appears differently to each player)
+	/*
+	* Same as ReplicatedMouseTraceByObjectTypes, but with a given Start and End Location
+	* rather than the Mouse Position (e.g. for headless clients or scripted sessions)
+
+	* @see ReplicatedMouseTraceByObjectTypes
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedTraceByObjectTypes(const FVector& StartLocation
+		, const FVector& EndLocation
+		, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+		, bool bAppendToList = false);
+
+	/*
+	* Same as ReplicatedMouseTraceByChannel, but with a given Start and End Location
+	* rather than the Mouse Position (e.g. for headless clients or scripted sessions)
+
+	* @see ReplicatedMouseTraceByChannel
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedTraceByChannel(const FVector& StartLocation
+		, const FVector& EndLocation
+		, TEnumAsByte<ECollisionChannel> CollisionChannel
+		, bool bAppendToList = false);
+
+	/*
+	* Same as ReplicatedMouseTraceByProfile, but with a given Start and End Location
+	* rather than the Mouse Position (e.g. for headless clients or scripted sessions)
+
+	* @see ReplicatedMouseTraceByProfile
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedTraceByProfile(const FVector& StartLocation
+		, const FVector& EndLocation
+		, const FName& ProfileName
+		, bool bAppendToList = false);
+
+	//Gets the List of Actors that will be ignored in the Server Trace.
+	//Empty since remote Pawns no longer have Gizmos in the Server (and other Gizmos are skipped when handling hits)
 	TArray<AActor*> GetIgnoredActorsForServerTrace() const;
 
 	//Syncs the Selected Components to the Clients (caller needs to be server)
@@ -523,35 +1087,41 @@ public:
 	/*
 	 * ServerCall, Reliable. Trace is performed in the Server.
 	 * Currently no Validation takes place.
+	 * RequestId is the Id of the Client's predicted selection, sent back with MulticastSetSelectedComponents (0 if not predicted)
 	 * @ see TraceByObjectTypes
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer", meta = (DeprecatedFunction))
 	void ServerTraceByObjectTypes(const FVector& StartLocation
 		, const FVector& EndLocation
 		, const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
-		, bool bAppendToList);
+		, bool bAppendToList
+		, int32 RequestId = 0);
 
 	/*
 	 * ServerCall, Reliable. Trace is performed in the Server.
 	 * Currently no Validation takes place.
+	 * RequestId is the Id of the Client's predicted selection, sent back with MulticastSetSelectedComponents (0 if not predicted)
 	 * @ see TraceByChannel
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer", meta = (DeprecatedFunction))
 	void ServerTraceByChannel(const FVector& StartLocation
 		, const FVector& EndLocation
 		, ECollisionChannel TraceChannel
-		, bool bAppendToList);
+		, bool bAppendToList
+		, int32 RequestId = 0);
 
 	/*
 	 * ServerCall, Reliable. Trace is performed in the Server.
 	 * Currently no Validation takes place.
+	 * RequestId is the Id of the Client's predicted selection, sent back with MulticastSetSelectedComponents (0 if not predicted)
 	 * @ see TraceByProfile, meta = (DeprecatedFunction)
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer", meta = (DeprecatedFunction))
 	void ServerTraceByProfile(const FVector& StartLocation
 		, const FVector& EndLocation
 		, const FName& ProfileName
-		, bool bAppendToList);
+		, bool bAppendToList
+		, int32 RequestId = 0);
 
 
 	/*
@@ -609,6 +1179,43 @@ public:
 	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
 	void MulticastDeselectAll(bool bDestroySelected);
 
+	/*
+	 * ServerCall, Reliable. Undo is performed in the Server, where the Undo History is.
+	 * The result goes to the Clients through the same Multicasts as any other edit.
+	 * @ see Undo
+	 */
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerUndo();
+
+	/*
+	 * ServerCall, Reliable. Redo is performed in the Server, where the Undo History is.
+	 * @ see Redo
+	 */
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerRedo();
+
+	/*
+	 * ServerCall, Reliable. Drop To Ground is performed in the Server and its result is multicast.
+	 * @ see DropSelectionToGround
+	 */
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerDropSelectionToGround(bool bAlignToNormal);
+
+	/*
+	 * ServerCall, Reliable. The layout operations are performed in the Server and their results are multicast.
+	 * @ see AlignSelection
+	 */
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerAlignSelection(ETransformationDomain Axes, ESelectionAlignment Alignment, bool bUseBounds);
+
+	//ServerCall, Reliable. @ see DistributeSelection
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerDistributeSelection(ETransformationDomain Axes, bool bUseBounds);
+
+	//ServerCall, Reliable. @ see RandomizeSelection
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerRandomizeSelection(FRotator RotationJitter, float ScaleJitter, int32 Seed);
+
 
 	/*
 	 * ServerCall, Reliable. SetSpaceType is performed in the Server.
@@ -674,25 +1281,30 @@ public:
 	* ServerCall, Reliable. CloneSelected is performed in the Server.
 	* Currently no Validation takes place. 
 
-	* WARNING: Component Cloning will NOT take place. (PluginLimitations.txt for details)
-
-	* NOTE: The Objects must be Replicating in order to be reflected in the Clients.
-	* Objects that are cloned are NOT directly handled but rather a Timer is used to check
-	* when the objects have finished beginplay, so that we are sure that the networking logic has been processed for them
+	* The Server then multicasts a Clone Command (MulticastCloneCommand) so that the clients spawn
+	* the same clones (and select them) locally, without waiting for the clones to be replicated.
+	* Works for both Actor and Component Cloning.
 
 	* @ see CloneSelected
-	* @ see CheckUnreplicatedActors
+	* @ see MulticastCloneCommand
 	*/
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerCloneSelected(bool bSelectNewClones = true
 		, bool bAppendToList = false);
 	
 	/*
-	 * A function called by a Timer that checks when a List of Actors have BegunPlay
-	 * and have been replicated. Once all Actors that are on the Unreplicated list have been processed,
-	 * the remaining functions such as MulticastSetSelectedComponents are called.
+	 * Multicast, Reliable. Clients make the clones described in the Command locally (and select them if required).
+	 * Actor Clones that replicate are temporary: they are replaced by the Server's clone once it arrives.
+	 * Component Clones get the same names as in the Server, so they are the same object in the network.
+	 */
+	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
+	void MulticastCloneCommand(const FTransformerCloneCommand& Command);
+
+	/*
+	 * Client: replaces the local clone made for the given Clone Id with the Server's Clone (that just arrived).
+	 * Returns false if this Pawn made no local clone with that Id.
 	 */
-	void CheckUnreplicatedActors();
+	bool BindCloneProxy(int32 CloneId, AActor* Clone);
 
 	/*
 	 * ServerCall, Reliable. SetDomain is performed in the Server.
@@ -719,13 +1331,163 @@ public:
 	/*
 	 * Multicast, Reliable. 
 	 * Syncs the SelectedComponents of the Server to the Clients.
+	 * The Selection is reconciled (only the differences are deselected/selected)
+	 * RequestId is the last predicted selection Id the Server processed for this Pawn. 
+	 * The owning client ignores replies older than its latest prediction.
 	 */
 	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastSetSelectedComponents(const TArray<USceneComponent*>& Components);
+	void MulticastSetSelectedComponents(const TArray<USceneComponent*>& Components, int32 RequestId);
 
 	//Tries to resync the Selections 
 	void ResyncSelection();
 
+	//Client: makes the Selection match the one in the Server Edit State (ATransformerEditState)
+	void ApplyReplicatedSelection(const TArray<USceneComponent*>& Components);
+
+	/*
+	 * ServerCall, Unreliable. The owning client's checksums of its Selection, one per group of DesyncGroupSize components
+	 * (which components are selected, and their transforms). The Server answers with ClientResendSelectionGroups
+	 * only for the groups that don't match its own.
+	 * RequestId is the latest Selection Request of the client. Checksums sent while a request is in flight are ignored.
+	 */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerCheckSelectionChecksums(int32 RequestId, int32 SelectionCount, const TArray<uint32>& GroupChecksums);
+
+	/*
+	 * ClientCall, Reliable. The Server's Selection & Transforms for the groups that mismatched.
+	 * Components / Transforms hold the components of each group in GroupIndices, one after the other.
+	 */
+	UFUNCTION(Client, Reliable)
+	void ClientResendSelectionGroups(int32 SelectionCount, const TArray<int32>& GroupIndices
+		, const TArray<USceneComponent*>& Components, const TArray<FTransform>& Transforms);
+
+	/**
+	 * Enables/Disables the Server Authoritative Drag.
+	 * @see bServerAuthoritativeDrag
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void SetServerAuthoritativeDrag(bool bServerAuthoritative);
+
+	/*
+	 * ServerCall, Unreliable. Streams the accumulated delta of the drag in progress (Server Authoritative Drag).
+	 * The Server applies it to its own selection and only answers with a ClientDragCorrection 
+	 * if the PredictedHash of the client doesn't match its own result
+	 */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerStreamDrag(int32 Sequence, const FTransform& AccumulatedDelta, uint32 PredictedHash);
+
+	/*
+	 * ServerCall, Reliable. Finishes the drag in progress (Server Authoritative Drag), 
+	 * applying whatever input was not received and multicasting the resulting transforms.
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFinishDrag(int32 Sequence, const FTransform& AccumulatedDelta);
+
+	/*
+	 * ClientCall, Unreliable. The Server's transforms of the Selection after applying the input with the given Sequence.
+	 * The difference with what the client predicted for that Sequence is blended in.
+	 */
+	UFUNCTION(Client, Unreliable)
+	void ClientDragCorrection(int32 Sequence, const TArray<USceneComponent*>& Components
+		, const TArray<FTransform>& Transforms);
+
+	/*
+	 * Multicast, Reliable. Sets the World Transforms of the given components in the Clients.
+	 * The owning client blends into them instead.
+	 */
+	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
+	void MulticastSetTransforms(const TArray<USceneComponent*>& Components
+		, const TArray<FTransform>& Transforms);
+
+private:
+
+	/*
+	 * Server: MulticastSetTransforms in chunks, so that a large Selection doesn't go over
+	 * the max replicated array size (net.MaxRepArraySize) or the max size of a reliable bunch
+	 */
+	void MulticastSetTransformsChunked(const TArray<USceneComponent*>& Components
+		, const TArray<FTransform>& Transforms);
+
+	//Whether this is the owning client of a Server Authoritative Drag
+	bool IsPredictingDrag() const;
+
+	//Client: Sends the drag input to the Server (throttled by DragStreamInterval) and saves the prediction for it
+	void StreamDragInput();
+
+	//Server: Applies the part of the AccumulatedDelta that has not been applied yet. False if the input is outdated
+	bool ApplyServerDragInput(int32 Sequence, const FTransform& AccumulatedDelta);
+
+	/*
+	 * Whether the Component is moved by an authority of its own: its physics simulation, or the player possessing its Pawn.
+	 * A Server Authoritative Drag leaves these out (on both ends, so that the hashes match) rather than fight that authority.
+	 */
+	static bool HasOwnMovementAuthority(const class USceneComponent* Component);
+
+	//Server: the Selected Components a Server Authoritative Drag moves, and their transforms
+	void GetServerDragTransforms(TArray<class USceneComponent*>& OutComponents, TArray<FTransform>& OutTransforms) const;
+
+	//Client: Puts back the predicted transforms on objects whose Replicated Movement overwrote them mid-drag
+	void RestorePredictedDragTransforms();
+
+	//Client: Queues the difference between the Predicted and the Authoritative Transform to be blended in
+	void AddDragCorrection(class USceneComponent* Component
+		, const FTransform& Predicted, const FTransform& Authoritative);
+
+	//Client: Blends in a part of the queued corrections
+	void BlendDragCorrections(float DeltaSeconds);
+
+	//Quantized Hash of the World Transforms of the given Components
+	static uint32 HashComponentTransforms(const TArray<class USceneComponent*>& Components);
+
+	//Combines the Quantized Hash of the World Transform of the Component into the given Hash
+	static uint32 HashComponentTransform(const class USceneComponent* Component, uint32 Hash);
+
+	//Checksum of a group of the Selection: the Network GUIDs of its components and their Transforms
+	uint32 GetSelectionGroupChecksum(int32 GroupIndex) const;
+
+	//Client: Sends the Selection Checksums to the Server (every DesyncCheckInterval, when nothing is in progress)
+	void SendSelectionChecksums();
+
+	//Client: Starts a new Predicted Selection (the local trace result) and returns its Id to send to the Server
+	int32 BeginPredictedSelection();
+
+	//Client: Makes the clones of a Clone Command. Returns the root (or component) of each clone made
+	TArray<class USceneComponent*> ExecuteCloneCommand(const FTransformerCloneCommand& Command);
+
+	//Starts the timer that re-requests the Server Selection until it matches the local one
+	void StartSelectionResync();
+
+	/*
+	 * Makes the Selection match the given list by only deselecting the components not in the list
+	 * and selecting the ones that are missing (keeping the given order). 
+	 * Returns true if the Selection changed (i.e. the prediction was wrong)
+	 */
+	bool ReconcileSelection(const TArray<class USceneComponent*>& Components);
+
+	/*
+	 * Server: runs the Edit of a Server RPC right away or queues it in the UTransformerEditScheduler.
+	 * Heavy edits are always queued. Light ones only if this Pawn already has queued edits (to keep the order).
+	 */
+	void ScheduleServerEdit(const TCHAR* CommandName, bool bHeavy, TFunction<void()>&& Edit);
+
+	//Server: queues an Edit that runs in Steps (each returns true once the Edit is finished)
+	void ScheduleServerEditSteps(const TCHAR* CommandName, TFunction<bool(double Deadline)>&& Step);
+
+	struct FServerCloneJob
+	{
+		TArray<TWeakObjectPtr<AActor>> TemplateActors;
+		int32 NextTemplate = 0;
+		bool bStarted = false;
+		bool bSelectNewClones = true;
+		bool bAppendToList = false;
+	};
+
+	//Server: clones (and multicasts the Clone Command for) as many templates of the Job as the Deadline allows
+	bool ServerCloneStep(FServerCloneJob& Job, double Deadline);
+
+	//Records an RPC in the FTransformerNetStats (only if it actually came through the network)
+	void RecordReceivedRpc(const TCHAR* RpcName, int32 PayloadBytes, bool bReceivedFromNetwork) const;
+
 	//Networking Variables
 private:
 
@@ -739,28 +1501,121 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
 	bool bIgnoreNonReplicatedObjects;
 
+	FTransform	NetworkDeltaTransform;
+
+	FTimerHandle	ResyncSelectionTimerHandle;
+
+	//Time (FPlatformTime::Seconds) at which this client last requested a Server Trace. 0 if there's no request pending
+	double ServerRequestTime;
+
+	//Client: local clones (by Clone Id) that are waiting for the Server's clone to arrive
+	TMap<int32, TWeakObjectPtr<AActor>> LocalCloneProxies;
+
 	/*
-	 * Optional minimum time to wait for all Cloned objects to fully replicate and are selectable.
-	 * It is not required, but there are occassions (especially when cloning multiple objects at once)
-	 * where the newly spawned clone objects are not selected on the client side because the object, 
-	 * although has begun play, is not still fully network addressable on the client side and so a nullptr is passed 
-	 * (so no selection occurs).
-	 * The time it actually takes to Replicate can be more because it also waits for all clone objects to have begun play.
+	 * Whether the Server manages the Net Dormancy of the edited actors.
+	 * Actors are woken up (FlushNetDormancy) when selected or moved, and go back to the Net Dormancy they had
+	 * NetDormancyTimeout seconds after the transform is committed (or they're deselected) by every Pawn editing them.
+	 * @see UTransformerNetDormancy
+	 * Meant for levels where the editable actors are Dormant by default, 
+	 * so that only the actors being edited are considered for replication.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	bool bManageNetDormancy;
+
+	//Seconds an edited actor stays awake after the transform was committed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	float NetDormancyTimeout;
+
+	/*
+	 * Whether the edits requested through the Server RPCs go through the UTransformerEditScheduler
+	 * (run under a per-frame budget, round-robin between Pawns) instead of running inside the RPC dispatch.
+	 * Off by default: edits run right away, as they always did.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	bool bScheduleServerEdits;
+
+	/*
+	 * Whether the owning client periodically checks its Selection (and the Transforms of it) against the Server's
+	 * through checksums. Only the groups that mismatch are resent.
+	 * Non owning clients get the Selections through the Edit State (ATransformerEditState) instead.
+	 * Off by default: the checksums are an extra RPC every DesyncCheckInterval for each owning client.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	bool bDetectDesync;
+
+	//Seconds between two Selection Checksums
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "0.1"))
+	float DesyncCheckInterval;
+
+	//Number of Selected Components hashed in each checksum (i.e. the granularity of the resends)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 DesyncGroupSize;
+
+	double LastDesyncCheckTime;
+
+	/*
+	* Server Authoritative Drag. The owning client streams its drag input to the Server, 
+	* which applies it to its own selection (the authority). The client keeps predicting locally
+	* and only gets corrections if it diverged from the Server, which are blended in rather than snapped.
+	* Replicated Movement of the dragged objects is not allowed to pull them back mid-drag.
+	* Objects that simulate physics or are Pawns possessed by a player keep their own authority and are not dragged.
+	* If false, the drag is purely local and only the final delta is sent (ReplicateFinishTransform)
 	*/
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
-	float MinimumCloneReplicationTime;
+	bool bServerAuthoritativeDrag;
 
-	//The frequency at which checks are done on newly spawned clones. Whether they are suitable for replication.
+	//Minimum time (seconds) between two drag inputs streamed to the Server
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
-	float CloneReplicationCheckFrequency;
+	float DragStreamInterval;
 
-	FTransform	NetworkDeltaTransform;
+	//Minimum time (seconds) between two corrections sent to a diverging client
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	float DragCorrectionInterval;
 
-	//List of clone actor/components that need replication but haven't been replicated yet
-	TArray<class USceneComponent*> UnreplicatedComponentClones;
+	//Differences smaller than this (Unreal Units for location, degrees for rotation) are not corrected
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	float DragCorrectionThreshold;
 
-	FTimerHandle	CheckUnrepTimerHandle;
-	FTimerHandle	ResyncSelectionTimerHandle;
+	//How fast corrections are blended in. Higher is faster (snappier)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
+	float DragCorrectionBlendSpeed;
+
+	struct FDragPrediction
+	{
+		int32 Sequence;
+		TArray<class USceneComponent*> Components;
+		TArray<FTransform> Transforms;
+	};
+
+	/*
+	 * Client: Sequence of the last streamed drag input.
+	 * Server: Sequence of the last applied drag input.
+	 */
+	int32 DragInputSequence;
+
+	//Client: what was predicted for each drag input that has not been corrected against yet
+	TArray<FDragPrediction> DragPredictionHistory;
+
+	//Client: the latest predicted transform of each dragged component
+	TMap<TWeakObjectPtr<class USceneComponent>, FTransform> PredictedDragTransforms;
+
+	//Client: the corrections (Authoritative - Predicted) still to be blended in
+	TMap<TWeakObjectPtr<class USceneComponent>, FTransform> DragCorrections;
+
+	//Server: the part of the drag's accumulated delta that has already been applied
+	FTransform ServerAppliedDragDelta;
+
+	//Server: whether the streamed drag input is being applied (@see HasOwnMovementAuthority)
+	bool bApplyingServerDragInput;
+
+	double LastDragStreamTime;
+	double LastDragCorrectionTime;
+
+	/*
+	 * Client: Id of the latest Predicted Selection sent to the Server.
+	 * Server: Id of the latest Selection Request processed for this Pawn.
+	 */
+	int32 LatestSelectionRequestId;
 
 
 	//Other Vars
@@ -818,6 +1673,9 @@ private:
 	 */
 	TArray<class USceneComponent*> SelectedComponents;
 
+	//Id of the last Select By Query
+	int32 LastSelectionQueryId = 0;
+
 	/*
 	* Map storing the Snap values for each transformation
 	* bSnappingEnabled must be true AND, the value for the current transform MUST NOT be 0 for these values to take effect.
@@ -835,6 +1693,14 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	TMap<ETransformationType, bool> SnappingEnabled;
 
+	//Whether Translation snaps to vertices. @see SetVertexSnapping
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bVertexSnapping;
+
+	//How near (in pixels) to the cursor a vertex has to be for Vertex Snapping
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	float VertexSnapScreenRadius;
+
 	/**
 	* Whether to Force Mobility on items that are not Moveable
 	* if true, Mobility on Components will be changed to Moveable (WARNING: does not set it back to its original mobility!)
@@ -861,6 +1727,18 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bTransformUFocusableObjects;
 
+	/*
+	 * Remote editors (Pawns not controlled in this machine) don't get Gizmos.
+	 * If true, the primitives they select render in Custom Depth with RemoteSelectionStencilValue instead,
+	 * so that a post process (e.g. outline) can show what others have selected, without spawning or ticking anything.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bShowRemoteSelectionIndicator;
+
+	//Custom Depth Stencil Value written by the Remote Selection Indicator
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "255"))
+	int32 RemoteSelectionStencilValue;
+
 	//Property that checks whether a CLICK on an already selected object should deselect the object or not.
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bToggleSelectedInMultiSelection;
@@ -873,6 +1751,122 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bComponentBased;
 
+	/*
+	 * Whether cloning (CloneSelected, CloneSelectedTimeSliced) makes Static Mesh Actors into instances
+	 * of the ATransformerInstancedMeshes of the World instead of spawning new Actors.
+	 * Instances can't be selected, so they're not added to the Selection. Other Actors are still cloned as Actors.
+	 * Only for Actor (not Component) cloning. The Server RPCs always clone Actors, since instances do not replicate.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bCloneAsInstances;
+
+	//Whether the instances (of Clone As Instances and BakeSelectedToInstances) go in Hierarchical Instanced Static Mesh Components
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bUseHierarchicalInstances;
+
+	/*
+	 * Whether deleting Actors (DeselectAll with bDestroyDeselected) only parks them in the UTransformerActorPool of the World
+	 * (hidden, no collision, no ticking) instead of destroying them, so an Undo of the Delete,
+	 * or cloning their Template again, brings them back without spawning. They're destroyed later on, a few per frame.
+	 * Standalone only: networked deletes are always destroys, since that's what Clients and late joiners get.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bSoftDelete;
+
+	/*
+	 * Whether Transforms, Selection changes and Deletes are recorded for Undo / Redo.
+	 * Off by default: recording a Delete serializes the deleted Actors (FTransformerClipboard) before destroying them
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bRecordUndoHistory;
+
+	//Max number of edits kept in the Undo History. The oldest are dropped first
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 UndoHistoryMaxEntries;
+
+	//Max memory (KB) used by the Undo History. The oldest edits are dropped first
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 UndoHistoryMaxMemoryKB;
+
+	FTransformerUndoHistory UndoHistory;
+
+	//Open Transform entry: components moved since the last entry was closed, and where they were before
+	TMap<TWeakObjectPtr<class USceneComponent>, FTransform> PendingUndoTransforms;
+
+	//The Selection as of the last Selection entry (what the next one is the difference from)
+	TSet<TWeakObjectPtr<class USceneComponent>> UndoSelectionSnapshot;
+
+	bool bUndoSelectionDirty;
+
+	//Whether an Undo / Redo is being applied (so that it isn't recorded itself)
+	bool bApplyingUndo;
+
+	//Whether dragging the Gizmo drags ghosts that are cloned on release. @see SetDuplicateDrag
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bDuplicateDrag;
+
+	//Whether Translations are swept and stop at blocking hits. @see SetCollisionAwareDrag
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bCollisionAwareDrag;
+
+	//Whether Collision Aware Drag sweeps one box around all the roots instead of one per root
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bCollisionDragCombinedShape;
+
+	//Channel of the sweeps of Collision Aware Drag. What blocks it blocks the drag
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	TEnumAsByte<ECollisionChannel> CollisionDragChannel;
+
+	//Cached on the first sweep of a drag: everything moves rigidly, so only the roots' locations change
+	TArray<FDragSweepRoot> DragSweepRoots;
+	bool bDragSweepRootsGathered;
+
+	//Actors whose hits don't block the drag (the ones being moved)
+	TSet<const AActor*> DragSweepIgnoredActors;
+
+	TArray<FTraceHandle> DragSweepHandles;
+	FVector DragSweepDelta;
+
+	//Channel of the traces of Drop Selection To Ground. What blocks it is ground
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	TEnumAsByte<ECollisionChannel> GroundTraceChannel;
+
+	//How far below a root Drop Selection To Ground looks for ground
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float GroundTraceDistance;
+
+	TUniquePtr<FDropToGround> DropToGround;
+
+	//Optional Material for the ghosts of a Duplicate Drag (e.g. translucent). If none, the ghosts keep the materials of the Selection
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	class UMaterialInterface* DuplicateDragGhostMaterial;
+
+	//Selected Components being duplicated, and the root of the ghost of each
+	TArray<TWeakObjectPtr<class USceneComponent>> DuplicateDragTemplates;
+
+	UPROPERTY()
+	TArray<class USceneComponent*> DuplicateDragGhosts;
+
+	bool bDuplicateDragging;
+
+	//Milliseconds per frame that CloneSelectedTimeSliced spends spawning clones. At least one Actor is cloned every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float CloneBudgetMs;
+
+	//Shared so that it outlives a Cancel made from within the Selection / Progress callbacks
+	TSharedPtr<FTimeSlicedClone> TimeSlicedClone;
+
+	FTransformerCloneStats TimeSlicedCloneStats;
+
 	//Whether we need to Sync with Server if there is a mismatch in number of Selections.
 	bool bResyncSelection;
+
+	//Server: whether the Selection changed since it was last recorded in the Edit State
+	bool bEditStateSelectionDirty;
+
+	//Bounds and centroid of the Selection. Only tracked while the Gizmo is placed on the Selection Center
+	mutable FTransformerSelectionBounds SelectionBounds;
+
+	//Pivot of the drag in progress of a Pawn without Gizmo, taken once per drag (@see GetTransformPivot)
+	mutable TOptional<FVector> DragPivot;
 };
@@ -0,0 +1,193 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "TransformerSelectionQuery.h"
+#include "TransformerSelectableRegistry.generated.h"
+
+//How Combine Selection Sets combines two Sets
+UENUM(BlueprintType)
+enum class ESelectionSetOperation : uint8
+{
+	SSO_Union				UMETA(DisplayName = "Union"),
+	SSO_Intersection		UMETA(DisplayName = "Intersection"),
+	SSO_Difference			UMETA(DisplayName = "Difference"),
+};
+
+/**
+ * A set of Components as a bitset over their ids in the UTransformerSelectableRegistry of their World.
+ * Union, Intersection and Difference go through the words 128 bits at a time.
+ *
+ * Ids are reused once a Component's Actor is destroyed: the Registry clears them from its named Sets,
+ * but a Set kept anywhere else is only meaningful while its Components are alive.
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMETRANSFORMER_API FTransformerSelectionSet
+{
+	GENERATED_BODY()
+
+public:
+
+	void Add(int32 Id);
+	void Remove(int32 Id);
+	bool Contains(int32 Id) const;
+
+	//Number of ids in the Set
+	int32 Num() const;
+	bool IsEmpty() const;
+	void Reset() { Words.Reset(); }
+
+	void Union(const FTransformerSelectionSet& Other);
+	void Intersect(const FTransformerSelectionSet& Other);
+
+	//Removes the ids that are in Other
+	void Subtract(const FTransformerSelectionSet& Other);
+
+	//Calls Func with each id in the Set, in increasing order
+	template<typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		for (int32 i = 0; i < Words.Num(); ++i)
+		{
+			for (uint32 word = Words[i]; word != 0; word &= word - 1)
+				Func(i * 32 + (int32)FMath::CountTrailingZeros(word));
+		}
+	}
+
+private:
+
+	//A bit per id. Always a multiple of 4 words (128 bits) long, so that there's no scalar tail
+	TArray<uint32, TAlignedHeapAllocator<16>> Words;
+};
+
+/**
+ * Per-World registry of the Components that can be Selected, giving each a dense id
+ * so that Selections can be kept as FTransformerSelectionSet, and the named Selection Sets
+ * ("all lamps in hall B") kept that way.
+ *
+ * The Scene Components of all Actors are registered when the World begins play, when Actors are spawned
+ * and when Levels (Sublevels, World Partition cells) are streamed in.
+ * Components added to an Actor after that are registered the first time they're put in a Set.
+ * Ids are freed (and cleared from the named Sets) when the Actor of a Component is destroyed or its Level streamed out,
+ * and when the Component is destroyed on its own: through Unregister (the Transformer Pawn and Layout call it)
+ * or, for Components destroyed anywhere else, when the ids of destroyed Components are pruned.
+ * Ids are local to each machine: Sets are not replicated.
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerSelectableRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UTransformerSelectableRegistry* Get(const UObject* WorldContextObject);
+
+	//Id of the Component, registering it if it wasn't. INDEX_NONE for nullptr
+	int32 Register(class USceneComponent* Component);
+
+	//Frees the id of the Component (if it has one) and clears it from the named Sets. For Components destroyed on their own
+	void Unregister(class USceneComponent* Component);
+
+	//INDEX_NONE if the Component isn't registered
+	int32 GetId(const class USceneComponent* Component) const;
+
+	//nullptr if the id is free or its Component is gone
+	class USceneComponent* GetComponent(int32 Id) const;
+
+	//Ids go from 0 up to (not including) this
+	int32 GetIdCount() const { return Components.Num(); }
+
+	//Set of the given Components (registering the ones that weren't)
+	FTransformerSelectionSet MakeSet(const TArray<class USceneComponent*>& InComponents);
+
+	//Appends the (alive) Components of the Set to OutComponents
+	void GetSetComponents(const FTransformerSelectionSet& Set, TArray<class USceneComponent*>& OutComponents) const;
+
+	//nullptr if there's no Set with that name
+	const FTransformerSelectionSet* FindSelectionSet(FName Name) const { return NamedSets.Find(Name); }
+
+	void SaveSelectionSet(FName Name, const FTransformerSelectionSet& Set);
+
+	/**
+	 * Finds the registered Components that match the Query. What the Query needs of them is taken on the Game Thread
+	 * (Classes and Interfaces are checked there, once per Class), the rest is matched in worker threads
+	 * and OnFinished is called back on the Game Thread with the matches, in id order.
+	 */
+	void RunQuery(const FTransformerSelectionQuery& Query
+		, TFunction<void(TArray<TWeakObjectPtr<class USceneComponent>>&&)>&& OnFinished) const;
+
+	/**
+	 * Saves the given Components as a named Selection Set, replacing the Set with that Name if there was one.
+	 * @see ATransformerPawn::SaveSelectionSet to save what a Pawn has Selected
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SaveComponentsAsSelectionSet(FName Name, const TArray<class USceneComponent*>& InComponents);
+
+	/**
+	 * Gets the Components of a named Selection Set.
+	 * @return false if there's no Set with that Name
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool GetSelectionSetComponents(FName Name, TArray<class USceneComponent*>& OutComponents) const;
+
+	/**
+	 * Combines two named Selection Sets into the Set named Result (which can be either of them).
+	 * A missing Set counts as empty.
+	 * @param Operation - Union (A or B), Intersection (A and B) or Difference (A and not B)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void CombineSelectionSets(FName Result, FName A, FName B, ESelectionSetOperation Operation);
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool RemoveSelectionSet(FName Name);
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	bool HasSelectionSet(FName Name) const { return NamedSets.Contains(Name); }
+
+	//Number of Components in a named Selection Set (0 if there's none with that Name)
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	int32 GetSelectionSetNum(FName Name) const;
+
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	TArray<FName> GetSelectionSetNames() const;
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+private:
+
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+	void OnLevelAdded(class ULevel* Level, UWorld* World);
+	void OnLevelRemoved(class ULevel* Level, UWorld* World);
+
+	//Registers (or Unregisters) all the Scene Components of the Actor
+	void RegisterActor(AActor* Actor);
+	void UnregisterActor(AActor* Actor);
+
+	//Clears the id from the named Sets and makes it available again
+	void FreeId(int32 Id);
+
+	//Component of each id (null for free ids)
+	TArray<TWeakObjectPtr<class USceneComponent>> Components;
+
+	//Components destroyed without going through Unregister have their ids freed every time the list doubles
+	int32 PruneSize = 1024;
+
+	//FObjectKey so that a new Component reusing the memory of a destroyed one doesn't get its id
+	TMap<FObjectKey, int32> Ids;
+
+	TArray<int32> FreeIds;
+
+	TMap<FName, FTransformerSelectionSet> NamedSets;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -0,0 +1,69 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Bounds and centroid (mean location) of a Selection, kept up to date as Components are added, removed and moved,
+ * so that placing the Gizmo on them doesn't go through the whole Selection on every change.
+ *
+ * The centroid is a running sum of the locations. The bounds grow as Components are added or moved within / out of them,
+ * but a Component whose bounds were on an edge can't be taken out without maybe shrinking them:
+ * the bounds are then marked dirty and rebuilt (a parallel reduction of the bounds kept per Component)
+ * only when they're asked for.
+ *
+ * Moved Components are only marked: what they moved to is read when the bounds or the centroid are asked for.
+ */
+class RUNTIMETRANSFORMER_API FTransformerSelectionBounds
+{
+public:
+
+	FTransformerSelectionBounds();
+
+	void Add(class USceneComponent* Component);
+
+	//Does nothing if the Component isn't tracked
+	void Remove(class USceneComponent* Component);
+	void MarkMoved(class USceneComponent* Component);
+
+	//Stops tracking everything
+	void Reset();
+
+	//Tracks exactly these Components (their bounds are read in parallel)
+	void Reset(const TArray<class USceneComponent*>& Components);
+
+	int32 Num() const { return Components.Num(); }
+
+	//Whether a tracked Component moved since the bounds / centroid were last asked for
+	bool HasMoved() const { return Moved.Num() > 0; }
+
+	FBox GetBounds();
+	FVector GetCentroid();
+
+	//World Bounds of the Primitives of the Root and everything attached to it (only the ones with query collision if bQueryOnly)
+	static FBox GetHierarchyBounds(const class USceneComponent* Root, bool bQueryOnly);
+
+private:
+
+	//Reads what the moved Components moved to
+	void UpdateMoved();
+
+	//Rebuilds the bounds (and the sum of locations, so that it doesn't drift) from what's kept per Component
+	void Rebuild();
+
+	//Whether Box is on an edge of the bounds (so that taking it out may shrink them)
+	bool IsOnEdge(const FBox& Box) const;
+
+	//Per Component, packed so that Rebuild can split them into ranges
+	TArray<class USceneComponent*> Components;
+	TArray<FVector> Locations;
+	TArray<FBox> ComponentBounds;
+	TMap<class USceneComponent*, int32> Indices;
+
+	TSet<class USceneComponent*> Moved;
+
+	FVector LocationSum;
+	FBox Bounds;
+	bool bBoundsDirty;
+};
@@ -0,0 +1,79 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "TransformerSelectionQuery.generated.h"
+
+/**
+ * What a Selection Query knows of a registered Component. Taken on the Game Thread (@see UTransformerSelectableRegistry::RunQuery)
+ * so that the Query can be matched against it in worker threads: nothing in here should be dereferenced there
+ * except the Classes (which are only compared).
+ */
+struct RUNTIMETRANSFORMER_API FTransformerSelectionQueryCandidate
+{
+	TWeakObjectPtr<class USceneComponent> Component;
+	const UClass* ActorClass = nullptr;
+	const UClass* ComponentClass = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+	FBox Bounds = FBox(ForceInit);
+
+	//Actor Tags followed by the Component Tags
+	TArray<FName, TInlineAllocator<4>> Tags;
+
+	bool bIsRoot = false;
+};
+
+/**
+ * Which registered Components a Selection Query selects (@see ATransformerPawn::SelectByQuery).
+ * Every option that is set has to match. Whatever matches still goes through ATransformerPawn::ShouldSelect.
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMETRANSFORMER_API FTransformerSelectionQuery
+{
+	GENERATED_BODY()
+
+public:
+
+	//Only Components whose Owner is of this Class (or a subclass). None for any
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	TSubclassOf<AActor> ActorClass;
+
+	//Only Components of this Class (or a subclass). None for any
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	TSubclassOf<class USceneComponent> ComponentClass;
+
+	//Only Components that (or whose Owner) implement this Interface. None for any
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	TSubclassOf<UInterface> Interface;
+
+	//Only Components that (or whose Owner) have this Tag. None for any
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	FName Tag;
+
+	//Only Components within Radius of Center. Not checked if Radius is 0 or less
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	FVector Center = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	float Radius = 0.f;
+
+	//Only Components whose Bounds overlap Box. Not checked if the Box is not valid
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	FBox Box = FBox(ForceInit);
+
+	//Only Root Components (the Components Actor Selection selects)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformer")
+	bool bRootComponentsOnly = true;
+
+	//Extra test for C++ callers. Called in worker threads, with what was taken of the Component in the Game Thread
+	TFunction<bool(const FTransformerSelectionQueryCandidate&)> Predicate;
+
+	//Whether the Classes pass the Class and Interface options (these are checked on the Game Thread, once per Class)
+	bool MatchesClasses(const UClass* InActorClass, const UClass* InComponentClass) const;
+
+	//Whether the Candidate passes the rest of the options and the Predicate. Thread safe
+	bool Matches(const FTransformerSelectionQueryCandidate& Candidate) const;
+};
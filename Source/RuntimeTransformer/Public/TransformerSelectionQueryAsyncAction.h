@@ -0,0 +1,58 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "TransformerPawn.h"
+#include "TransformerSelectionQueryAsyncAction.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FTransformerSelectionQueryAsyncActionDelegate, const TArray<class USceneComponent*>&, Selected);
+
+/**
+ * Latent Blueprint Node for ATransformerPawn::SelectByQuery.
+ * OnApplied fires once the matches have been Selected, with the ones that got Selected.
+ * OnFailed fires if the Query couldn't be run (or the Pawn is gone before it's applied).
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerSelectionQueryAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	/*
+	 * Selects the registered Components that match the Query, matching them in worker threads.
+	 * @see ATransformerPawn::SelectByQuery
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer"
+		, meta = (BlueprintInternalUseOnly = "true", DisplayName = "Select By Query"))
+	static UTransformerSelectionQueryAsyncAction* SelectByQuery(ATransformerPawn* TransformerPawn
+		, const FTransformerSelectionQuery& Query, bool bAppendToList = false);
+
+	UPROPERTY(BlueprintAssignable)
+	FTransformerSelectionQueryAsyncActionDelegate OnApplied;
+
+	UPROPERTY(BlueprintAssignable)
+	FTransformerSelectionQueryAsyncActionDelegate OnFailed;
+
+	virtual void Activate() override;
+
+private:
+
+	UFUNCTION()
+	void HandleSelectionQueryApplied(int32 InQueryId, const TArray<class USceneComponent*>& Selected);
+
+	UFUNCTION()
+	void HandlePawnDestroyed(AActor* DestroyedActor);
+
+	void Finish(const TArray<class USceneComponent*>& Selected, bool bFailed);
+
+	UPROPERTY()
+	TWeakObjectPtr<ATransformerPawn> Pawn;
+
+	UPROPERTY()
+	FTransformerSelectionQuery Query;
+	bool bAppendToList = false;
+	int32 QueryId = INDEX_NONE;
+};
@@ -0,0 +1,97 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FTransformerClipboard;
+
+enum class ETransformerUndoType : uint8
+{
+	Transform,
+	Selection,
+	Delete,
+};
+
+/**
+ * One undoable edit of a Transformer Pawn. Only what the edit touched is kept:
+ * - Transform: the components moved, with their World Transform before and after (a whole drag is one entry)
+ * - Selection: the components added to and removed from the Selection (not the whole Selection)
+ * - Delete: the deleted Actors serialized (FTransformerClipboard) and, once undone, the Actors they were restored as.
+ *   If they were soft deleted (parked in the UTransformerActorPool) there's nothing to serialize: Restored are the parked Actors
+ */
+struct RUNTIMETRANSFORMER_API FTransformerUndoEntry
+{
+	ETransformerUndoType Type = ETransformerUndoType::Transform;
+
+	//Transform: components moved. Selection: components added to the Selection
+	TArray<TWeakObjectPtr<class USceneComponent>> Components;
+
+	TArray<FTransform> Before;
+	TArray<FTransform> After;
+
+	//Selection: components removed from the Selection
+	TArray<TWeakObjectPtr<class USceneComponent>> Deselected;
+
+	TSharedPtr<FTransformerClipboard> Deleted;
+	TArray<TWeakObjectPtr<AActor>> Restored;
+	bool bSoftDeleted = false;
+
+	//Approximate memory used by this entry (bytes)
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Undo / Redo history: a ring buffer of FTransformerUndoEntry, bounded by a number of entries and by memory.
+ * The oldest entries are dropped when a new one doesn't fit. Pushing an entry drops the ones that could be redone.
+ */
+class RUNTIMETRANSFORMER_API FTransformerUndoHistory
+{
+public:
+
+	FTransformerUndoHistory();
+
+	//Changes the limits. Entries that don't fit anymore are dropped (oldest first)
+	void SetLimits(int32 InMaxEntries, SIZE_T InMaxBytes);
+
+	void Push(FTransformerUndoEntry&& Entry);
+
+	//Entry that Undo would revert (nullptr if none)
+	FTransformerUndoEntry* PeekUndo();
+
+	//Entry that Redo would apply again (nullptr if none)
+	FTransformerUndoEntry* PeekRedo();
+
+	//Moves the cursor once the entry of PeekUndo / PeekRedo has been applied
+	void MoveBack();
+	void MoveForward();
+
+	bool CanUndo() const { return Cursor > 0; }
+	bool CanRedo() const { return Cursor < Count; }
+
+	int32 Num() const { return Count; }
+	SIZE_T GetAllocatedSize() const { return TotalBytes; }
+
+	void Empty();
+
+private:
+
+	FTransformerUndoEntry& At(int32 Index) { return Entries[(Head + Index) % Entries.Num()]; }
+
+	//Drops the oldest entry
+	void PopOldest();
+
+	//Fixed size storage (MaxEntries). Entries [Head, Head + Count) are in use, oldest first
+	TArray<FTransformerUndoEntry> Entries;
+	TArray<SIZE_T> EntryBytes;
+
+	int32 Head;
+	int32 Count;
+
+	//Number of entries applied (the ones from Cursor on can be redone)
+	int32 Cursor;
+
+	int32 MaxEntries;
+	SIZE_T MaxBytes;
+	SIZE_T TotalBytes;
+};
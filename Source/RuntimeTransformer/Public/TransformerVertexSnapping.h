@@ -0,0 +1,137 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "Math/GenericOctree.h"
+#include <atomic>
+#include "TransformerVertexSnapping.generated.h"
+
+/**
+ * Finds the Static Mesh vertex nearest to a ray, for Vertex Snapping (@see ATranslationGizmo::GetVertexSnappedTransform).
+ *
+ * The vertices of each Static Mesh (LOD 0, duplicates removed) are kept in a KD-tree in mesh space, built
+ * in the background the first time the mesh is near a query (until then, that mesh is not snapped to).
+ * Since the trees are in mesh space, they're shared by every component of the same mesh and moving a component
+ * doesn't invalidate anything: a query goes through the components whose (current) bounds are near the ray
+ * and searches their mesh's tree with the ray in the component's space.
+ *
+ * The components are kept in an octree by their bounds, so a query only goes through the components near the ray.
+ * It's kept up to date as things happen rather than gathered again: the components of Actors are added when the
+ * World begins play, when Actors are spawned and when Levels are streamed in, and removed when their Actors are
+ * destroyed or streamed out. Components that moved are updated in the octree on the next query.
+ * Components added to an Actor after it was spawned are added with AddComponent (the Transformer Pawn and Layout do
+ * for their Component Clones).
+ * Instanced Static Meshes are not snapped to.
+ * In packaged builds only meshes with Allow CPU Access have their vertices available.
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UTransformerVertexSnapping : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UTransformerVertexSnapping* Get(const UObject* WorldContextObject);
+
+	/*
+	 * Finds the vertex nearest (by angle) to the ray.
+	 * @param MaxTanAngle - tangent of the max angle between the ray and the direction to the vertex
+	 * @param IgnoredActors - Actors whose meshes are not snapped to
+	 * @return false if there's no vertex within MaxTanAngle
+	 */
+	bool FindVertex(const FVector& RayOrigin, const FVector& RayDirection, float MaxTanAngle
+		, const TSet<const AActor*>& IgnoredActors, FVector& OutVertex);
+
+	//Adds a Static Mesh Component that was added to its Actor after the Actor was spawned (other components are ignored)
+	void AddComponent(class USceneComponent* Component);
+
+	//Gathers the Static Mesh Components again on the next query
+	void InvalidateComponents() { bComponentsDirty = true; }
+
+	//Forgets the vertices of all meshes
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void EmptyCache();
+
+	//Number of vertices kept in the trees
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	int32 GetCachedVertexCount() const;
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+private:
+
+	//Vertices of a Static Mesh, ordered as an implicit KD-tree (median of each range splits it, axis by depth)
+	struct FVertexTree
+	{
+		TArray<FVector3f> Points;
+		FBox3f Bounds;
+		std::atomic<bool> bReady { false };
+	};
+
+	typedef TSharedPtr<FVertexTree, ESPMode::ThreadSafe> FVertexTreePtr;
+
+	//Tree of the Mesh, nullptr if it isn't ready. Starts building it if it hasn't been
+	const FVertexTree* GetTree(class UStaticMesh* Mesh);
+
+	//A Static Mesh Component in the octree, with the bounds it was added with
+	struct FComponentElement
+	{
+		TWeakObjectPtr<class UStaticMeshComponent> Component;
+		FBoxCenterAndExtent Bounds;
+
+		//where the octree keeps the element id of each component
+		TMap<TWeakObjectPtr<class UStaticMeshComponent>, FOctreeElementId2>* ElementIds;
+	};
+
+	struct FComponentOctreeSemantics
+	{
+		enum { MaxElementsPerLeaf = 16 };
+		enum { MinInclusiveElementsPerNode = 7 };
+		enum { MaxNodeDepth = 12 };
+
+		typedef TInlineAllocator<MaxElementsPerLeaf> ElementAllocator;
+
+		static const FBoxCenterAndExtent& GetBoundingBox(const FComponentElement& Element) { return Element.Bounds; }
+		static bool AreElementsEqual(const FComponentElement& A, const FComponentElement& B) { return A.Component == B.Component; }
+		static void SetElementId(const FComponentElement& Element, FOctreeElementId2 Id) { Element.ElementIds->Add(Element.Component, Id); }
+	};
+
+	typedef TOctree2<FComponentElement, FComponentOctreeSemantics> FComponentOctree;
+
+	//Empties the octree and adds the Static Mesh Components of all Actors
+	void GatherComponents();
+
+	//Adds (or Removes) the Static Mesh Components of the Actor
+	void AddComponents(AActor* Actor);
+	void RemoveComponents(AActor* Actor);
+
+	void AddStaticMeshComponent(class UStaticMeshComponent* Component);
+	void RemoveStaticMeshComponent(const TWeakObjectPtr<class UStaticMeshComponent>& Component);
+
+	//Updates the octree with the current bounds of the components that moved since the last query
+	void UpdateMovedComponents();
+
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+	void OnLevelAdded(class ULevel* Level, UWorld* World);
+	void OnLevelRemoved(class ULevel* Level, UWorld* World);
+	void OnComponentMoved(class USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	TMap<TWeakObjectPtr<class UStaticMesh>, FVertexTreePtr> Trees;
+
+	TUniquePtr<FComponentOctree> ComponentOctree;
+	TMap<TWeakObjectPtr<class UStaticMeshComponent>, FOctreeElementId2> ComponentIds;
+	TSet<TWeakObjectPtr<class UStaticMeshComponent>> MovedComponents;
+	bool bComponentsDirty = true;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -38,6 +38,9 @@ public class RuntimeTransformer : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"Json",
+				"NetCore",
+				"Landscape",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);